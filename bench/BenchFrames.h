@@ -0,0 +1,54 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <opencv2/core.hpp>
+#include <initializer_list>
+#include "FrameSource.h"
+
+namespace thermal {
+namespace bench {
+
+    // Inputs every stage benchmark starts from: one frame of the synthetic
+    // scene as the camera would hand it over.
+    struct BenchFrames {
+        cv::Mat raw16;      // non-AGC counts
+        cv::Mat agc16;      // AGC-stretched
+        cv::Mat temp16;     // TE_A temperature map, °C * 100 + 5000
+        cv::Mat temp32;     // the same in °C (TE_B)
+        cv::Mat gray8;      // 8-bit image the old colormap path works on
+    };
+
+    inline BenchFrames makeFrames(int w, int h) {
+        BenchFrames f;
+        SyntheticFrameSource src(w, h);
+        f.agc16.create(h, w, CV_16U);
+        src.read(f.agc16, true);
+        f.raw16.create(h, w, CV_16U);
+        src.read(f.raw16, false);
+        f.temp16.create(h, w, CV_16U);
+        src.readTemperature(f.temp16);
+        f.temp16.convertTo(f.temp32, CV_32F, 0.01, -50.0);
+        f.agc16.convertTo(f.gray8, CV_8U, 1.0 / 256.0);
+        return f;
+    }
+
+    // QVGA (Q1/EQ1) and VGA (V1/EV1) sensors
+    inline void sensorSizes(benchmark::internal::Benchmark* b) {
+        b->Args({384, 288})->Args({640, 480});
+    }
+
+    // sensorSizes crossed with the values of a third argument
+    inline void sensorSizesWith(benchmark::internal::Benchmark* b,
+                                std::initializer_list<int64_t> values) {
+        for (int64_t v : values)
+            b->Args({384, 288, v});
+        for (int64_t v : values)
+            b->Args({640, 480, v});
+    }
+
+    inline void setPixels(benchmark::State& state) {
+        state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+    }
+
+} // namespace bench
+} // namespace thermal
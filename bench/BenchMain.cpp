@@ -0,0 +1,29 @@
+// thermal_bench: console output as usual, plus a JSON copy of the results
+// (thermal_bench.json, or whatever --benchmark_out names) for comparing
+// runs. No camera needed.
+
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int main(int argc, char** argv) {
+    std::vector<char*> args(argv, argv + argc);
+    bool hasOut = false;
+    for (int i = 1; i < argc; ++i)
+        if (std::strncmp(argv[i], "--benchmark_out=", 16) == 0) hasOut = true;
+
+    std::string out = "--benchmark_out=thermal_bench.json";
+    std::string format = "--benchmark_out_format=json";
+    if (!hasOut) {
+        args.push_back(&out[0]);
+        args.push_back(&format[0]);
+    }
+
+    int n = int(args.size());
+    benchmark::Initialize(&n, args.data());
+    if (benchmark::ReportUnrecognizedArguments(n, args.data())) return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,164 @@
+// ThermalCodec throughput and compression over short raw sequences:
+// the synthetic scene, the simulated camera, and, when
+// THERMAL_BENCH_RECORDING names a recording, its frames. Items are pixels.
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BenchFrames.h"
+#include "Recording.h"
+#include "SimulatedDevice.h"
+#include "ThermalCodec.h"
+
+namespace thermal {
+namespace bench {
+
+    // frames per sequence; one keyframe interval
+    const int CODEC_FRAMES = 30;
+    const unsigned int CODEC_SIM_DEVICE = 30;
+
+    enum CodecFrom { CODEC_SYNTHETIC = 0, CODEC_SIMULATED = 1 };
+
+    static std::vector<cv::Mat> captureSequence(FrameSource& src, int frames) {
+        std::vector<cv::Mat> seq;
+        for (int i = 0; i < frames; ++i) {
+            cv::Mat m(src.height(), src.width(), CV_16U);
+            if (src.read(m, false) != 1) break;
+            seq.push_back(m);
+        }
+        return seq;
+    }
+
+    static std::vector<cv::Mat> makeSequence(int w, int h, int from) {
+        if (from == CODEC_SYNTHETIC) {
+            SyntheticFrameSource src(w, h);
+            return captureSequence(src, CODEC_FRAMES);
+        }
+        SimConfig cfg;
+        cfg.width  = w;
+        cfg.height = h;
+        SimulatedBus::plug(CODEC_SIM_DEVICE, cfg);
+        std::vector<cv::Mat> seq;
+        if (auto dev = SimulatedBus::open(3, CODEC_SIM_DEVICE))
+            seq = captureSequence(*dev, CODEC_FRAMES);
+        SimulatedBus::unplug(CODEC_SIM_DEVICE);
+        return seq;
+    }
+
+    static void setCodecCounters(benchmark::State& state, const std::vector<cv::Mat>& seq,
+                                 size_t compressed) {
+        const size_t pixels = seq[0].total();
+        state.SetItemsProcessed(int64_t(state.iterations() * seq.size() * pixels));
+        state.SetBytesProcessed(int64_t(state.iterations() * seq.size() * pixels * 2));
+        state.counters["ratio"] = double(seq.size() * pixels * 2) / double(compressed);
+        state.counters["fps"] = benchmark::Counter(double(state.iterations() * seq.size()),
+                                                   benchmark::Counter::kIsRate);
+    }
+
+    static void runEncode(benchmark::State& state, const std::vector<cv::Mat>& seq,
+                          bool parallel) {
+        if (seq.empty()) {
+            state.SkipWithError("no frames");
+            return;
+        }
+        CodecOptions opts;
+        opts.parallel = parallel;
+        ThermalEncoder enc(opts);
+        std::vector<uint8_t> out;
+        size_t compressed = 0;
+        for (auto _ : state) {
+            enc.reset();
+            compressed = 0;
+            for (const cv::Mat& f : seq) {
+                compressed += enc.encode(f, out);
+                benchmark::DoNotOptimize(out.data());
+            }
+        }
+        setCodecCounters(state, seq, compressed);
+    }
+
+    static void runDecode(benchmark::State& state, const std::vector<cv::Mat>& seq,
+                          bool parallel) {
+        if (seq.empty()) {
+            state.SkipWithError("no frames");
+            return;
+        }
+        CodecOptions opts;
+        opts.parallel = parallel;
+        ThermalEncoder enc(opts);
+        std::vector<std::vector<uint8_t>> coded(seq.size());
+        size_t compressed = 0;
+        for (size_t i = 0; i < seq.size(); ++i)
+            compressed += enc.encode(seq[i], coded[i]);
+
+        ThermalDecoder dec(parallel);
+        cv::Mat raw;
+        for (auto _ : state) {
+            dec.reset();
+            for (const auto& c : coded) {
+                if (!dec.decode(c, raw)) {
+                    state.SkipWithError("decode failed");
+                    return;
+                }
+                benchmark::DoNotOptimize(raw.data);
+            }
+        }
+        setCodecCounters(state, seq, compressed);
+    }
+
+    // range: w, h, CodecFrom, parallel tiles
+    static void BM_CodecEncode(benchmark::State& state) {
+        runEncode(state, makeSequence(state.range(0), state.range(1), state.range(2)),
+                  state.range(3) != 0);
+    }
+    static void BM_CodecDecode(benchmark::State& state) {
+        runDecode(state, makeSequence(state.range(0), state.range(1), state.range(2)),
+                  state.range(3) != 0);
+    }
+
+    static void codecCases(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"w", "h", "src", "parallel"});
+        for (int from : {CODEC_SYNTHETIC, CODEC_SIMULATED})
+            for (int parallel : {0, 1}) {
+                b->Args({384, 288, from, parallel});
+                b->Args({640, 480, from, parallel});
+            }
+    }
+    BENCHMARK(BM_CodecEncode)->Apply(codecCases)->UseRealTime()->Unit(benchmark::kMillisecond);
+    BENCHMARK(BM_CodecDecode)->Apply(codecCases)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+    // Recorded frames, registered at start-up if THERMAL_BENCH_RECORDING
+    // points at a recording
+    static std::vector<cv::Mat> recordedSequence(const std::string& path) {
+        std::vector<cv::Mat> seq;
+        RecordingReader rec;
+        if (!rec.open(path)) return seq;
+        cv::Mat raw, temp;
+        FrameInfo info;
+        for (size_t i = 0; i < rec.frameCount() && int(seq.size()) < CODEC_FRAMES; ++i) {
+            if (!rec.frame(i, raw, temp, info) || raw.type() != CV_16U) continue;
+            seq.push_back(raw.clone());     // the reader's Mats view its mapping
+        }
+        return seq;
+    }
+
+    static const bool recordedRegistered = [] {
+        const char* path = std::getenv("THERMAL_BENCH_RECORDING");
+        if (!path || !*path) return false;
+        auto seq = std::make_shared<std::vector<cv::Mat>>(recordedSequence(path));
+        for (int parallel : {0, 1}) {
+            const std::string suffix = parallel ? "/recorded/parallel" : "/recorded/serial";
+            benchmark::RegisterBenchmark(("BM_CodecEncode" + suffix).c_str(),
+                [seq, parallel](benchmark::State& s) { runEncode(s, *seq, parallel != 0); })
+                ->UseRealTime()->Unit(benchmark::kMillisecond);
+            benchmark::RegisterBenchmark(("BM_CodecDecode" + suffix).c_str(),
+                [seq, parallel](benchmark::State& s) { runDecode(s, *seq, parallel != 0); })
+                ->UseRealTime()->Unit(benchmark::kMillisecond);
+        }
+        return true;
+    }();
+
+} // namespace bench
+} // namespace thermal
@@ -0,0 +1,442 @@
+// Per-stage microbenchmarks of captureImage / getTemperatureStats, old
+// path next to the current one. Items are pixels.
+
+#include <benchmark/benchmark.h>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <climits>
+#include <memory>
+#include "AlarmEngine.h"
+#include "BenchFrames.h"
+#include "BlobDetector.h"
+#include "Colorize.h"
+#include "FrameOutputs.h"
+#include "FramePool.h"
+#include "Metrics.h"
+#include "ModelKernels.h"
+#include "SlidingTempStats.h"
+#include "TempStats.h"
+#include "i3system_TE.h"
+
+namespace thermal {
+namespace bench {
+
+    // — Buffer allocation —
+    // what captureImage did per frame before the pool
+    static void BM_AllocHeap(benchmark::State& state) {
+        const size_t px = size_t(state.range(0)) * state.range(1);
+        for (auto _ : state) {
+            auto buf = new unsigned short[px];
+            benchmark::DoNotOptimize(buf);
+            delete[] buf;
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_AllocHeap)->Apply(sensorSizes);
+
+    static void BM_AllocPool(benchmark::State& state) {
+        const int w = state.range(0), h = state.range(1);
+        FramePool* pool = FramePool::create();
+        for (auto _ : state) {
+            cv::Mat m;
+            pool->acquire(m, h, w, CV_16U);
+            benchmark::DoNotOptimize(m.data);
+        }   // m goes back to the pool
+        state.counters["heapAllocations"] = double(pool->stats().heapAllocations);
+        pool->release();
+        setPixels(state);
+    }
+    BENCHMARK(BM_AllocPool)->Apply(sensorSizes);
+
+
+    // — 16 -> 8-bit conversion —
+    static void BM_To8Agc(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        cv::Mat gray8;
+        for (auto _ : state) {
+            f.agc16.convertTo(gray8, CV_8U, 1.0 / 256.0);
+            benchmark::DoNotOptimize(gray8.data);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_To8Agc)->Apply(sensorSizes);
+
+    // min/max stretch, as captureImage did without AGC
+    static void BM_To8MinMax(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        cv::Mat gray8;
+        for (auto _ : state) {
+            double mn, mx;
+            cv::minMaxLoc(f.raw16, &mn, &mx);
+            f.raw16.convertTo(gray8, CV_8U, 255.0 / (mx - mn), -mn * 255.0 / (mx - mn));
+            benchmark::DoNotOptimize(gray8.data);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_To8MinMax)->Apply(sensorSizes);
+
+
+    // — Colorization —
+    static void BM_CvApplyColorMap(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        cv::Mat color;
+        for (auto _ : state) {
+            cv::applyColorMap(f.gray8, color, cv::COLORMAP_JET);
+            benchmark::DoNotOptimize(color.data);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_CvApplyColorMap)->Apply(sensorSizes);
+
+    static void BM_I3ApplyColorMap(benchmark::State& state) {
+        const int w = state.range(0), h = state.range(1);
+        BenchFrames f = makeFrames(w, h);
+        cv::Mat color(h, w, CV_8UC3);
+        for (auto _ : state) {
+            i3::ApplyColorMap(color.data, f.gray8.data, I3_COLORMAP_IRON, w, h);
+            benchmark::DoNotOptimize(color.data);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_I3ApplyColorMap)->Apply(sensorSizes);
+
+    // the whole old image path: 8-bit conversion, then the colormap
+    static void BM_ColorizeOld(benchmark::State& state) {
+        const bool agc = state.range(2) != 0;
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        const cv::Mat& raw = agc ? f.agc16 : f.raw16;
+        cv::Mat gray8, color;
+        for (auto _ : state) {
+            if (agc) {
+                raw.convertTo(gray8, CV_8U, 1.0 / 256.0);
+            } else {
+                double mn, mx;
+                cv::minMaxLoc(raw, &mn, &mx);
+                raw.convertTo(gray8, CV_8U, 255.0 / (mx - mn), -mn * 255.0 / (mx - mn));
+            }
+            cv::applyColorMap(gray8, color, cv::COLORMAP_JET);
+            benchmark::DoNotOptimize(color.data);
+        }
+        setPixels(state);
+    }
+    static void agcOffOn(benchmark::internal::Benchmark* b) {
+        sensorSizesWith(b, {0, 1});
+        b->ArgNames({"w", "h", "agc"});
+    }
+    BENCHMARK(BM_ColorizeOld)->Apply(agcOffOn);
+
+    // the fused single pass captureImage uses now
+    static void BM_ColorizeFused(benchmark::State& state) {
+        const bool agc = state.range(2) != 0;
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        const cv::Mat& raw = agc ? f.agc16 : f.raw16;
+        cv::Mat color;
+        for (auto _ : state) {
+            colorize16(raw, color, PALETTE_JET, agc);
+            benchmark::DoNotOptimize(color.data);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_ColorizeFused)->Apply(agcOffOn);
+
+    // the same pass through the model kernels the camera picks at open:
+    // instantiated for the sensor's resolution (fixed=1), or the generic
+    // ones (fixed=0)
+    static void BM_ColorizeModel(benchmark::State& state) {
+        const bool agc = state.range(2) != 0, fixed = state.range(3) != 0;
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        const cv::Mat& raw = agc ? f.agc16 : f.raw16;
+        const ModelKernels& k = fixed
+            ? modelKernels(DeviceFamily::TE_A, raw.cols, raw.rows)
+            : genericKernels();
+        cv::Mat color;
+        for (auto _ : state) {
+            k.colorize(raw, color, PALETTE_JET, agc);
+            benchmark::DoNotOptimize(color.data);
+        }
+        setPixels(state);
+        state.SetLabel(k.name());
+    }
+    BENCHMARK(BM_ColorizeModel)->Apply([](benchmark::internal::Benchmark* b) {
+        b->ArgNames({"w", "h", "agc", "fixed"});
+        for (int fixed : {0, 1})
+            for (int agc : {0, 1}) {
+                b->Args({384, 288, agc, fixed});
+                b->Args({640, 480, agc, fixed});
+            }
+    });
+
+
+    // — Min/max scan —
+    // the loop getTemperatureStats ran before TempStats
+    static void BM_MinMaxScalarLoop(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        const unsigned short* t = f.temp16.ptr<unsigned short>();
+        const int sz = int(f.temp16.total());
+        for (auto _ : state) {
+            unsigned short mn = USHRT_MAX, mx = 0;
+            int minP = 0, maxP = 0;
+            for (int i = 0; i < sz; ++i) {
+                if (t[i] < mn) { mn = t[i]; minP = i; }
+                if (t[i] > mx) { mx = t[i]; maxP = i; }
+            }
+            benchmark::DoNotOptimize(minP);
+            benchmark::DoNotOptimize(maxP);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_MinMaxScalarLoop)->Apply(sensorSizes);
+
+    // range(2) is a SimdLevel; levels this CPU lacks run the best one it has
+    static void BM_MinMaxU16(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        const SimdLevel level = SimdLevel(state.range(2));
+        for (auto _ : state) {
+            uint16_t mn, mx;
+            minMaxU16(f.temp16, mn, mx, level);
+            benchmark::DoNotOptimize(mn);
+            benchmark::DoNotOptimize(mx);
+        }
+        state.SetLabel(simdLevelName(level));
+        setPixels(state);
+    }
+    static void simdLevels(benchmark::internal::Benchmark* b) {
+        sensorSizesWith(b, {int(SimdLevel::Scalar), int(SimdLevel::SSE41),
+                            int(SimdLevel::AVX2), int(SimdLevel::NEON)});
+        b->ArgNames({"w", "h", "simd"});
+    }
+    BENCHMARK(BM_MinMaxU16)->Apply(simdLevels);
+
+    // full stats (min/max, mean, stddev, percentiles), both encodings
+    static void BM_TempStats(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        const cv::Mat& temp = state.range(2) ? f.temp32 : f.temp16;
+        for (auto _ : state) {
+            TempStats s = computeTempStats(temp);
+            benchmark::DoNotOptimize(s);
+        }
+        state.SetLabel(state.range(2) ? "CV_32F" : "CV_16U");
+        setPixels(state);
+    }
+    static void bothEncodings(benchmark::internal::Benchmark* b) {
+        sensorSizesWith(b, {0, 1});
+        b->ArgNames({"w", "h", "float"});
+    }
+    BENCHMARK(BM_TempStats)->Apply(bothEncodings);
+
+
+    // — Reduced outputs —
+    // what a dashboard wanting a quarter-size thumbnail and a 16x12 grid
+    // did: the full-resolution image, scaled down...
+    static void BM_OutputsFromFullImage(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        cv::Mat color, thumb, max, mean;
+        for (auto _ : state) {
+            colorize16(f.agc16, color, PALETTE_JET, true);
+            cv::resize(color, thumb, cv::Size(), 0.25, 0.25, cv::INTER_AREA);
+            blockGrid(f.temp16, cv::Size(16, 12), max, mean);
+            benchmark::DoNotOptimize(thumb.data);
+        }
+        state.counters["outputBytes"] = double(color.total() * color.elemSize());
+        setPixels(state);
+    }
+    BENCHMARK(BM_OutputsFromFullImage)->Apply(sensorSizes);
+
+    // ...and the same outputs as Frame::outputs() renders them
+    static void BM_OutputsFused(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        const OutputSet specs{OutputSpec::thumbnail(4), OutputSpec::blockGrid(16, 12)};
+        auto render = [](const cv::Mat& raw, cv::Mat& out) {
+            colorize16(raw, out, PALETTE_JET, true);
+        };
+        std::vector<FrameOutput> out;
+        for (auto _ : state) {
+            renderOutputs(f.agc16, f.temp16, specs, render, nullptr, out);
+            benchmark::DoNotOptimize(out[0].image.data);
+        }
+        state.counters["outputBytes"] = double(out[0].image.total() * out[0].image.elemSize());
+        setPixels(state);
+    }
+    BENCHMARK(BM_OutputsFused)->Apply(sensorSizes);
+
+
+    // — Temperature map to °C —
+    // the TE_A encoding (°C * 100 + 5000) to float °C, per pixel...
+    static void BM_TempToCelsiusLoop(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        cv::Mat c(f.temp16.size(), CV_32F);
+        const unsigned short* t = f.temp16.ptr<unsigned short>();
+        for (auto _ : state) {
+            float* d = c.ptr<float>();
+            for (size_t i = 0, n = f.temp16.total(); i < n; ++i)
+                d[i] = (t[i] - 5000) / 100.0f;
+            benchmark::DoNotOptimize(c.data);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_TempToCelsiusLoop)->Apply(sensorSizes);
+
+    // ...and as Frame::temperature() does it
+    static void BM_TempToCelsiusConvert(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        cv::Mat c;
+        for (auto _ : state) {
+            f.temp16.convertTo(c, CV_32F, 0.01, -50.0);
+            benchmark::DoNotOptimize(c.data);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_TempToCelsiusConvert)->Apply(sensorSizes);
+
+
+    // — Hotspot detection —
+    // regions above the midpoint of mean and max; range(2): parallel tiles
+    static void BM_Blobs(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        TempStats s = computeTempStats(f.temp16);
+        BlobOptions opts;
+        opts.thresholdC = (s.mean + s.maxTemp) / 2;
+        opts.parallel   = state.range(2) != 0;
+        BlobDetector detector(opts);
+        std::vector<Blob> blobs;
+        for (auto _ : state) {
+            detector.detect(f.temp16, blobs);
+            benchmark::DoNotOptimize(blobs.data());
+        }
+        state.counters["blobs"] = double(blobs.size());
+        setPixels(state);
+    }
+    BENCHMARK(BM_Blobs)->Apply([](benchmark::internal::Benchmark* b) {
+        sensorSizesWith(b, {0, 1});
+        b->ArgNames({"w", "h", "parallel"});
+    });
+
+
+    // — Threshold alarms —
+    const int ALARM_RULES = 8;
+
+    // a quiet frame: whole-frame Above rules just over its hottest pixel,
+    // so every rule scans all of it (the early exit's worst case); the
+    // perRule counter is the time one rule adds to a frame. range(2) is
+    // a SimdLevel
+    static void BM_AlarmQuiet(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        TempStats s = computeTempStats(f.temp16);
+        const SimdLevel level = SimdLevel(state.range(2));
+        AlarmEngine engine(level);
+        AlarmRule rule;
+        rule.thresholdC = s.maxTemp + 0.5f;
+        for (int i = 0; i < ALARM_RULES; ++i) engine.addRule(rule);
+        FrameInfo info{};
+        for (auto _ : state) {
+            benchmark::DoNotOptimize(engine.evaluate(f.temp16, info));
+        }
+        state.SetLabel(simdLevelName(level));
+        state.counters["perRule"] = benchmark::Counter(
+            double(state.iterations()) * ALARM_RULES,
+            benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        setPixels(state);
+    }
+    BENCHMARK(BM_AlarmQuiet)->Apply(simdLevels);
+
+    // the same frame converted and checked the way a callback would:
+    // to °C, then its maximum against the limit
+    static void BM_AlarmInCallback(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        TempStats s = computeTempStats(f.temp16);
+        const double limit = s.maxTemp + 0.5;
+        cv::Mat c;
+        for (auto _ : state) {
+            f.temp16.convertTo(c, CV_32F, 0.01, -50.0);
+            double mx;
+            cv::minMaxLoc(c, nullptr, &mx);
+            benchmark::DoNotOptimize(mx > limit);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_AlarmInCallback)->Apply(sensorSizes);
+
+    // Above and Rise rules on 8 tiles of the frame; Rise needs each
+    // tile's maximum on every frame
+    static void BM_AlarmTiles(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        TempStats s = computeTempStats(f.temp16);
+        AlarmEngine engine;
+        const int w = f.temp16.cols / 4, h = f.temp16.rows / 2;
+        for (int i = 0; i < ALARM_RULES; ++i) {
+            AlarmRule rule;
+            rule.region = cv::Rect((i % 4) * w, (i / 4) * h, w, h);
+            rule.thresholdC = state.range(2) ? 5.0f : s.maxTemp + 0.5f;
+            rule.condition = state.range(2) ? AlarmCondition::Rise : AlarmCondition::Above;
+            engine.addRule(rule);
+        }
+        FrameInfo info{};
+        for (auto _ : state) {
+            info.timestamp = std::chrono::steady_clock::now();
+            benchmark::DoNotOptimize(engine.evaluate(f.temp16, info));
+        }
+        state.SetLabel(state.range(2) ? "rise" : "above");
+        state.counters["perRule"] = benchmark::Counter(
+            double(state.iterations()) * ALARM_RULES,
+            benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+        setPixels(state);
+    }
+    BENCHMARK(BM_AlarmTiles)->Apply([](benchmark::internal::Benchmark* b) {
+        sensorSizesWith(b, {0, 1});
+        b->ArgNames({"w", "h", "rise"});
+    });
+
+
+    // — Sliding window statistics —
+    // 10 s at 30 fps
+    const int SLIDING_WINDOW = 300;
+
+    // one frame into a full window; range(2) is a SimdLevel
+    static void BM_SlidingWindowPush(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        const SimdLevel level = SimdLevel(state.range(2));
+        SlidingTempStats window(f.temp16.cols, f.temp16.rows, SLIDING_WINDOW, 1, level);
+        for (int i = 0; i < SLIDING_WINDOW; ++i) window.push(f.temp16);
+        for (auto _ : state) {
+            window.push(f.temp16);
+            benchmark::ClobberMemory();
+        }
+        state.SetLabel(simdLevelName(level));
+        state.counters["memoryMB"] = double(window.memoryBytes()) / (1 << 20);
+        setPixels(state);
+    }
+    BENCHMARK(BM_SlidingWindowPush)->Apply(simdLevels);
+
+    // mean, stddev, max and delta maps of a full window
+    static void BM_SlidingWindowMaps(benchmark::State& state) {
+        BenchFrames f = makeFrames(state.range(0), state.range(1));
+        SlidingTempStats window(f.temp16.cols, f.temp16.rows, SLIDING_WINDOW);
+        for (int i = 0; i < SLIDING_WINDOW + SLIDING_WINDOW / 3; ++i) window.push(f.temp16);
+        cv::Mat mean, sd, mx, delta;
+        for (auto _ : state) {
+            window.mean(mean);
+            window.stddev(sd);
+            window.max(mx);
+            window.delta(delta);
+            benchmark::DoNotOptimize(mx.data);
+        }
+        setPixels(state);
+    }
+    BENCHMARK(BM_SlidingWindowMaps)->Apply(sensorSizes);
+
+
+
+    // — Metrics —
+    // what one timed stage adds to a frame, enabled (1) or not (0)
+    static void BM_StageTimer(benchmark::State& state) {
+        CameraMetrics metrics;
+        metrics.setEnabled(state.range(0) != 0);
+        for (auto _ : state) {
+            StageTimer timer(&metrics, Stage::Read);
+            benchmark::ClobberMemory();
+        }
+    }
+    BENCHMARK(BM_StageTimer)->Arg(0)->Arg(1);
+
+} // namespace bench
+} // namespace thermal
@@ -0,0 +1,427 @@
+// End-to-end stream throughput: unpaced streams from a synthetic source
+// and from a simulated camera, through ThermalCamera; and single captures
+// from many paced cameras, a thread per camera against the asynchronous
+// API on a small executor; and batches of °C frames, copied out of single
+// captures against one burst into a tensor; and a subscriber's frame rate
+// with and without slow ones beside it. Items are frames. Lastly the time
+// from open() to a calibrated camera, with and without a calibration cache,
+// and from a cold bus to a fleet of ready cameras, one by one and all at once.
+
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "BenchFrames.h"
+#include "CameraPool.h"
+#include "SimulatedDevice.h"
+#include "ThermalCamera.h"
+
+namespace thermal {
+namespace bench {
+
+    // frames delivered per benchmark iteration
+    const int STREAM_FRAMES = 240;
+    // SimulatedBus slot, well clear of real cameras
+    const unsigned int SIM_DEVICE = 31;
+
+    enum StreamFrom { FROM_SYNTHETIC = 0, FROM_SIMULATED = 1 };
+
+    // range: w, h, StreamFrom, pipelined, AGC, metrics on
+    static void BM_Stream(benchmark::State& state) {
+        const int  w         = state.range(0), h = state.range(1);
+        const bool simulated = state.range(2) == FROM_SIMULATED;
+        const bool pipelined = state.range(3) != 0;
+        const bool agc       = state.range(4) != 0;
+
+        ThermalCamera cam;
+        cam.enableMetrics(state.range(5) != 0);
+        StreamOptions opts;
+        opts.paced     = false;
+        opts.pipelined = pipelined;
+        if (simulated) {
+            SimConfig cfg;
+            cfg.width  = w;
+            cfg.height = h;
+            SimulatedBus::plug(SIM_DEVICE, cfg);
+            if (!cam.open(3, SIM_DEVICE)) {
+                state.SkipWithError("simulated camera did not open");
+                SimulatedBus::unplug(SIM_DEVICE);
+                return;
+            }
+        } else {
+            opts.source = std::make_shared<SyntheticFrameSource>(w, h);
+        }
+
+        for (auto _ : state) {
+            std::mutex m;
+            std::condition_variable cv;
+            int delivered = 0;
+            cam.startStream(ThermalCamera::FrameCb([&](const Frame& f) {
+                benchmark::DoNotOptimize(f.raw().data);
+                std::lock_guard<std::mutex> lk(m);
+                if (++delivered == STREAM_FRAMES) cv.notify_one();
+            }), agc, opts);
+            {
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [&] { return delivered >= STREAM_FRAMES; });
+            }
+            cam.stopStream();
+        }
+
+        state.SetItemsProcessed(state.iterations() * STREAM_FRAMES);
+        state.counters["fps"] = benchmark::Counter(double(state.iterations()) * STREAM_FRAMES,
+                                                   benchmark::Counter::kIsRate);
+        state.counters["heapAllocations"] = double(cam.bufferStats().heapAllocations);
+        state.SetLabel(std::string(simulated ? "simulated" : "synthetic") +
+                       (pipelined ? "/pipelined" : "/loop"));
+        if (simulated) {
+            cam.close();
+            SimulatedBus::unplug(SIM_DEVICE);
+        }
+    }
+
+    static void streamCases(benchmark::internal::Benchmark* b) {
+        b->ArgNames({"w", "h", "src", "pipelined", "agc", "metrics"});
+        for (int src : {FROM_SYNTHETIC, FROM_SIMULATED})
+            for (int pipelined : {0, 1})
+                for (int agc : {0, 1}) {
+                    b->Args({384, 288, src, pipelined, agc, 0});
+                    b->Args({640, 480, src, pipelined, agc, 0});
+                }
+        // the cost of CameraMetrics: compare with the metrics=0 runs
+        for (int pipelined : {0, 1}) {
+            b->Args({384, 288, FROM_SIMULATED, pipelined, 0, 1});
+            b->Args({640, 480, FROM_SIMULATED, pipelined, 0, 1});
+        }
+    }
+    BENCHMARK(BM_Stream)->Apply(streamCases)
+                        ->UseRealTime()
+                        ->Unit(benchmark::kMillisecond);
+
+
+    // captures per camera per benchmark iteration: a second at 30 fps
+    const int CAPTURE_FRAMES = 30;
+    // SimulatedBus slots of the capture cameras: from here up, below
+    // SIM_DEVICE and CodecBench's slot
+    const unsigned int CAPTURE_SIM_DEVICE = 10;
+
+    // N simulated 30 fps cameras, each opened on its own slot
+    static bool openCameras(benchmark::State& state, int n,
+                            std::vector<std::unique_ptr<ThermalCamera>>& cams) {
+        SimConfig cfg;
+        cfg.fps = 30;
+        for (int i = 0; i < n; ++i) {
+            SimulatedBus::plug(CAPTURE_SIM_DEVICE + i, cfg);
+            cams.emplace_back(new ThermalCamera);
+            if (!cams.back()->open(3, CAPTURE_SIM_DEVICE + i)) {
+                state.SkipWithError("simulated camera did not open");
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static void closeCameras(std::vector<std::unique_ptr<ThermalCamera>>& cams) {
+        for (size_t i = 0; i < cams.size(); ++i) {
+            cams[i]->close();
+            SimulatedBus::unplug(CAPTURE_SIM_DEVICE + unsigned(i));
+        }
+    }
+
+    // range: cameras. The blocking API: a thread per camera, each asleep
+    // in the read until its frame is in
+    static void BM_CaptureThreadPerCamera(benchmark::State& state) {
+        const int n = state.range(0);
+        std::vector<std::unique_ptr<ThermalCamera>> cams;
+        if (openCameras(state, n, cams)) {
+            for (auto _ : state) {
+                std::vector<std::thread> threads;
+                for (auto& cam : cams)
+                    threads.emplace_back([&cam] {
+                        for (int i = 0; i < CAPTURE_FRAMES; ++i) {
+                            Frame f = cam->captureFrame(false);
+                            benchmark::DoNotOptimize(f.raw().data);
+                        }
+                    });
+                for (std::thread& t : threads) t.join();
+            }
+            state.SetItemsProcessed(state.iterations() * n * CAPTURE_FRAMES);
+            state.counters["threads"] = n;
+        }
+        closeCameras(cams);
+    }
+    BENCHMARK(BM_CaptureThreadPerCamera)->ArgName("cameras")->Arg(4)->Arg(16)
+                                        ->UseRealTime()
+                                        ->Unit(benchmark::kMillisecond);
+
+    // range: cameras. The asynchronous API: every camera's next capture
+    // asked for from the last one's callback, all on a two-thread executor
+    // that reads each camera when its frame is due
+    static void BM_CaptureAsync(benchmark::State& state) {
+        const int n = state.range(0);
+        std::vector<std::unique_ptr<ThermalCamera>> cams;
+        CaptureExecutor executor(2);
+        if (openCameras(state, n, cams)) {
+            for (auto _ : state) {
+                std::mutex m;
+                std::condition_variable cv;
+                int finished = 0;
+                std::vector<std::function<void(int)>> next(n);
+                for (int c = 0; c < n; ++c)
+                    next[c] = [&, c](int left) {
+                        cams[c]->captureFrameAsync([&, c, left](const Frame& f) {
+                            benchmark::DoNotOptimize(f.raw().data);
+                            if (left > 1) {
+                                next[c](left - 1);
+                                return;
+                            }
+                            std::lock_guard<std::mutex> lk(m);
+                            if (++finished == n) cv.notify_one();
+                        }, false, &executor);
+                    };
+                for (int c = 0; c < n; ++c) next[c](CAPTURE_FRAMES);
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [&] { return finished == n; });
+            }
+            state.SetItemsProcessed(state.iterations() * n * CAPTURE_FRAMES);
+            state.counters["threads"] = executor.threads();
+        }
+        closeCameras(cams);
+    }
+    BENCHMARK(BM_CaptureAsync)->ArgName("cameras")->Arg(4)->Arg(16)
+                              ->UseRealTime()
+                              ->Unit(benchmark::kMillisecond);
+
+
+    // frames per batch of the burst benchmarks
+    const int BURST_FRAMES = 16;
+
+    // A batch the way it is put together without captureBurst: a capture
+    // per frame, its °C map copied into the batch buffer
+    static void BM_BurstFromCaptures(benchmark::State& state) {
+        SimConfig cfg;
+        cfg.width  = 640;
+        cfg.height = 480;
+        SimulatedBus::plug(SIM_DEVICE, cfg);
+        ThermalCamera cam;
+        if (!cam.open(3, SIM_DEVICE)) {
+            state.SkipWithError("simulated camera did not open");
+            SimulatedBus::unplug(SIM_DEVICE);
+            return;
+        }
+        cv::Mat batch(BURST_FRAMES * cfg.height, cfg.width, CV_32F);
+        for (auto _ : state) {
+            for (int i = 0; i < BURST_FRAMES; ++i) {
+                Frame f = cam.captureFrame(false);
+                cv::Mat slot = batch(cv::Rect(0, i * cfg.height, cfg.width, cfg.height));
+                f.temperature().copyTo(slot);
+            }
+            benchmark::DoNotOptimize(batch.data);
+        }
+        state.SetItemsProcessed(state.iterations() * BURST_FRAMES);
+        cam.close();
+        SimulatedBus::unplug(SIM_DEVICE);
+    }
+    BENCHMARK(BM_BurstFromCaptures)->Unit(benchmark::kMillisecond);
+
+    // range: BurstNorm. The same batch from captureBurstInto, reusing its tensor
+    static void BM_CaptureBurst(benchmark::State& state) {
+        SimConfig cfg;
+        cfg.width  = 640;
+        cfg.height = 480;
+        SimulatedBus::plug(SIM_DEVICE, cfg);
+        ThermalCamera cam;
+        if (!cam.open(3, SIM_DEVICE)) {
+            state.SkipWithError("simulated camera did not open");
+            SimulatedBus::unplug(SIM_DEVICE);
+            return;
+        }
+        BurstLayout layout;
+        layout.data      = BurstData::Celsius;
+        layout.normalize = BurstNorm(state.range(0));
+        BurstTensor batch;
+        for (auto _ : state) {
+            if (!cam.captureBurstInto(batch, BURST_FRAMES, layout)) {
+                state.SkipWithError("burst failed");
+                break;
+            }
+            benchmark::DoNotOptimize(batch.tensor.data);
+        }
+        state.SetItemsProcessed(state.iterations() * BURST_FRAMES);
+        state.counters["heapAllocations"] = double(cam.bufferStats().heapAllocations);
+        cam.close();
+        SimulatedBus::unplug(SIM_DEVICE);
+    }
+    BENCHMARK(BM_CaptureBurst)->ArgName("norm")
+                              ->Arg(int(BurstNorm::None))
+                              ->Arg(int(BurstNorm::MinMax))
+                              ->Arg(int(BurstNorm::Standardize))
+                              ->Unit(benchmark::kMillisecond);
+
+
+    // range: slow subscribers, each spending 10 ms per frame. A fast
+    // subscriber's rate should not move.
+    static void BM_FanoutSlowSubscribers(benchmark::State& state) {
+        const int slow = state.range(0);
+        ThermalCamera cam;
+        StreamOptions opts;
+        opts.paced  = false;
+        opts.source = std::make_shared<SyntheticFrameSource>(384, 288);
+        for (int i = 0; i < slow; ++i) {
+            SubscribeOptions so;
+            so.name = "slow";
+            cam.subscribe([](const Frame& f) {
+                benchmark::DoNotOptimize(f.raw().data);
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }, so);
+        }
+
+        for (auto _ : state) {
+            std::mutex m;
+            std::condition_variable cv;
+            int delivered = 0;
+            SubscribeOptions fo;
+            fo.name = "fast";
+            int fast = cam.subscribe([&](const Frame& f) {
+                benchmark::DoNotOptimize(f.raw().data);
+                std::lock_guard<std::mutex> lk(m);
+                if (++delivered == STREAM_FRAMES) cv.notify_one();
+            }, fo);
+            cam.startStream(false, opts);
+            {
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [&] { return delivered >= STREAM_FRAMES; });
+            }
+            cam.stopStream();
+            cam.unsubscribe(fast);
+        }
+
+        state.SetItemsProcessed(state.iterations() * STREAM_FRAMES);
+        state.counters["fps"] = benchmark::Counter(double(state.iterations()) * STREAM_FRAMES,
+                                                   benchmark::Counter::kIsRate);
+        uint64_t dropped = 0;
+        for (const SubscriberStats& s : cam.subscriberStats()) dropped += s.dropped;
+        state.counters["slowDropped"] = double(dropped);
+    }
+    BENCHMARK(BM_FanoutSlowSubscribers)->ArgName("slow")->Arg(0)->Arg(1)->Arg(4)
+                                       ->UseRealTime()
+                                       ->Unit(benchmark::kMillisecond);
+
+
+    // what a shutter cycle holds the simulated camera for
+    const int CALIBRATION_MS = 250;
+
+    // range: cached. open() then a shutter calibration, or, once the cache
+    // holds the camera's entry, open() restoring it; close() between
+    static void BM_OpenCalibrated(benchmark::State& state) {
+        const bool cached = state.range(0) != 0;
+        char dir[] = "/tmp/hkcal-XXXXXX";
+        if (!::mkdtemp(dir)) {
+            state.SkipWithError("no temporary directory");
+            return;
+        }
+        auto cache = std::make_shared<CalibrationCache>(dir);
+        SimConfig cfg;
+        cfg.serial        = 0x5eed;
+        cfg.calibrationMs = CALIBRATION_MS;
+        SimulatedBus::plug(SIM_DEVICE, cfg);
+
+        ThermalCamera cam;
+        if (cached) cam.setCalibrationCache(cache);
+        if (cached && (!cam.open(3, SIM_DEVICE) || !cam.doCalibration()))
+            state.SkipWithError("simulated camera did not calibrate");
+        cam.close();
+        for (auto _ : state) {
+            if (!cam.open(3, SIM_DEVICE)) {
+                state.SkipWithError("simulated camera did not open");
+                break;
+            }
+            if (!cam.calibrationRestored()) cam.doCalibration();
+            cam.close();
+        }
+        const SimCalibrationStats sim = SimulatedBus::calibrationStats(SIM_DEVICE);
+        state.counters["shutterCycles"] = double(sim.shutterCycles);
+        state.counters["cacheHits"]     = double(cache->stats().hits);
+        SimulatedBus::unplug(SIM_DEVICE);
+        cache->remove(cfg.serial, 3);
+        ::rmdir(dir);
+    }
+    BENCHMARK(BM_OpenCalibrated)->ArgName("cached")->Arg(0)->Arg(1)
+                                ->UseRealTime()
+                                ->Unit(benchmark::kMillisecond);
+
+
+
+    // what opening a simulated camera takes, and the reads it fails while
+    // warming up
+    const int FLEET_OPEN_MS         = 50;
+    const int FLEET_WARMUP_FAILURES = 2;
+    const unsigned int FLEET_SERIAL = 0xf1ee7000u;  // + camera index
+
+    enum FleetMode { FLEET_SEQUENTIAL = 0, FLEET_BRING_UP = 1 };
+
+    // range: cameras, FleetMode. From a cold bus to every camera having
+    // delivered a frame: openAll() then a capture per camera, retried with
+    // readFrame's fixed sleeps, against bringUpAll(). meanReadyMs is the
+    // wait for a camera's first frame, averaged over the cameras
+    static void BM_FleetBringUp(benchmark::State& state) {
+        const int  n       = state.range(0);
+        const bool bringUp = state.range(1) == FLEET_BRING_UP;
+        double readySum = 0;
+        int64_t readyCount = 0;
+        for (auto _ : state) {
+            state.PauseTiming();
+            SimConfig cfg;
+            cfg.fps            = 30;
+            cfg.openMs         = FLEET_OPEN_MS;
+            cfg.warmupFailures = FLEET_WARMUP_FAILURES;
+            for (int i = 0; i < n; ++i) {
+                cfg.serial = FLEET_SERIAL + unsigned(i);
+                SimulatedBus::plug(CAPTURE_SIM_DEVICE + i, cfg);
+            }
+            state.ResumeTiming();
+
+            CameraPool pool;
+            size_t ready = 0;
+            if (bringUp) {
+                for (const DeviceBringUp& r : pool.bringUpAll()) {
+                    if (!r.ready) continue;
+                    ++ready;
+                    readySum += r.readyMs;
+                }
+            } else {
+                const auto start = std::chrono::steady_clock::now();
+                pool.openAll();
+                for (int i = 0; i < n; ++i) {
+                    ThermalCamera* cam = pool.camera(FLEET_SERIAL + unsigned(i));
+                    if (!cam || cam->captureFrame(false).empty()) continue;
+                    ++ready;
+                    readySum += std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - start).count();
+                }
+            }
+            readyCount += int64_t(ready);
+            if (ready != size_t(n)) state.SkipWithError("a simulated camera never got ready");
+
+            state.PauseTiming();
+            pool.closeAll();
+            for (int i = 0; i < n; ++i) SimulatedBus::unplug(CAPTURE_SIM_DEVICE + i);
+            state.ResumeTiming();
+        }
+        state.counters["meanReadyMs"] = readyCount ? readySum / double(readyCount) : 0.0;
+    }
+    BENCHMARK(BM_FleetBringUp)->ArgNames({"cameras", "bringUp"})
+                              ->Args({4, FLEET_SEQUENTIAL})->Args({4, FLEET_BRING_UP})
+                              ->Args({16, FLEET_SEQUENTIAL})->Args({16, FLEET_BRING_UP})
+                              ->UseRealTime()
+                              ->Unit(benchmark::kMillisecond);
+
+} // namespace bench
+} // namespace thermal
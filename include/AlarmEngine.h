@@ -0,0 +1,122 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "FrameSource.h"
+#include "TempStats.h"
+
+namespace thermal {
+
+    enum class AlarmCondition {
+        Above,      // some pixel of the region is above thresholdC
+        Below,      // some pixel of the region is below thresholdC
+        Rise,       // its hottest pixel rose by thresholdC within `seconds`
+    };
+
+    struct AlarmRule {
+        AlarmCondition condition = AlarmCondition::Above;
+        cv::Rect region;                // empty: the whole frame
+        float    thresholdC = 60.0f;    // Rise: the rise in °C
+        // the condition has to hold on this many consecutive frames
+        // before the alarm is raised
+        int      frames     = 1;
+        double   seconds    = 1.0;      // Rise only
+    };
+
+    // Sent when a rule's alarm is raised, and again when its condition
+    // stops holding.
+    struct AlarmEvent {
+        int       ruleId;
+        bool      raised;       // false: cleared
+        // Above: hottest pixel of the region, Below: coldest, Rise: the
+        // rise over the rule's window; all in °C
+        float     value;
+        cv::Point where;        // that pixel (Rise: the hottest one now)
+        FrameInfo info;         // of the frame that raised / cleared it
+    };
+
+
+    // Threshold rules checked on every frame of a stream as soon as its
+    // temperature map is read, ahead of conversion to °C, colorization and
+    // the frame callback. While any rule exists, every streamed frame
+    // fetches its whole temperature map from the SDK on the acquisition
+    // thread, quiet or not. Rules are then compared in the map's own units
+    // (TE_A CV_16U °C * 100 + 5000, or TE_B CV_32F °C) with a vectorized
+    // scan that stops at the first pixel past the threshold, so on top of
+    // that fetch a quiet frame costs one pass over each rule's region; the
+    // hottest or coldest pixel is only looked for when an event goes out.
+    // Rise rules need their region's maximum on every frame.
+    //
+    //   cam.alarms().onAlarm([](const AlarmEvent& e) { ... });
+    //   AlarmRule r;
+    //   r.region = {100, 80, 40, 40};
+    //   r.thresholdC = 85.0f;
+    //   r.frames = 3;
+    //   cam.alarms().addRule(r);
+    //
+    // Rules may be added and removed while streaming.
+    class AlarmEngine {
+        public:
+            using AlarmFn = std::function<void(const AlarmEvent&)>;
+
+            // `level` forces a kernel, e.g. for benchmarking
+            explicit AlarmEngine(SimdLevel level = SimdLevel::Auto);
+
+            // returns the rule's id
+            int  addRule(const AlarmRule& rule);
+            bool remove(int id);
+            void clear();
+            bool empty() const { return count_.load(std::memory_order_relaxed) == 0; }
+            // whether the rule's alarm is raised right now
+            bool active(int id) const;
+
+            // Called on the thread that evaluates (the stream's acquisition
+            // thread), before the frame moves on: keep it short. It may
+            // edit the rules.
+            void onAlarm(AlarmFn fn);
+
+            // Checks every rule against one frame's temperature map and
+            // sends the events; returns how many went out. One thread at
+            // a time, frames in order.
+            int  evaluate(const cv::Mat& temp, const FrameInfo& info);
+            // forget consecutive counts, raised alarms and Rise history
+            void reset();
+
+        private:
+            struct Sample {
+                std::chrono::steady_clock::time_point t;
+                float value;
+            };
+            struct Rule {
+                int       id;
+                AlarmRule def;
+                int       streak{0};        // consecutive frames it held
+                bool      raised{false};
+                // region maxima of the last `seconds`, increasing, so the
+                // front is the minimum (Rise)
+                std::deque<Sample> history;
+            };
+
+            // condition of one rule on this frame; `value` is the rise
+            // for Rise rules
+            bool check(Rule& r, const cv::Mat& region, const FrameInfo& info,
+                       float& value) const;
+            void fill(const Rule& r, const cv::Mat& region, cv::Point origin,
+                      bool raised, float value, const FrameInfo& info);
+
+            SimdLevel                level_;
+            mutable std::mutex       mutex_;
+            std::vector<Rule>        rules_;
+            int                      nextId_{1};
+            std::atomic<int>         count_{0};
+            std::shared_ptr<const AlarmFn> callback_;
+            std::vector<AlarmEvent>  events_;   // of the frame being evaluated
+        };
+
+} // namespace thermal
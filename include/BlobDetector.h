@@ -0,0 +1,79 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace thermal {
+
+    // One connected region of pixels above the threshold.
+    struct Blob {
+        int         area;       // pixels
+        cv::Point2f centroid;
+        cv::Rect    box;
+        float       peakTemp;   // in °C
+        cv::Point   peakLoc;    // first occurrence in row order
+        float       meanTemp;   // in °C
+    };
+
+    struct BlobOptions {
+        float thresholdC    = 40.0f;    // pixels strictly above it count
+        int   minArea       = 1;        // smaller regions are left out
+        bool  eightConnected = true;    // false: 4-connected
+        // rows per tile; tiles are labelled in parallel, then merged
+        int   tileRows      = 64;
+        bool  parallel      = true;
+    };
+
+    // Connected components of a temperature map (CalcTemp / CalcEntireTemp
+    // output: CV_16U °C * 100 + 5000, or CV_32F °C) above a threshold.
+    //
+    // Each tile of rows is labelled on its own with a flat union-find over
+    // pixel indices (a root is the smallest index of its tree, so one
+    // forward pass flattens it) and accumulates its regions' statistics;
+    // the merge step then joins regions across tile edges and adds up
+    // their partial statistics. Scratch buffers are kept between frames,
+    // so detecting on frames of one size allocates nothing. One detector
+    // per thread.
+    class BlobDetector {
+        public:
+            explicit BlobDetector(const BlobOptions& opts = BlobOptions())
+                : opts_(opts) {}
+
+            void setOptions(const BlobOptions& opts) { opts_ = opts; }
+            const BlobOptions& options() const { return opts_; }
+
+            // fills `out` (replaced) with the regions, hottest peak first
+            void detect(const cv::Mat& temp, std::vector<Blob>& out);
+
+        private:
+            // statistics of one region in native units
+            struct Acc {
+                int      root;
+                int      area;
+                int      x0, y0, x1, y1;
+                int64_t  sumX, sumY;
+                double   sum;
+                float    peak;
+                int      peakIdx;
+            };
+
+            void resize(int width, int height, int tiles);
+            template <typename T>
+            void labelTile(const cv::Mat& temp, T threshold, int tile, int y0, int y1);
+            template <typename T>
+            void mergeTiles(const cv::Mat& temp, T threshold, int tiles, int tileRows);
+            int  find(int p);
+
+            BlobOptions opts_;
+            int width_{0}, height_{0};
+            std::vector<int32_t>          parent_;   // per pixel, foreground only
+            std::vector<int32_t>          slot_;     // root -> index in an Acc list, -1
+            std::vector<std::vector<Acc>> tileAcc_;  // per tile
+            std::vector<Acc>              merged_;
+        };
+
+    // what Frame::blobs() uses: one BlobDetector per calling thread
+    void detectBlobs(const cv::Mat& temp, const BlobOptions& opts, std::vector<Blob>& out);
+
+} // namespace thermal
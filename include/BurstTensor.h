@@ -0,0 +1,54 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <vector>
+#include "FrameSource.h"
+
+namespace thermal {
+
+    enum class BurstData {
+        Raw,        // the frames as read (FrameSource::frameType)
+        Celsius,    // each frame's temperature map
+    };
+
+    // applied to every frame of the tensor on its own, in place
+    enum class BurstNorm {
+        None,
+        MinMax,         // to 0..1
+        Standardize,    // to zero mean, unit variance
+    };
+
+    struct BurstLayout {
+        BurstData data = BurstData::Raw;
+        // element type of the tensor: CV_16U or CV_32F. CV_16U temperatures
+        // are in the TE_A encoding (°C * 100 + 5000) on either family.
+        int       type = CV_32F;
+        BurstNorm normalize = BurstNorm::None;  // CV_32F only
+        bool      applyAgc = false;
+    };
+
+    // N consecutive frames in one contiguous buffer, N x H x W in row-major
+    // order: `tensor` holds them stacked, N*H rows of W, so its data can go
+    // to a batched model as is (cv::Mat allocations are 64-byte aligned).
+    // Capturing into the same BurstTensor again with the same N, size and
+    // type reuses the buffer; so does pointing `tensor` at memory of one's
+    // own (a cv::Mat header over it) of the right shape.
+    struct BurstTensor {
+        cv::Mat                tensor;
+        std::vector<FrameInfo> info;    // per frame: index, read time, FPA °C
+
+        int     frames() const { return int(info.size()); }
+        // H x W view of frame i; empty if there is no such frame
+        cv::Mat frame(int i) const;
+    };
+
+    // whether a layout can be captured; logs why not
+    bool validBurstLayout(const BurstLayout& layout);
+    // shapes `out` for n frames of h x w, keeping its buffer if it fits
+    void prepareBurst(BurstTensor& out, int n, int h, int w, int type);
+    // a frame (or temperature map, celsius) of another element type into
+    // its tensor slot
+    void convertBurstFrame(const cv::Mat& src, cv::Mat& dst, bool celsius);
+    void normalizeBurstFrame(cv::Mat& frame, BurstNorm norm);
+
+} // namespace thermal
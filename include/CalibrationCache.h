@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "DeviceBackend.h"
+
+namespace thermal {
+
+    struct CalibrationCacheStats {
+        uint64_t hits;          // entries loaded into a device
+        uint64_t misses;        // no entry for the device
+        uint64_t stale;         // older than maxAge: removed
+        uint64_t corrupt;       // bad header or checksum, or refused by the device: removed
+        uint64_t stores;        // entries written
+    };
+
+    // Shutter calibrations kept on disk, one entry per camera, keyed by its
+    // nCoreID and open() model, so a camera that was calibrated before
+    // gets its offsets back at open instead of running another shutter
+    // cycle. An entry is the SDK's SaveCalibration file behind a small
+    // header: format version, key, sensor size, when it was saved, and a
+    // checksum of the SDK data. Entries are written to a temporary file and
+    // renamed into place, so a reader never sees half of one. An entry that
+    // fails its checks, or is older than maxAge, is deleted and counted as
+    // a miss of its own kind; the camera then calibrates as usual.
+    //
+    // One cache may be shared by any number of cameras and threads.
+    class CalibrationCache {
+        public:
+            // maxAge 0: entries never go stale; the directory must exist
+            explicit CalibrationCache(std::string dir,
+                                      std::chrono::seconds maxAge = std::chrono::hours(24 * 7));
+
+            CalibrationCache(const CalibrationCache&) = delete;
+            CalibrationCache& operator=(const CalibrationCache&) = delete;
+
+            const std::string& directory() const { return dir_; }
+            std::chrono::seconds maxAge() const { return maxAge_; }
+
+            // <dir>/calib-<model>-<serial hex>.hkcal
+            std::string pathFor(unsigned int serial, int model) const;
+
+            // apply the entry for (serial, model) to `dev`; false if there is
+            // no usable one
+            bool load(DeviceBackend& dev, unsigned int serial, int model);
+            // save `dev`'s current calibration as the entry for (serial, model)
+            bool store(DeviceBackend& dev, unsigned int serial, int model);
+            bool remove(unsigned int serial, int model);
+
+            CalibrationCacheStats stats() const;
+
+        private:
+            // a file name no other store()/load() is using
+            std::string tempPath(unsigned int serial, int model);
+
+            std::string          dir_;
+            std::chrono::seconds maxAge_;
+            std::atomic<uint64_t> tempSeq_{0};
+            std::atomic<uint64_t> hits_{0}, misses_{0}, stale_{0}, corrupt_{0}, stores_{0};
+        };
+
+} // namespace thermal
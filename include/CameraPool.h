@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "SpscRing.h"
+#include "ThermalCamera.h"
+
+namespace thermal {
+
+    struct CameraStats {
+        unsigned int serial;        // nCoreID
+        unsigned int deviceNumber;
+        uint64_t frames;            // frames the camera produced
+        uint64_t delivered;         // frames handed to the callback
+        uint64_t dropped;           // lost because the merged consumer lagged
+        double   fps;               // delivered per second since start()
+    };
+
+    struct PoolStats {
+        std::vector<CameraStats> cameras;
+        // sums over all cameras
+        uint64_t frames;
+        uint64_t delivered;
+        uint64_t dropped;
+        double   fps;
+    };
+
+    struct PoolOptions {
+        // false: call back directly on each camera's thread
+        // (concurrently, so the callback must be thread-safe)
+        bool   merged        = true;
+        // pin camera i's acquisition thread to core i (mod cores)
+        bool   pinThreads    = true;
+        // frames queued per camera towards the merge thread
+        size_t queueCapacity = 8;
+        // colorize, or render StreamOptions::outputs if there are any (and
+        // compute stats, with StreamOptions::temperature, and hotspots,
+        // where enabled) on the camera's thread before the frame is handed
+        // over
+        bool   prepare       = true;
+    };
+
+    struct BringUpOptions {
+        ReadyProbe probe;
+        // devices opened and probed at once; 0: all of them
+        int        parallel = 0;
+    };
+
+    // how one device's bring-up went; times count from the start of it
+    struct DeviceBringUp {
+        DeviceInfo info;
+        bool       opened;
+        bool       ready;
+        bool       calibrationRestored;
+        int        probes;      // reads until the first valid frame, or giving up
+        int        lastCode;    // RecvImage code of the last probe
+        double     openMs;      // open() returned
+        double     readyMs;     // first valid frame: time-to-ready (0: never)
+    };
+
+    // Every camera on the bus driven at once. Each camera streams on its own
+    // acquisition thread (optionally pinned to a core of its own), which
+    // reads and prepares the frames; a merge thread then drains the
+    // per-camera SPSC queues round-robin into one callback, so the consumer
+    // sees a single stream tagged with the camera serial while the per-frame
+    // work still runs in parallel on every camera's thread.
+    class CameraPool {
+        public:
+            using FrameFn = std::function<void(unsigned int serial, const Frame&)>;
+
+            CameraPool() = default;
+            ~CameraPool();
+
+            CameraPool(const CameraPool&) = delete;
+            CameraPool& operator=(const CameraPool&) = delete;
+
+            // — Membership —
+            // open every scanned device with the model matching its
+            // productVersion; returns how many were opened
+            size_t openAll();
+            bool   open(const DeviceInfo& dev);
+            // Every scanned device opened and probed concurrently (see
+            // ThermalCamera::waitUntilReady), rather than one after the
+            // other with fixed sleeps. `onReady` is called on the device's
+            // bring-up thread the moment it is ready, so its stream can
+            // start without waiting for the slowest camera; stream it from
+            // there or call start() afterwards, not both. Ready devices
+            // become members; the rest are closed. One entry per scanned
+            // device, in scan order.
+            using ReadyFn = std::function<void(ThermalCamera& cam, const DeviceBringUp& r)>;
+            std::vector<DeviceBringUp> bringUpAll(ReadyFn onReady = nullptr,
+                                                  const BringUpOptions& opts = BringUpOptions());
+            // a camera fed by `source` instead of hardware (simulation,
+            // replay); `serial` tags its frames
+            void   addSource(std::shared_ptr<FrameSource> source,
+                             unsigned int serial);
+            void   closeAll();
+            // given to every camera open() adds from now on, see
+            // ThermalCamera::setCalibrationCache
+            void   setCalibrationCache(std::shared_ptr<CalibrationCache> cache) {
+                calibrationCache_ = std::move(cache);
+            }
+
+            size_t size() const { return members_.size(); }
+            // nullptr if no camera has that serial
+            ThermalCamera* camera(unsigned int serial);
+
+            // — Streaming —
+            // `opts` applies to every camera (its source/cpu are set per camera)
+            void start(FrameFn cb, bool applyAgc = true,
+                       const StreamOptions& opts = StreamOptions(),
+                       const PoolOptions& poolOpts = PoolOptions());
+            void stop();
+            bool running() const { return running_; }
+
+            PoolStats stats() const;
+
+        private:
+            struct Member {
+                DeviceInfo                     info;
+                std::unique_ptr<ThermalCamera> cam;
+                std::shared_ptr<FrameSource>   source;   // nullptr: the device
+                std::unique_ptr<SpscRing<Frame>> queue;
+                std::atomic<uint64_t>          frames{0};
+                std::atomic<uint64_t>          delivered{0};
+                std::atomic<uint64_t>          dropped{0};
+            };
+
+            // a member for `dev` with its camera open, nullptr on failure
+            std::unique_ptr<Member> openMember(const DeviceInfo& dev);
+            void mergeLoop();
+
+            std::vector<std::unique_ptr<Member>> members_;
+            std::shared_ptr<CalibrationCache> calibrationCache_;
+            FrameFn            callback_;
+            PoolOptions        options_;
+            std::thread        mergeThread_;
+            std::atomic<bool>  running_{false};
+            std::chrono::steady_clock::time_point started_, stopped_;
+        };
+
+} // namespace thermal
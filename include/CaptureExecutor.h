@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace thermal {
+
+    // A few threads running short tasks, now or at a point in time. The
+    // asynchronous captures (ThermalCamera::captureFrameAsync and friends)
+    // run on one: a read happens when the camera is due to have a frame
+    // and a failed read is retried from the timer, so no thread ever
+    // sleeps on a camera and a handful of them can drive dozens.
+    //
+    // Tasks run in due order; tasks due at the same time in the order they
+    // were posted. Destroy an executor only once no camera uses it any more.
+    class CaptureExecutor {
+        public:
+            using Clock = std::chrono::steady_clock;
+            using Task  = std::function<void()>;
+
+            explicit CaptureExecutor(int threads = 2);
+            ~CaptureExecutor();     // drops tasks that haven't run
+
+            CaptureExecutor(const CaptureExecutor&) = delete;
+            CaptureExecutor& operator=(const CaptureExecutor&) = delete;
+
+            void post(Task task) { postAt(Clock::now(), std::move(task)); }
+            void postAt(Clock::time_point due, Task task);
+
+            int threads() const { return int(threads_.size()); }
+            // tasks waiting, due or not
+            size_t pending() const;
+
+            // what captures use when given no executor: two threads,
+            // started on first use
+            static CaptureExecutor& shared();
+
+        private:
+            struct Entry {
+                Clock::time_point due;
+                uint64_t          seq;
+                Task              task;
+                // earliest due (then first posted) on top
+                bool operator<(const Entry& o) const {
+                    return due != o.due ? due > o.due : seq > o.seq;
+                }
+            };
+
+            void run();
+
+            mutable std::mutex         mutex_;
+            std::condition_variable    cv_;
+            std::priority_queue<Entry> queue_;
+            uint64_t                   seq_{0};
+            bool                       stop_{false};
+            std::vector<std::thread>   threads_;
+        };
+
+} // namespace thermal
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+
+namespace thermal {
+
+    // Palettes: the SDK's I3_COLORMAP_* ids (0–9), plus OpenCV's JET, which
+    // is what captureImage has always used.
+    const int PALETTE_JET = -1;
+
+    // 256 BGR entries for an 8-bit gray level; built once per palette (the
+    // i3 ones by running i3::ApplyColorMap over a gray ramp) and cached.
+    // Unknown ids fall back to JET.
+    const uint8_t* paletteLut(int palette);
+
+    // Frames of at least this many pixels are colorized in row stripes
+    // across cores.
+    const int COLORIZE_PARALLEL_MIN_PIXELS = 200000;
+
+    // How 16-bit values map to palette entries: idx = round(min(v - lo,
+    // span) * scale / 65536), v below lo counting as lo; scale is the
+    // 16.16 gain, and clamping to span keeps the product within 32 bits.
+    struct ColorRange {
+        uint16_t lo;
+        uint32_t span;
+        uint32_t scale;
+    };
+    // [lo, hi] over the whole palette; hi <= lo maps everything to its bottom
+    ColorRange colorRange(uint16_t lo, uint16_t hi);
+    // the range colorize16(raw16, bgr, palette, applyAgc) uses
+    ColorRange colorRange(const cv::Mat& raw16, bool applyAgc);
+
+    // 16-bit frame -> BGR in a single pass: each pixel is mapped linearly
+    // from [lo, hi] to 0–255 (values outside are clamped), quantized and
+    // looked up in the palette straight into `bgr`, with no 8-bit
+    // intermediate. `bgr` is reused if it is already rows x cols CV_8UC3.
+    // Large frames are split into row stripes across cores.
+    void colorize16(const cv::Mat& raw16, cv::Mat& bgr, int palette,
+                    uint16_t lo, uint16_t hi);
+
+    // Same, with the range the old path used: the frame's own min/max
+    // without AGC, or the top byte of the AGC-stretched 16-bit value.
+    void colorize16(const cv::Mat& raw16, cv::Mat& bgr, int palette,
+                    bool applyAgc);
+
+} // namespace thermal
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FrameSource.h"
+
+namespace thermal {
+
+    struct DeviceInfo {
+        unsigned int deviceNumber;   // 0–31
+        unsigned int productVersion; // I3_TE_Q1, I3_TE_V1, I3_TE_EQ1, etc.
+        unsigned int serialNumber;   // nCoreID
+    };
+
+    // The two SDK device classes, which differ in frame and temperature
+    // formats: TE_A (EQ1/EV1/EQ2/EV2) reads 16-bit frames and °C * 100 + 5000
+    // temperatures; TE_B (Q1/V1/Q2) reads float frames without AGC, a 16-bit
+    // image with it, and float °C temperatures.
+    enum class DeviceFamily { TE_A, TE_B };
+
+    // One open camera: the RecvImage / CalcTemp / CalcEntireTemp /
+    // ShutterCalibrationOn / SaveCalibration / LoadCalibration /
+    // SetEmissivity surface of the SDK, behind the FrameSource interface so
+    // it can be streamed directly. Destroying the backend closes the device.
+    class DeviceBackend : public FrameSource {
+        public:
+            virtual DeviceFamily family() const = 0;
+
+            // formats follow from the family
+            int frameType(bool applyAgc) const override {
+                return (family() == DeviceFamily::TE_B && !applyAgc) ? CV_32F : CV_16U;
+            }
+            int temperatureType() const override {
+                return family() == DeviceFamily::TE_A ? CV_16U : CV_32F;
+            }
+
+            // SDK return code, 1 = ok
+            virtual int  shutterCalibration() = 0;
+            // the offsets of the last shutter calibration to a file, and
+            // back; the file's format is the device's own
+            virtual bool saveCalibration(const std::string& path) { (void)path; return false; }
+            virtual bool loadCalibration(const std::string& path) { (void)path; return false; }
+            virtual void setEmissivity(float e) = 0;
+        };
+
+    // Open device `deviceNumber` as `model` (1=Q1, 2=V1, 3=Engine, 4=Q2):
+    // a simulated device plugged in at that number if there is one (see
+    // SimulatedBus), the real one otherwise. nullptr on failure.
+    std::unique_ptr<DeviceBackend> openDeviceBackend(int model,
+                                                     unsigned int deviceNumber);
+    // the i3 SDK backends only
+    std::unique_ptr<DeviceBackend> openSdkBackend(int model,
+                                                  unsigned int deviceNumber);
+
+    // real devices (ScanTE) plus simulated ones; a simulated device hides a
+    // real one at the same device number
+    std::vector<DeviceInfo> scanDeviceBackends();
+    std::vector<DeviceInfo> scanSdkDevices();
+
+} // namespace thermal
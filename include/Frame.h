@@ -0,0 +1,95 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "BlobDetector.h"
+#include "FrameOutputs.h"
+#include "FramePool.h"
+#include "FrameSource.h"
+#include "RoiEngine.h"
+#include "TempStats.h"
+
+namespace thermal {
+
+    class ModelKernels;
+
+    // Everything one readout of the sensor yields: the raw frame plus the
+    // views derived from it. Only the raw frame is produced up front; the
+    // temperature map, its statistics and the colorized image are computed
+    // on first access and cached. Copies are cheap and share that cache, so
+    // whichever consumer asks first pays and the rest reuse the result.
+    class Frame {
+        public:
+            using RenderFn = std::function<void(const cv::Mat& raw, cv::Mat& out)>;
+
+            Frame() = default;
+            // `source` supplies the temperature map; pass nullptr for a
+            // frame without one. `rois` is measured by rois(). With
+            // keepTemperature false the source is only consulted for the
+            // ROIs and pin() leaves the full map unread, unless `blobs`
+            // asks for hotspot detection on it or `outputs` for a block
+            // grid. `kernels` converts the map to °C (genericKernels() if
+            // nullptr).
+            Frame(cv::Mat raw, const FrameInfo& info, RenderFn render,
+                  std::shared_ptr<FrameSource> source = nullptr,
+                  FramePool* pool = nullptr,
+                  std::shared_ptr<const RoiSet> rois = nullptr,
+                  bool keepTemperature = true,
+                  std::shared_ptr<const BlobOptions> blobs = nullptr,
+                  std::shared_ptr<const OutputSet> outputs = nullptr,
+                  const ModelKernels* kernels = nullptr);
+
+            bool empty() const { return !s_; }
+
+            const cv::Mat&   raw() const;
+            const FrameInfo& info() const;
+
+            // temperature map as the SDK produced it (see computeTempStats);
+            // empty if the frame has none
+            const cv::Mat&   temperatureRaw() const;
+            // temperature map in °C, CV_32F
+            const cv::Mat&   temperature() const;
+            // zeros if the frame has no temperature map
+            const TempStats& stats() const;
+            // the image captureImage would have returned for this readout
+            const cv::Mat&   color() const;
+            // min/max/mean of every ROI, in RoiSet order. A sparse set reads
+            // just its pixels from the source while it still holds this
+            // readout; otherwise they come from the temperature map.
+            const std::vector<RoiStats>& rois() const;
+            // regions above the detection threshold, hottest first; empty
+            // if detection was off when the frame was acquired
+            const std::vector<Blob>& blobs() const;
+            // the stream's OutputSpecs (StreamOptions::outputs), in order,
+            // all computed on first access; empty if it asked for none
+            const std::vector<FrameOutput>& outputs() const;
+
+            // measure the ROIs and fetch the temperature map now, while the
+            // source still holds this readout (see FrameTracker)
+            void pin() const;
+
+        private:
+            friend class FrameTracker;
+            struct State;
+            std::shared_ptr<State> s_;
+        };
+
+
+    // The SDK only keeps the latest readout for CalcTemp/CalcEntireTemp.
+    // A producer tracks the last Frame it handed out and calls retire()
+    // before the source reads again: if that frame is still referenced its
+    // ROIs and temperature map are fetched then, otherwise nobody needs them
+    // and the conversion is skipped altogether.
+    class FrameTracker {
+        public:
+            void retire();
+            void track(const Frame& f);
+
+        private:
+            std::mutex                   mutex_;
+            std::weak_ptr<Frame::State>  last_;
+        };
+
+} // namespace thermal
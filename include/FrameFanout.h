@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Frame.h"
+
+namespace thermal {
+
+    // what a subscriber's queue does when a frame arrives and it is full
+    enum class Backpressure {
+        DropOldest,     // the oldest queued frame makes room for it
+        LatestOnly,     // a queue of one: the newest frame replaces it
+        // the stream waits for room: nothing is lost, but the stream, and
+        // with it every other subscriber, slows down to this one
+        Block,
+    };
+
+    struct SubscribeOptions {
+        Backpressure policy   = Backpressure::DropOldest;
+        size_t       capacity = 4;      // DropOldest / Block; LatestOnly holds 1
+        std::string  name;              // reported in SubscriberStats
+    };
+
+    struct SubscriberStats {
+        int         id;
+        std::string name;
+        uint64_t    received;       // frames published while subscribed
+        uint64_t    delivered;      // callbacks that returned
+        uint64_t    dropped;        // frames pushed out before delivery
+        size_t      queueDepth;     // frames waiting right now
+        size_t      maxQueueDepth;  // high-water mark of queueDepth
+        // frames published but not yet delivered (queued plus the one in
+        // the callback), and the age of the frame the latest callback
+        // started on, since it was read
+        uint64_t    lagFrames;
+        double      lagMs;
+    };
+
+    // Hands every published Frame to any number of subscribers, each with
+    // its own bounded queue and its own delivery thread. Frames are queued
+    // by reference (a Frame copy shares the readout and its lazy views), so
+    // publishing costs a lock and a few pointer copies per subscriber.
+    // publish() never waits on a DropOldest or LatestOnly subscriber: it
+    // takes each queue's lock only to push, and a delivery thread holds it
+    // only to pop, never across a callback. So however slow a subscriber's
+    // callback, it delays nobody else; it only loses frames of its own.
+    // Block subscribers are the one exception, by request.
+    //
+    // subscribe / unsubscribe may be called at any time, from any thread.
+    class FrameFanout {
+        public:
+            using Callback = std::function<void(const Frame&)>;
+
+            FrameFanout() = default;
+            ~FrameFanout();     // unsubscribes everyone
+
+            FrameFanout(const FrameFanout&) = delete;
+            FrameFanout& operator=(const FrameFanout&) = delete;
+
+            // returns the subscriber's id; the callback runs on its own thread
+            int  subscribe(Callback cb, const SubscribeOptions& opts = SubscribeOptions());
+            // Drops the queued frames and waits for a running callback to
+            // return, unless called from that callback itself. false if the
+            // id is unknown.
+            bool unsubscribe(int id);
+            void clear();
+
+            bool empty() const;
+            // frame producer: queue `f` for every subscriber
+            void publish(const Frame& f);
+
+            std::vector<SubscriberStats> stats() const;
+
+        private:
+            struct Subscriber;
+            using List = std::vector<std::shared_ptr<Subscriber>>;
+
+            static void deliverLoop(std::shared_ptr<Subscriber> s);
+            static void stop(Subscriber& s);
+
+            // edited under mutex_ by copying; publish() reads a snapshot
+            mutable std::mutex          mutex_;
+            std::shared_ptr<const List> subscribers_;
+            int                         nextId_{1};
+        };
+
+} // namespace thermal
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <functional>
+#include <vector>
+#include "FramePool.h"
+
+namespace thermal {
+
+    enum class OutputKind {
+        Thumbnail,      // the whole frame, scale times smaller each way
+        Crop,           // a region at full resolution
+        BlockGrid,      // max / mean temperature of each cell of a grid
+    };
+
+    // One reduced view a stream hands out alongside (or instead of) the
+    // full-resolution image; see StreamOptions::outputs.
+    struct OutputSpec {
+        OutputKind kind = OutputKind::Thumbnail;
+        int        scale = 4;           // Thumbnail: pixels averaged per side, 1–64
+        cv::Rect   region;              // Crop: clipped to the frame
+        cv::Size   grid{16, 12};        // BlockGrid: columns x rows
+
+        static OutputSpec thumbnail(int scale);
+        static OutputSpec crop(cv::Rect region);
+        static OutputSpec blockGrid(int cols, int rows);
+    };
+    using OutputSet = std::vector<OutputSpec>;
+
+    struct FrameOutput {
+        OutputKind kind;
+        // Thumbnail / Crop: rendered as Frame::color() renders the whole
+        // frame (a crop of a frame without AGC is stretched over its own
+        // range)
+        cv::Mat    image;
+        // BlockGrid: CV_32F °C, grid.height x grid.width; empty if the
+        // frame has no temperature map
+        cv::Mat    max, mean;
+    };
+
+    // whether some spec needs the frame's temperature map
+    bool needsTemperature(const OutputSet& specs);
+
+    // Every spec's output of one frame. The image outputs come from one
+    // pass over the raw frame's rows, each row feeding every thumbnail's
+    // box sums and every crop that covers it while it is in cache; only
+    // the reduced frames are then rendered (with `render`, the Frame's
+    // RenderFn). Block grids take one pass over `temp` (TE_A CV_16U
+    // °C * 100 + 5000, or CV_32F °C). Buffers come from `pool` if given.
+    void renderOutputs(const cv::Mat& raw, const cv::Mat& temp, const OutputSet& specs,
+                       const std::function<void(const cv::Mat&, cv::Mat&)>& render,
+                       FramePool* pool, std::vector<FrameOutput>& out);
+
+    // max and mean of each cell of a grid over a temperature map, in °C
+    void blockGrid(const cv::Mat& temp, cv::Size grid, cv::Mat& max, cv::Mat& mean,
+                   FramePool* pool = nullptr);
+
+} // namespace thermal
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace thermal {
+
+    // What to do when a frame took longer than its slot.
+    enum class CatchUpPolicy {
+        Skip,   // drop the missed slots and realign to the schedule
+        Burst,  // run the late slots back to back until caught up
+    };
+
+    struct PacerStats {
+        uint64_t ticks;          // deadlines served
+        uint64_t skipped;        // slots given up under CatchUpPolicy::Skip
+        uint64_t late;           // ticks that started after their deadline
+        double   meanJitterUs;   // mean |wake-up - deadline|
+        double   maxJitterUs;
+    };
+
+    // Paces a loop on an absolute monotonic schedule: deadline k is
+    // start + k * period, so time spent in capture or callbacks is absorbed
+    // instead of accumulating as drift the way a fixed sleep does.
+    class FramePacer {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            explicit FramePacer(double fps = 30.0,
+                                CatchUpPolicy policy = CatchUpPolicy::Skip);
+
+            // restart the schedule from now (and clear the stats)
+            void reset(double fps, CatchUpPolicy policy);
+
+            // block until the next deadline; returns how many slots were
+            // skipped to get there (always 0 under Burst)
+            uint64_t wait();
+
+            double fps() const { return fps_; }
+            PacerStats stats() const;
+
+        private:
+            double            fps_;
+            CatchUpPolicy     policy_;
+            Clock::duration   period_;
+            Clock::time_point deadline_;
+            bool              started_{false};
+
+            // written by the pacing thread, read by anyone
+            std::atomic<uint64_t> ticks_{0};
+            std::atomic<uint64_t> skipped_{0};
+            std::atomic<uint64_t> late_{0};
+            std::atomic<uint64_t> jitterSumNs_{0};
+            std::atomic<uint64_t> jitterMaxNs_{0};
+        };
+
+} // namespace thermal
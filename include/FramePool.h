@@ -0,0 +1,64 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace thermal {
+
+    struct FramePoolStats {
+        size_t heapAllocations; // buffers the pool had to take from the heap
+        size_t acquisitions;    // Mats handed out since creation
+        size_t outstanding;     // buffers still referenced by some cv::Mat
+        size_t idle;            // buffers parked in the pool, ready for reuse
+    };
+
+    // Recycling allocator for frame-sized cv::Mat storage.
+    //
+    // Mats created through the pool are ordinary ref-counted cv::Mat views;
+    // when the last copy is released the storage goes back to the pool
+    // instead of the heap. Once every frame size in use has been seen, no
+    // further heap allocation happens (heapAllocations stays flat).
+    //
+    // The owner never deletes the pool directly: release() hands it over to
+    // the outstanding Mats, and the last one to drop frees it.
+    class FramePool : public cv::MatAllocator {
+        public:
+            static FramePool* create();
+            void release();
+
+            // make sure `count` idle buffers of `bytes` each are available
+            void reserve(size_t bytes, size_t count);
+
+            // (re)point `m` at pooled storage of the given shape; a Mat that
+            // already has that shape is left as is and written in place
+            void acquire(cv::Mat& m, int rows, int cols, int type);
+
+            FramePoolStats stats() const;
+
+            // — cv::MatAllocator interface —
+            cv::UMatData* allocate(int dims, const int* sizes, int type,
+                                   void* data, size_t* step,
+                                   cv::AccessFlag flags,
+                                   cv::UMatUsageFlags usage) const override;
+            bool allocate(cv::UMatData* u, cv::AccessFlag flags,
+                          cv::UMatUsageFlags usage) const override;
+            void deallocate(cv::UMatData* u) const override;
+
+        private:
+            FramePool() = default;
+            ~FramePool() override;
+
+            cv::UMatData* take(size_t bytes) const;   // caller holds mutex_
+
+            mutable std::mutex                 mutex_;
+            mutable std::vector<cv::UMatData*> idle_;
+            mutable size_t                     blocks_{0};
+            mutable size_t                     heapAllocations_{0};
+            mutable size_t                     acquisitions_{0};
+            mutable size_t                     outstanding_{0};
+            mutable bool                       released_{false};
+        };
+
+} // namespace thermal
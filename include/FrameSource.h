@@ -0,0 +1,110 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace thermal {
+
+    class CameraMetrics;
+
+    // Per-frame bookkeeping delivered alongside each streamed frame.
+    // sequence counts every frame slot of the source, so a jump means frames
+    // were lost; dropped is the running total of such lost frames.
+    struct FrameInfo {
+        uint64_t sequence;
+        std::chrono::steady_clock::time_point timestamp;   // when the read completed
+        uint64_t dropped;
+        // sensor (FPA) temperature in °C at that readout, NaN if unknown
+        float    fpaTemp = std::numeric_limits<float>::quiet_NaN();
+    };
+
+    // Anything that produces raw thermal frames: the open camera, or a
+    // synthetic generator so the streaming path can run without hardware.
+    class FrameSource {
+        public:
+            virtual ~FrameSource() = default;
+
+            virtual int width() const = 0;
+            virtual int height() const = 0;
+
+            // element type of the frames read() fills: CV_16U, or CV_32F for
+            // TE_B without AGC
+            virtual int frameType(bool applyAgc) const;
+
+            // rate the source produces frames at, 0 if unknown
+            virtual double nominalFps() const { return 0; }
+            // when read() will next have a frame without waiting for one;
+            // now if the source can't tell (RecvImage just blocks)
+            virtual std::chrono::steady_clock::time_point nextFrameAt() const {
+                return std::chrono::steady_clock::now();
+            }
+
+            // fill `dst` (already height x width of frameType)
+            // same return codes as RecvImage: 1 = ok, 2–4 = read failures
+            virtual int read(cv::Mat& dst, bool applyAgc) = 0;
+
+            // Temperature map of the frame most recently read(): CV_16U in
+            // the TE_A encoding (°C * 100 + 5000) or CV_32F °C (TE_B), -1 if
+            // the source has none. Like the SDK, only the latest readout is
+            // available, so this must happen before the next read().
+            virtual int  temperatureType() const { return -1; }
+            virtual bool readTemperature(cv::Mat&) { return false; }
+            // One pixel of that same map in °C (CalcTemp(x, y) on the
+            // camera), for when only a handful of pixels are wanted; false
+            // if the source can't read single pixels.
+            virtual bool temperatureAt(int, int, float&) { return false; }
+
+            // FPA temperature (°C) of the latest readout, NaN if unknown
+            virtual float fpaTemperature() {
+                return std::numeric_limits<float>::quiet_NaN();
+            }
+
+            // attempts readFrame makes by default; 1 for sources that
+            // already retry (or wait) inside read()
+            virtual int readAttempts() const { return 3; }
+        };
+
+    // One frame, retrying while the sensor warms up; returns the last code.
+    // maxRetries 0 uses src.readAttempts(). With `metrics` every attempt's
+    // read time and every failure code is recorded there.
+    int readFrame(FrameSource& src, cv::Mat& dst, bool applyAgc,
+                  int maxRetries = 0, CameraMetrics* metrics = nullptr);
+
+
+    // Synthetic 16-bit scene: a fixed gradient background with a warm
+    // blob drifting across it. fps == 0 produces frames as fast as asked.
+    class SyntheticFrameSource : public FrameSource {
+        public:
+            SyntheticFrameSource(int width = 384, int height = 288,
+                                 double fps = 0);
+
+            int width() const override  { return w_; }
+            int height() const override { return h_; }
+            int read(cv::Mat& dst, bool applyAgc) override;
+            double nominalFps() const override { return fps_; }
+            // the non-AGC scene read as °C * 100 + 5000: 20 °C background
+            // ramping up by a few degrees, 70 °C blob
+            int  temperatureType() const override { return CV_16U; }
+            bool readTemperature(cv::Mat& dst) override;
+            bool temperatureAt(int x, int y, float& celsius) override;
+
+            uint64_t framesProduced() const { return frames_; }
+
+        private:
+            void renderScene(cv::Mat& dst, bool applyAgc, uint64_t frame) const;
+            // blob centre and half-size on `frame`
+            void blob(uint64_t frame, int& cx, int& cy, int& r) const;
+
+            int w_, h_;
+            double fps_;
+            std::chrono::steady_clock::duration period_;
+            std::chrono::steady_clock::time_point next_;
+            std::vector<unsigned short> background_;
+            std::vector<unsigned short> backgroundAgc_;
+            uint64_t frames_{0};
+        };
+
+} // namespace thermal
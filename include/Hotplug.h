@@ -0,0 +1,31 @@
+#pragma once
+
+#include <functional>
+#include "i3system_TE.h"
+
+namespace thermal {
+
+    // Fans the SDK's single process-wide hotplug callback out to any number
+    // of subscribers, each keyed by the device number it cares about (or
+    // ANY_DEVICE). Handlers run on the SDK's hotplug thread, outside the
+    // registry lock, so they may (un)subscribe; one that was removed while
+    // a dispatch was under way can still see that last event.
+    class HotplugDispatcher {
+        public:
+            using Handler = std::function<void(i3::TE_STATE)>;
+            static const int ANY_DEVICE = -1;
+
+            // returns a token for unsubscribe(); installs the SDK callback
+            // on first use
+            static int  subscribe(int deviceNumber, Handler h);
+            static void unsubscribe(int token);
+
+            // deliver an event as if the SDK had reported it (TE_ARRIVAL /
+            // TE_REMOVAL for state.nUsbNum), e.g. to exercise reconnects
+            static void inject(i3::TE_STATE state);
+
+        private:
+            static void dispatch(i3::TE_STATE state);   // SDK entry point
+        };
+
+} // namespace thermal
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace thermal {
+
+    struct HistogramSnapshot {
+        uint64_t count;
+        uint64_t sumNs;
+        uint64_t maxNs;
+        // (upper bound in ns, samples) of every non-empty bucket, ascending
+        std::vector<std::pair<uint64_t, uint64_t>> buckets;
+
+        double meanNs() const { return count ? double(sumNs) / count : 0.0; }
+        // upper bound of the bucket holding quantile q (0–1), 0 if empty
+        uint64_t percentileNs(double q) const;
+    };
+
+    // Latency histogram in the HDR style: every power of two is split into
+    // 2^SUB_BITS linear buckets, so any value from 1 ns to 2^64 ns is kept
+    // to within 12.5 %. Recording is a couple of relaxed atomic adds; no
+    // locks, no allocation, safe from any number of threads.
+    class LatencyHistogram {
+        public:
+            static const int SUB_BITS = 3;
+            static const int BUCKETS  = (64 - SUB_BITS + 1) << SUB_BITS;
+
+            LatencyHistogram() { reset(); }
+
+            void record(uint64_t ns);
+            HistogramSnapshot snapshot() const;
+            void reset();
+
+            static int      bucketOf(uint64_t ns);
+            static uint64_t upperBound(int bucket);
+
+        private:
+            std::atomic<uint64_t> counts_[BUCKETS];
+            std::atomic<uint64_t> sum_;
+            std::atomic<uint64_t> max_;
+        };
+
+    // the timed steps of getting a frame out
+    enum class Stage {
+        Read,       // one RecvImage (FrameSource::read) attempt
+        Convert,    // 16/32 -> 8-bit conversion of the image
+        Colorize,   // fused range mapping + palette lookup
+        Callback,   // the user's stream callback
+        Count
+    };
+
+    struct MetricsSnapshot {
+        uint64_t frames;        // frames captured or delivered to a callback
+        uint64_t readFailures;  // reads given up after the last retry
+        // failed read attempts by RecvImage return code (2–4; 0 = other)
+        uint64_t retries[5];
+        uint64_t dropped;       // frames skipped by the pacer or the pipeline
+        HistogramSnapshot stages[int(Stage::Count)];
+
+        const HistogramSnapshot& stage(Stage s) const { return stages[int(s)]; }
+    };
+
+    // Per-camera counters and stage histograms. Off by default: while
+    // disabled the hot paths only test one relaxed flag.
+    class CameraMetrics {
+        public:
+            void setEnabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+            bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+            void record(Stage s, uint64_t ns) { stages_[int(s)].record(ns); }
+            void countFrame()       { frames_.fetch_add(1, std::memory_order_relaxed); }
+            void countReadFailure() { readFailures_.fetch_add(1, std::memory_order_relaxed); }
+            void countRetry(int code);
+            void countDropped(uint64_t n) {
+                if (n) dropped_.fetch_add(n, std::memory_order_relaxed);
+            }
+
+            MetricsSnapshot snapshot() const;
+            void reset();
+
+        private:
+            std::atomic<bool>     enabled_{false};
+            std::atomic<uint64_t> frames_{0};
+            std::atomic<uint64_t> readFailures_{0};
+            std::atomic<uint64_t> retries_[5] = {};
+            std::atomic<uint64_t> dropped_{0};
+            LatencyHistogram      stages_[int(Stage::Count)];
+        };
+
+    // Times a scope into one stage of `m`; does nothing (not even read the
+    // clock) when `m` is null or disabled.
+    class StageTimer {
+        public:
+            StageTimer(CameraMetrics* m, Stage s)
+                : m_(m && m->enabled() ? m : nullptr), s_(s) {
+                if (m_) t0_ = std::chrono::steady_clock::now();
+            }
+            ~StageTimer() {
+                if (m_) m_->record(s_, uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - t0_).count()));
+            }
+            StageTimer(const StageTimer&) = delete;
+            StageTimer& operator=(const StageTimer&) = delete;
+
+        private:
+            CameraMetrics* m_;
+            Stage          s_;
+            std::chrono::steady_clock::time_point t0_;
+        };
+
+    // Prometheus text exposition (format 0.0.4) of one or more cameras,
+    // each labelled camera="<name>": thermal_frames_total,
+    // thermal_read_retries_total{code}, thermal_read_failures_total,
+    // thermal_frames_dropped_total and a thermal_<stage>_seconds histogram
+    // per stage.
+    std::string formatPrometheus(
+        const std::vector<std::pair<std::string, MetricsSnapshot>>& cameras);
+
+    // Minimal HTTP endpoint answering every GET with the text `body()`
+    // returns, for a Prometheus scraper. Binds to loopback unless told
+    // otherwise; one connection at a time on its own thread.
+    class MetricsServer {
+        public:
+            using BodyFn = std::function<std::string()>;
+
+            MetricsServer() = default;
+            ~MetricsServer();
+
+            // port 0 picks a free one (see port()); false if it can't listen
+            bool start(int port, BodyFn body,
+                       const std::string& bindAddress = "127.0.0.1");
+            void stop();
+            int  port() const { return port_; }
+            bool running() const { return running_; }
+
+        private:
+            void serveLoop();
+
+            BodyFn            body_;
+            int               fd_{-1};
+            int               port_{0};
+            std::atomic<bool> running_{false};
+            std::thread       thread_;
+        };
+
+} // namespace thermal
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include "DeviceBackend.h"
+
+namespace thermal {
+
+    // The per-frame kernels of the capture path for one sensor model. For
+    // the known models (ModelTraits.h) they are instantiated with the
+    // resolution and the temperature encoding fixed at compile time, so the
+    // loops have constant trip counts and element types and the compiler
+    // unrolls and vectorizes them; frames of any other size get the generic
+    // kernels. A camera picks its set once when it opens, and every frame
+    // then goes through the same calls.
+    class ModelKernels {
+        public:
+            virtual ~ModelKernels() = default;
+
+            // e.g. "TE_A 384x288", or "generic"
+            virtual const char* name() const = 0;
+            virtual bool fixedSize() const = 0;
+
+            // colorize16(raw16, bgr, palette, applyAgc); frames not of the
+            // model's size take the generic path
+            virtual void colorize(const cv::Mat& raw16, cv::Mat& bgr, int palette,
+                                  bool applyAgc) const = 0;
+            // the model's temperature map (TE_A °C * 100 + 5000, TE_B °C)
+            // as CV_32F °C; `out` is written in place if it already has the
+            // size and type. Other maps take the generic path.
+            virtual void celsius(const cv::Mat& native, cv::Mat& out) const = 0;
+        };
+
+    // the set for width x height frames of `family`
+    const ModelKernels& modelKernels(DeviceFamily family, int width, int height);
+    // the generic set, whatever the size
+    const ModelKernels& genericKernels();
+
+} // namespace thermal
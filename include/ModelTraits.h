@@ -0,0 +1,39 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <type_traits>
+#include "DeviceBackend.h"
+
+namespace thermal {
+
+    // One sensor model at compile time: its resolution and its temperature
+    // encoding, so kernels written against it get fixed trip counts and
+    // element types (see ModelKernels).
+    template <DeviceFamily F, int W, int H>
+    struct SensorTraits {
+        static constexpr DeviceFamily family = F;
+        static constexpr int width  = W;
+        static constexpr int height = H;
+        static constexpr int pixels = W * H;
+
+        // temperature map element: TE_A °C * 100 + 5000, TE_B °C
+        using Temp = typename std::conditional<F == DeviceFamily::TE_A,
+                                               uint16_t, float>::type;
+        static constexpr int tempType = F == DeviceFamily::TE_A ? CV_16U : CV_32F;
+
+        // one map element in °C
+        static constexpr float celsius(uint16_t v) { return (float(v) - 5000.0f) * 0.01f; }
+        static constexpr float celsius(float v)    { return v; }
+    };
+
+    // QVGA is 384 x 288, VGA 640 x 480
+    using TraitsEQ1 = SensorTraits<DeviceFamily::TE_A, 384, 288>;
+    using TraitsEV1 = SensorTraits<DeviceFamily::TE_A, 640, 480>;
+    using TraitsEQ2 = TraitsEQ1;
+    using TraitsEV2 = TraitsEV1;
+    using TraitsQ1  = SensorTraits<DeviceFamily::TE_B, 384, 288>;
+    using TraitsV1  = SensorTraits<DeviceFamily::TE_B, 640, 480>;
+    using TraitsQ2  = TraitsQ1;
+
+} // namespace thermal
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Frame.h"
+#include "FrameSource.h"
+
+namespace thermal {
+
+    // What a recording was made from; stored once in the file header.
+    struct RecordingMeta {
+        int      width;
+        int      height;
+        int      rawType;       // CV_16U, or CV_32F (TE_B without AGC)
+        int      tempType;      // CV_16U / CV_32F as in FrameSource, -1: none
+        bool     agc;           // raw frames were read with AGC
+        unsigned serial;        // nCoreID, 0 if unknown
+        float    emissivity;    // NaN: the camera's own setting
+        double   fps;           // nominal rate, 0 if unknown
+    };
+
+    struct RecorderStats {
+        uint64_t framesQueued;
+        uint64_t framesWritten;
+        uint64_t framesDropped; // queue full: the disk couldn't keep up
+        uint64_t bytesWritten;
+        uint64_t chunks;        // write() calls, one per batch
+        bool     failed;        // a write failed; recording stopped there
+    };
+
+    // On-disk layout (little endian, every block 64-byte aligned):
+    //   header | chunk* | index | trailer
+    // A chunk is one batched write: a small header then fixed-size frame
+    // records (timestamp, sequence, FPA temp, raw frame, temperature map).
+    // The index holds every record's offset, so frame i is one lookup away;
+    // a file cut short (crash, power loss) has no index and is re-indexed
+    // by walking the chunk headers instead.
+
+
+    // Appends frames to a recording. write() only queues a reference to
+    // the Frame; a background thread packs queued frames into large batches
+    // and writes each with a single call, so the streaming thread never
+    // waits on the disk.
+    class RecordingWriter {
+        public:
+            RecordingWriter() = default;
+            ~RecordingWriter();
+
+            RecordingWriter(const RecordingWriter&) = delete;
+            RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+            // batchBytes: size of each write; maxQueued: frames waiting for
+            // the writer before new ones are dropped
+            bool open(const std::string& path, const RecordingMeta& meta,
+                      size_t batchBytes = 8u << 20, size_t maxQueued = 64);
+            // flushes everything queued and writes the index
+            void close();
+            bool isOpen() const { return fd_ >= 0; }
+
+            // Queue one frame; call it from the stream callback, while the
+            // source still holds that readout (the temperature map is
+            // fetched here if the meta has one). False if it was dropped.
+            bool write(const Frame& f);
+
+            RecorderStats stats() const;
+
+        private:
+            void writerLoop();
+            void append(const Frame& f);    // into the current batch
+            void flush();                   // current batch -> disk
+
+            int                   fd_{-1};
+            RecordingMeta         meta_{};
+            size_t                recordBytes_{0};
+            size_t                maxQueued_{0};
+
+            std::mutex              mutex_;
+            std::condition_variable cv_;
+            std::deque<Frame>       queue_;
+            bool                    stopping_{false};
+            std::thread             thread_;
+
+            // writer thread only
+            std::vector<char>     batch_;
+            size_t                batchUsed_{0};
+            uint32_t              batchFrames_{0};
+            uint64_t              offset_{0};     // file size so far
+            struct IndexEntry { uint64_t offset; int64_t timestampNs; };
+            std::vector<IndexEntry> index_;
+
+            std::atomic<uint64_t> queued_{0}, written_{0}, dropped_{0},
+                                  bytes_{0}, chunks_{0};
+            std::atomic<bool>     failed_{false};
+        };
+
+
+    // Read-only view of a recording: the file is mmap'ed and frames come
+    // back as cv::Mat headers pointing straight into the mapping, valid for
+    // as long as the reader is open.
+    class RecordingReader {
+        public:
+            RecordingReader() = default;
+            ~RecordingReader();
+
+            RecordingReader(const RecordingReader&) = delete;
+            RecordingReader& operator=(const RecordingReader&) = delete;
+
+            bool open(const std::string& path);
+            void close();
+            bool isOpen() const { return base_ != nullptr; }
+            // false when the index was rebuilt (recording was cut short)
+            bool complete() const { return complete_; }
+
+            const RecordingMeta& meta() const { return meta_; }
+            size_t frameCount() const { return count_; }
+
+            // Frame i, O(1). `temp` is left empty if that frame has no map.
+            bool frame(size_t i, cv::Mat& raw, cv::Mat& temp,
+                       FrameInfo& info) const;
+            // first frame recorded at least `seconds` after the first one
+            size_t seek(double seconds) const;
+
+        private:
+            struct IndexEntry { uint64_t offset; int64_t timestampNs; };
+            const IndexEntry& entry(size_t i) const {
+                return index_ ? index_[i] : rebuilt_[i];
+            }
+
+            int                     fd_{-1};
+            const unsigned char*    base_{nullptr};
+            size_t                  size_{0};
+            RecordingMeta           meta_{};
+            size_t                  recordBytes_{0};
+            const IndexEntry*       index_{nullptr};   // in the mapping
+            std::vector<IndexEntry> rebuilt_;          // or scanned
+            size_t                  count_{0};
+            bool                    complete_{false};
+        };
+
+
+    // Plays a recording back as a FrameSource, so it can be streamed via
+    // StreamOptions::source like a live camera, temperature maps included.
+    // Frames are released on the recorded schedule divided by `speed`
+    // (speed 0: as fast as they're read); since replay keeps its own time,
+    // stream it with StreamOptions::paced = false. At the end read() fails
+    // and the stream stops, unless `loop`.
+    class ReplaySource : public FrameSource {
+        public:
+            explicit ReplaySource(std::shared_ptr<RecordingReader> reader,
+                                  double speed = 1.0, bool loop = false);
+
+            int width() const override  { return reader_->meta().width; }
+            int height() const override { return reader_->meta().height; }
+            int frameType(bool) const override { return reader_->meta().rawType; }
+            double nominalFps() const override {
+                return speed_ > 0 ? reader_->meta().fps * speed_ : 0;
+            }
+            int read(cv::Mat& dst, bool applyAgc) override;
+
+            int  temperatureType() const override { return reader_->meta().tempType; }
+            bool readTemperature(cv::Mat& dst) override;
+            bool temperatureAt(int x, int y, float& celsius) override;
+            float fpaTemperature() override { return fpa_; }
+            int  readAttempts() const override { return 1; }
+
+            // jump to frame i; the next read() returns it
+            void seekFrame(size_t i);
+            size_t position() const { return next_; }
+
+        private:
+            std::shared_ptr<RecordingReader> reader_;
+            double  speed_;
+            bool    loop_;
+            size_t  next_{0};
+            cv::Mat temp_;          // view of the last frame's map
+            float   fpa_;
+            bool    restart_{true}; // re-anchor the schedule on next read
+            std::chrono::steady_clock::time_point wallStart_;
+            int64_t recStartNs_{0};
+        };
+
+} // namespace thermal
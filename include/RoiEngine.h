@@ -0,0 +1,98 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace thermal {
+
+    enum class RoiType { Spot, Rect, Polygon };
+
+    struct RoiStats {
+        int       id;
+        RoiType   type;
+        float     minTemp;  // in °C
+        float     maxTemp;  // in °C
+        float     mean;     // in °C
+        cv::Point minLoc;
+        cv::Point maxLoc;
+        int       pixels;   // 0 if the ROI lies outside the frame
+    };
+
+    // An immutable, preprocessed set of ROIs, shared by every frame measured
+    // against it. Polygons are rasterized to row spans once; rectangles are
+    // cut along all their edges into disjoint cells, so a pixel covered by
+    // several overlapping rectangles is read once and each rectangle's
+    // min/max/mean is assembled from its cells' partial results.
+    class RoiSet {
+        public:
+            using TempAtFn = std::function<float(int x, int y)>;   // °C
+
+            // few enough pixels that reading them one at a time
+            // (CalcTemp(x, y)) beats converting the full frame
+            bool sparse() const { return sparse_; }
+            size_t pixelCount() const { return pixels_; }
+
+            // from a full temperature map: CV_16U (°C * 100 + 5000) or CV_32F °C
+            std::vector<RoiStats> measure(const cv::Mat& temp) const;
+            // pixel by pixel, only where a ROI needs one
+            std::vector<RoiStats> measure(const TempAtFn& tempAt,
+                                          int width, int height) const;
+
+        private:
+            friend class RoiEngine;
+            struct Span { int y, x0, x1; };       // x1 exclusive
+            struct Roi {
+                int               id;
+                RoiType           type;
+                cv::Rect          box;            // spot: 1x1
+                std::vector<Span> spans;          // polygons
+                std::vector<int>  cells;          // rectangles
+            };
+
+            template <typename Get>
+            std::vector<RoiStats> run(Get get, int width, int height) const;
+
+            std::vector<Roi>      rois_;
+            std::vector<cv::Rect> cells_;
+            size_t                pixels_{0};
+            bool                  sparse_{true};
+        };
+
+
+    // ROIs registered once and measured on every frame. Registration is
+    // thread-safe and may happen while streaming; each frame measures
+    // against the snapshot that was current when it was acquired.
+    class RoiEngine {
+        public:
+            // at most this many pixels are read through CalcTemp(x, y)
+            static const size_t SPARSE_LIMIT = 512;
+
+            int  addSpot(cv::Point p);
+            int  addRect(cv::Rect r);
+            int  addPolygon(const std::vector<cv::Point>& pts);
+            bool remove(int id);
+            void clear();
+            bool empty() const;
+
+            // nullptr when no ROI is registered
+            std::shared_ptr<const RoiSet> snapshot() const;
+
+        private:
+            struct Def {
+                int                    id;
+                RoiType                type;
+                std::vector<cv::Point> pts;
+            };
+            int add(RoiType type, std::vector<cv::Point> pts);
+            void rebuild();     // caller holds mutex_
+
+            mutable std::mutex            mutex_;
+            std::vector<Def>              defs_;
+            int                           nextId_{1};
+            std::shared_ptr<const RoiSet> compiled_;
+        };
+
+} // namespace thermal
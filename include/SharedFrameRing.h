@@ -0,0 +1,116 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <string>
+#include "Frame.h"
+#include "FrameSource.h"
+#include "Recording.h"
+
+namespace thermal {
+
+    // Shared-memory layout (POSIX shm object, mapped by every process):
+    //   header | slot 0 | slot 1 | ... | slot n-1
+    // The header holds the RecordingMeta the ring was opened with and the
+    // count of frames published. Frame k goes to slot k % n; each slot
+    // carries a seqlock word, the FrameInfo, the raw frame and the
+    // temperature map. The publisher keeps no per-consumer state, so its
+    // cost doesn't depend on how many processes read along.
+
+    struct SharedRingStats {
+        uint64_t frames;        // frames published / received
+        uint64_t overruns;      // consumer: times it was lapped by the publisher
+        uint64_t lost;          // consumer: frames overwritten before it got to them
+        uint64_t lag;           // consumer: frames published but not yet read
+    };
+
+
+    // Writes streamed frames into a shared-memory ring other processes on
+    // this machine can read without a copy. Call publish() from the stream
+    // callback, like RecordingWriter::write(); it copies the frame in and
+    // never waits for a consumer.
+    //
+    //   SharedFramePublisher pub;
+    //   pub.open("/thermal0", cam.recordingMeta(agc));
+    //   cam.startStream(ThermalCamera::FrameCb(
+    //       [&](const Frame& f) { pub.publish(f); }), agc, opts);
+    class SharedFramePublisher {
+        public:
+            SharedFramePublisher() = default;
+            ~SharedFramePublisher();
+
+            SharedFramePublisher(const SharedFramePublisher&) = delete;
+            SharedFramePublisher& operator=(const SharedFramePublisher&) = delete;
+
+            // `name` is the shm object ("/thermal0"); an existing one is
+            // replaced. More slots give slow consumers more slack.
+            bool open(const std::string& name, const RecordingMeta& meta,
+                      size_t slots = 8);
+            // marks the ring closed (consumers see the end) and unlinks it
+            void close();
+            bool isOpen() const { return base_ != nullptr; }
+
+            // false if the frame doesn't match the meta
+            bool publish(const Frame& f);
+
+            SharedRingStats stats() const;
+
+        private:
+            std::string    name_;
+            unsigned char* base_{nullptr};
+            size_t         size_{0};
+            RecordingMeta  meta_{};
+        };
+
+
+    // One frame read from the ring. The Mats point into the shared mapping:
+    // they stay valid while the consumer is open, but the publisher reuses
+    // the slot once it has published slots-1 further frames. Use
+    // SharedFrameConsumer::intact() to tell whether that happened while the
+    // frame was being used.
+    struct SharedFrame {
+        cv::Mat   raw;
+        cv::Mat   temp;         // empty if the frame has no temperature map
+        FrameInfo info;
+        uint64_t  index;        // position in the ring's frame sequence
+    };
+
+    // Reads frames from a SharedFramePublisher's ring; one per process (or
+    // per thread). Each consumer keeps its own position: one that falls
+    // more than a ring behind skips ahead to the oldest frame still there,
+    // counting the overrun, instead of slowing down the publisher.
+    class SharedFrameConsumer {
+        public:
+            SharedFrameConsumer() = default;
+            ~SharedFrameConsumer();
+
+            SharedFrameConsumer(const SharedFrameConsumer&) = delete;
+            SharedFrameConsumer& operator=(const SharedFrameConsumer&) = delete;
+
+            // fromOldest: start at the oldest frame still in the ring
+            // instead of the next one published
+            bool open(const std::string& name, bool fromOldest = false);
+            void close();
+            bool isOpen() const { return base_ != nullptr; }
+
+            const RecordingMeta& meta() const { return meta_; }
+
+            // Next frame in order, waiting up to timeoutMs (-1: forever).
+            // False on timeout, or once the publisher has closed the ring
+            // and everything in it was read (see closed()).
+            bool next(SharedFrame& f, int timeoutMs = -1);
+            // the slot behind `f` hasn't been reused since next() returned it
+            bool intact(const SharedFrame& f) const;
+            bool closed() const;
+
+            SharedRingStats stats() const;
+
+        private:
+            unsigned char* base_{nullptr};
+            size_t         size_{0};
+            RecordingMeta  meta_{};
+            uint64_t       cursor_{0};     // ring index of the next frame to read
+            uint64_t       frames_{0}, overruns_{0}, lost_{0};
+        };
+
+} // namespace thermal
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "DeviceBackend.h"
+
+namespace thermal {
+
+    // A warm object in the simulated scene: a disc moving by (vx, vy)
+    // pixels per frame, wrapping around the edges.
+    struct SimHotSpot {
+        float x, y;
+        float radius;
+        float celsius;
+        float vx, vy;
+    };
+
+    struct SimConfig {
+        // 384x288 (QVGA) or 640x480 (VGA) like the real sensors
+        int          width  = 384;
+        int          height = 288;
+        DeviceFamily family = DeviceFamily::TE_A;
+        unsigned int serial = 0;        // nCoreID reported by scans
+        // 0: a frame per read, as fast as asked; otherwise reads are held
+        // to this rate like the sensor's own clock
+        double       fps    = 0;
+
+        // scene, in °C: a background rising linearly from `ambient` at the
+        // top-left corner by `gradient` at the bottom-right, temporal noise
+        // of `noise` (rms), and the hot spots on top
+        float        ambient  = 22.f;
+        float        gradient = 4.f;
+        float        noise    = 0.05f;
+        std::vector<SimHotSpot> spots{{96.f, 72.f, 12.f, 65.f, 1.f, 0.75f}};
+        float        fpaTemp  = 31.5f;
+
+        // opening takes this long, like OpenTE_B reading the sensor's flash
+        int          openMs = 0;
+        // the first reads after each open fail with codes 2, 3, 4, 2, …
+        // like a sensor that is still warming up
+        int          warmupFailures = 0;
+        // a shutter calibration holds the caller this long, like the real
+        // shutter cycle; its offsets save to and load from a file as
+        // with SaveCalibration / LoadCalibration
+        int          calibrationMs = 0;
+    };
+
+    // what a simulated device has been through since it was plugged in
+    struct SimCalibrationStats {
+        uint64_t shutterCycles;     // shutterCalibration() calls
+        uint64_t saves;             // successful saveCalibration()
+        uint64_t loads;             // successful loadCalibration()
+    };
+
+    // Simulated cameras on a virtual USB bus. A device plugged in at some
+    // device number is found by ThermalCamera::scanDevices() and opened by
+    // ThermalCamera::open() just like real hardware, so the whole stack
+    // (streams, pools, reconnects) runs, and can be profiled, without a
+    // camera. Plugging and unplugging emit TE_ARRIVAL / TE_REMOVAL through
+    // HotplugDispatcher; handles opened before an unplug keep failing
+    // reads with code 4, as a real disconnected device does.
+    class SimulatedBus {
+        public:
+            static void plug(unsigned int deviceNumber, const SimConfig& cfg);
+            static void unplug(unsigned int deviceNumber);
+            static void clear();    // unplug everything
+
+            static bool present(unsigned int deviceNumber);
+            static std::vector<DeviceInfo> scan();
+            // nullptr if nothing is plugged in there, or `model` doesn't
+            // match the simulated family (3 = TE_A, 1/2/4 = TE_B)
+            static std::unique_ptr<DeviceBackend> open(int model,
+                                                       unsigned int deviceNumber);
+            // zeros if nothing is plugged in there
+            static SimCalibrationStats calibrationStats(unsigned int deviceNumber);
+        };
+
+} // namespace thermal
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "Frame.h"
+#include "TempStats.h"
+
+namespace thermal {
+
+    // Per-pixel statistics over the last `windowFrames` temperature maps,
+    // kept up to date in O(1) per pixel per frame whatever the window:
+    //  - running sums and sums of squares (exact, in 0.01 °C steps) give
+    //    mean and stddev;
+    //  - the sliding maximum uses the block (van Herk / Gil-Werman) form
+    //    of the monotonic deque: the window spans the current block and
+    //    the one before, each block's suffix maxima are built one row per
+    //    frame during the next block, so every pixel does the same fixed
+    //    work and it vectorizes;
+    //  - the oldest and newest maps give the change across the window.
+    // All memory is allocated up front (see memoryBytes(); about
+    // 3 * windowFrames + 16 bytes per pixel). Feed it from the stream
+    // callback; the maps may be read from any thread meanwhile.
+    class SlidingTempStats {
+        public:
+            using Clock = std::chrono::steady_clock;
+
+            // a window of seconds s at f fps is s * f frames; with every = n
+            // only each n-th pushed frame enters it, so the same span needs
+            // n times fewer frames (and memory). windowFrames is rounded up
+            // to an even count and capped at 32768.
+            SlidingTempStats(int width, int height, int windowFrames, int every = 1,
+                             SimdLevel level = SimdLevel::Auto);
+
+            // A temperature map as the camera produced it: CV_16U
+            // (°C * 100 + 5000) or CV_32F (°C). False if the size is wrong.
+            bool push(const cv::Mat& temp, Clock::time_point t = Clock::now());
+            // the frame's temperatureRaw() and timestamp
+            bool push(const Frame& f);
+            void reset();
+
+            // CV_32F maps in °C (stddev and delta too, rate in °C/s) over
+            // the frames in the window; false while it is empty
+            bool mean(cv::Mat& out) const;
+            bool stddev(cv::Mat& out) const;
+            bool max(cv::Mat& out) const;
+            // newest minus oldest frame in the window
+            bool delta(cv::Mat& out) const;
+            // delta divided by the time between those two frames
+            bool rate(cv::Mat& out) const;
+
+            int    windowFrames() const { return window_; }
+            // frames in the window now (< windowFrames() while filling)
+            int    frames() const;
+            // time between the oldest and the newest frame in the window
+            double spanSeconds() const;
+            size_t memoryBytes() const;
+
+        private:
+            // one row per pixel plane: quantized frames, suffix maxima
+            uint16_t* ringRow(uint64_t k) { return ring_.data() + (k % window_) * pixels_; }
+            const uint16_t* ringRow(uint64_t k) const {
+                return ring_.data() + (k % window_) * pixels_;
+            }
+            // where suffix max row j of a block lives; odd blocks store
+            // their rows mirrored so one buffer serves reader and writer
+            size_t suffixPos(uint64_t block, int j) const {
+                return size_t(block & 1 ? block_ - 1 - j : j) * pixels_;
+            }
+            void pushQuantized(const uint16_t* q, Clock::time_point t);
+
+            int      width_, height_, window_, block_, every_;
+            size_t   pixels_;
+            SimdLevel level_;
+
+            mutable std::mutex    mutex_;
+            uint64_t              pushed_{0};     // calls to push()
+            uint64_t              count_{0};      // frames taken into the window
+            std::vector<uint16_t> ring_;          // last window_ frames
+            std::vector<Clock::time_point> times_;
+            std::vector<int32_t>  sum_;
+            std::vector<double>   sumSq_;         // integers, so exact
+            std::vector<uint16_t> prefix_;        // max of the current block so far
+            std::vector<uint16_t> blockMax_;      // max of the previous block
+            std::vector<uint16_t> suffix_;        // block_ rows, see suffixPos
+            std::vector<uint16_t> scratch_;       // CV_32F input, quantized
+        };
+
+} // namespace thermal
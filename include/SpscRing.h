@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace thermal {
+
+    // Bounded lock-free single-producer / single-consumer ring.
+    // Capacity is rounded up to a power of two; one thread may push and one
+    // (other) thread may pop, both without blocking.
+    template <typename T>
+    class SpscRing {
+        public:
+            explicit SpscRing(size_t capacity) {
+                size_t n = 2;
+                while (n < capacity) n <<= 1;
+                slots_.resize(n);
+                mask_ = n - 1;
+            }
+
+            SpscRing(const SpscRing&) = delete;
+            SpscRing& operator=(const SpscRing&) = delete;
+
+            // producer side; false when full (item is left untouched)
+            bool push(T& item) {
+                size_t head = head_.load(std::memory_order_relaxed);
+                if (head - tail_.load(std::memory_order_acquire) > mask_)
+                    return false;
+                slots_[head & mask_] = std::move(item);
+                head_.store(head + 1, std::memory_order_release);
+                return true;
+            }
+
+            // consumer side; false when empty
+            bool pop(T& item) {
+                size_t tail = tail_.load(std::memory_order_relaxed);
+                if (tail == head_.load(std::memory_order_acquire))
+                    return false;
+                item = std::move(slots_[tail & mask_]);
+                tail_.store(tail + 1, std::memory_order_release);
+                return true;
+            }
+
+            // approximate when called from a third thread
+            size_t size() const {
+                return head_.load(std::memory_order_acquire)
+                     - tail_.load(std::memory_order_acquire);
+            }
+
+            size_t capacity() const { return mask_ + 1; }
+
+        private:
+            std::vector<T> slots_;
+            size_t         mask_;
+            // producer and consumer indices on separate cache lines
+            alignas(64) std::atomic<size_t> head_{0};
+            alignas(64) std::atomic<size_t> tail_{0};
+        };
+
+} // namespace thermal
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Frame.h"
+#include "FramePacer.h"
+#include "FramePool.h"
+#include "FrameSource.h"
+#include "SpscRing.h"
+
+namespace thermal {
+
+    struct PipelineStats {
+        uint64_t acquired;      // frames read from the source
+        uint64_t delivered;     // frames handed to the callback
+        uint64_t dropped;       // frames discarded because the workers were full
+        uint64_t readErrors;    // reads that gave up after retries
+        size_t   queueDepth;    // raw frames waiting for a worker right now
+        size_t   maxQueueDepth; // high-water mark of queueDepth
+    };
+
+    // Three-stage stream:
+    //   acquisition – one thread that only drains the source into per-worker
+    //                 SPSC rings of raw frames, never waiting on the others;
+    //   workers     – N threads preparing the Frames (conversion,
+    //                 colorization, statistics);
+    //   delivery    – one thread invoking the callback in acquisition order.
+    // Raw frames are dealt to the workers round-robin, so delivery restores
+    // the order just by visiting the workers' output rings in the same order.
+    // When the next worker's ring is full the frame is dropped.
+    class StreamPipeline {
+        public:
+            // wraps a raw readout into a Frame (acquisition thread)
+            using MakeFn    = std::function<Frame(cv::Mat raw, const FrameInfo&)>;
+            // forces whatever lazy parts the consumer will want (workers)
+            using PrepareFn = std::function<void(const Frame&)>;
+            using DeliverFn = std::function<void(const Frame&)>;
+
+            struct Config {
+                bool        applyAgc     = true;
+                int         workers      = 2;
+                size_t      ringCapacity = 8;
+                // paces the acquisition thread; nullptr reads back to back
+                FramePacer* pacer        = nullptr;
+                // retires frames before each read when they carry a
+                // temperature map from the source
+                FrameTracker* tracker    = nullptr;
+                // held from the retire to the track of each frame when
+                // others read the source too
+                std::mutex*   readMutex  = nullptr;
+                // core the acquisition thread is pinned to, -1 = unpinned
+                int         cpu          = -1;
+                // read times, retries and drops go here when set
+                CameraMetrics* metrics   = nullptr;
+                // called on the delivery thread once the source gave up and
+                // everything acquired was delivered (not after stop())
+                std::function<void()> onSourceDone;
+            };
+
+            StreamPipeline(std::shared_ptr<FrameSource> source,
+                           FramePool* pool,
+                           MakeFn make,
+                           PrepareFn prepare,
+                           DeliverFn deliver,
+                           const Config& cfg);
+            ~StreamPipeline();
+
+            void start();
+            void stop();
+            // false once stopped, or after the source gave up and everything
+            // already acquired has been delivered
+            bool running() const { return running_ && !finished_; }
+
+            PipelineStats stats() const;
+
+        private:
+            struct Item {
+                Frame frame;
+            };
+            struct Worker {
+                explicit Worker(size_t cap) : in(cap), out(cap) {}
+                SpscRing<Item> in;   // acquisition -> worker
+                SpscRing<Item> out;  // worker -> delivery
+                std::thread    thread;
+            };
+
+            void acquireLoop();
+            void workerLoop(Worker& w);
+            void deliverLoop();
+
+            std::shared_ptr<FrameSource> source_;
+            FramePool*  pool_;
+            MakeFn      make_;
+            PrepareFn   prepare_;
+            DeliverFn   deliver_;
+            Config      cfg_;
+
+            std::vector<std::unique_ptr<Worker>> workers_;
+            std::thread acquireThread_;
+            std::thread deliverThread_;
+
+            std::atomic<bool> running_{false};
+            std::atomic<bool> sourceDone_{false};
+            std::atomic<int>  workersDone_{0};
+            std::atomic<bool> finished_{false};
+
+            std::atomic<uint64_t> acquired_{0};
+            std::atomic<uint64_t> delivered_{0};
+            std::atomic<uint64_t> dropped_{0};
+            std::atomic<uint64_t> readErrors_{0};
+            std::atomic<size_t>   maxQueueDepth_{0};
+        };
+
+} // namespace thermal
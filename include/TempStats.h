@@ -0,0 +1,41 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstdint>
+
+namespace thermal {
+
+    struct TempStats {
+        float minTemp;      // in °C
+        float maxTemp;      // in °C
+        cv::Point minLoc;   // pixel coordinates (first occurrence)
+        cv::Point maxLoc;
+        float mean;         // in °C
+        float stddev;       // in °C (population)
+        // nearest-rank percentiles at 0.01 °C resolution
+        float p5, p50, p95, p99;
+    };
+
+    // Instruction set used by the statistics kernel.
+    enum class SimdLevel { Auto, Scalar, SSE41, AVX2, NEON };
+
+    // Full-frame statistics of a temperature map in one pass: either the
+    // TE_A encoding (CV_16U, °C * 100 + 5000) or the TE_B one (CV_32F, °C).
+    // Min/max run vectorized; the same pass fills a 16-bit histogram that
+    // gives the percentiles (and, for CV_16U, mean and stddev exactly).
+    // NaN pixels of a CV_32F map are dead and left out of everything; a map
+    // with no finite pixel gives zeros.
+    // `level` forces a kernel, e.g. for benchmarking; unsupported levels
+    // fall back to the best one the CPU has.
+    TempStats computeTempStats(const cv::Mat& temp,
+                               SimdLevel level = SimdLevel::Auto);
+
+    // vectorized min/max of a CV_16U image (same dispatch as above)
+    void minMaxU16(const cv::Mat& img, uint16_t& mn, uint16_t& mx,
+                   SimdLevel level = SimdLevel::Auto);
+
+    // what SimdLevel::Auto resolves to on this CPU
+    SimdLevel detectSimdLevel();
+    const char* simdLevelName(SimdLevel level);
+
+} // namespace thermal
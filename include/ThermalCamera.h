@@ -2,79 +2,414 @@
 
 #include <opencv2/core.hpp>
 #include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <thread>
 #include <atomic>
+#if defined(__cpp_impl_coroutine)
+#include <coroutine>
+#endif
 #include "i3system_TE.h"
+#include "AlarmEngine.h"
+#include "BlobDetector.h"
+#include "BurstTensor.h"
+#include "CalibrationCache.h"
+#include "CaptureExecutor.h"
+#include "Colorize.h"
+#include "DeviceBackend.h"
+#include "Frame.h"
+#include "FrameFanout.h"
+#include "FramePacer.h"
+#include "FramePool.h"
+#include "FrameSource.h"
+#include "Hotplug.h"
+#include "Metrics.h"
+#include "ModelKernels.h"
+#include "Recording.h"
+#include "RoiEngine.h"
+#include "StreamPipeline.h"
 
 namespace thermal {
 
-    struct DeviceInfo {
-        unsigned int deviceNumber;   // 0–31
-        unsigned int productVersion; // I3_TE_Q1, I3_TE_V1, I3_TE_EQ1, etc.
-        unsigned int serialNumber;   // nCoreID
+    struct LinkStats {
+        bool     connected;
+        uint64_t outages;                // times the device dropped out mid-stream
+        uint64_t reconnectAttempts;      // reopen attempts, failed ones included
+        double   lastOutageMs;           // lost -> reopened, last outage
+        double   lastTimeToFirstFrameMs; // reopened -> first good frame
+        double   totalDowntimeMs;        // lost -> first good frame, all outages
     };
 
-    struct TempStats {
-        float minTemp;      // in °C
-        float maxTemp;      // in °C
-        cv::Point minLoc;   // pixel coordinates
-        cv::Point maxLoc;
+    struct StreamOptions {
+        // false: capture, convert and call back on one thread (the default)
+        // true:  acquisition thread + `workers` conversion threads + in-order
+        //        delivery thread, see StreamPipeline
+        bool   pipelined    = false;
+        int    workers      = 2;
+        size_t ringCapacity = 8;        // raw frames queued per worker
+
+        // Frame pacing on an absolute deadline schedule. targetFps 0 uses
+        // the source's own rate (TE_SETTING::frameRate on the camera),
+        // falling back to 30 fps. paced=false reads as fast as the source
+        // delivers, e.g. for throughput runs against a synthetic source.
+        bool          paced     = true;
+        double        targetFps = 0;
+        CatchUpPolicy catchUp   = CatchUpPolicy::Skip;
+
+        // fetch the temperature map with every frame, so Frame::temperature()
+        // and Frame::stats() work on streamed frames (costs a CalcTemp /
+        // CalcEntireTemp per frame that is still referenced)
+        bool          temperature = false;
+        // reduced views every frame carries (Frame::outputs()): thumbnails,
+        // full-resolution crops, grids of block max/mean temperature. The
+        // images are rendered at their own size from one pass over the raw
+        // frame, so a consumer that only reads these never pays for the
+        // full-resolution image; when set, pipelined workers prepare them
+        // instead of Frame::color()
+        OutputSet     outputs;
+        // where frames come from; nullptr means the open camera
+        std::shared_ptr<FrameSource> source;
+        // core to pin the reading thread to (see pinCurrentThread), -1 = any
+        int           cpu = -1;
+
+        // Keep the stream alive across an unplug: when the camera stops
+        // delivering (or a TE_REMOVAL arrives for it) the stream waits for
+        // the device to come back, reopening it with exponential backoff,
+        // and carries on; consumers stay subscribed and simply see a gap
+        // in FrameInfo::sequence. Only applies to the camera itself. While
+        // it is away, captures fail at once instead of waiting for it.
+        bool          reconnect = false;
+        // called on the stream thread with the first frame after a recovery
+        std::function<void(const LinkStats&)> onReconnect;
+    };
+
+
+    // how waitUntilReady() probes a freshly opened camera
+    struct ReadyProbe {
+        // between failed reads: firstDelay, doubling up to maxDelay
+        std::chrono::milliseconds firstDelay{5};
+        std::chrono::milliseconds maxDelay{200};
+        // not ready after this long: give up
+        std::chrono::milliseconds timeout{10000};
+        bool                      applyAgc = true;
+    };
+
+    struct ReadyResult {
+        bool   ready;       // a valid frame came in
+        int    probes;      // reads made, the good one included
+        int    lastCode;    // RecvImage code of the last read
+        double waitMs;      // first read -> the valid frame, or giving up
     };
 
 
     class ThermalCamera {
         public:
             // now matches hotplug_callback_func: void(*)(i3::TE_STATE)
-            using HotplugFn = std::function<void(i3::TE_STATE)>;
+            using HotplugFn = HotplugDispatcher::Handler;
+            using FrameFn   = std::function<void(const cv::Mat&, const FrameInfo&)>;
+            using FrameCb   = std::function<void(const Frame&)>;
         
             ThermalCamera();
             ~ThermalCamera();
         
             // — Static device‐level operations — 
             static std::vector<DeviceInfo> scanDevices();  
+            // process-wide listener for every device (replaces the previous
+            // one); open cameras also get their own events, see onHotplug
             static void setHotplugCallback(HotplugFn cb);
+            // feed a synthetic TE_ARRIVAL / TE_REMOVAL through the same path
+            static void injectHotplug(i3::TE_STATE state);
         
             // — Connection management — 
-            // model: 1=Q1, 2=V1, 3=Engine (EQ1/EV1/EQ2/EV2)
+            // model: 1=Q1, 2=V1, 3=Engine (EQ1/EV1/EQ2/EV2), 4=Q2
+            // A device plugged into SimulatedBus at deviceNumber is opened
+            // in place of real hardware. The bus is scanned for the
+            // camera's serial only once something needs it: a calibration
+            // cache, a reconnecting stream, a recording or metrics label.
             bool open(int model, unsigned int deviceNumber);
+            // the same for a device a scan already found, serial included
+            bool open(int model, const DeviceInfo& dev);
+            // the open() model for a DeviceInfo::productVersion, 0 if unsupported
+            static int modelForProduct(unsigned int productVersion);
+            // called with the events for this camera's device number only,
+            // on the SDK's hotplug thread
+            void onHotplug(HotplugFn cb);
             void close();
+            // Reads until the camera delivers a valid frame, backing off
+            // between failed reads (see ReadyProbe) instead of readFrame's
+            // fixed 100 ms, so a sensor that warms up quickly is ready
+            // quickly. The frames read are dropped.
+            ReadyResult waitUntilReady(const ReadyProbe& probe = ReadyProbe());
         
             // — Single‐frame grab — 
             // applyAgc=true uses hardware AGC if available
             cv::Mat captureImage(bool applyAgc = true);
+            // same, but fills `out` (reused in place when it already has the
+            // right size/type); returns false if no frame could be read
+            bool captureInto(cv::Mat& out, bool applyAgc = true);
+            // one readout with everything derived from it: image, temperature
+            // map and stats of the same frame; empty Frame on failure
+            Frame captureFrame(bool applyAgc = true);
+
+            // — Asynchronous capture — 
+            // The same captures without blocking the caller. They run on
+            // `executor` (CaptureExecutor::shared() if null), one at a time
+            // per camera in the order asked for: the read is scheduled for
+            // when the camera is due to have a frame and warm-up retries
+            // wait on the executor's timer, so a few threads serve many
+            // cameras. close() waits for the captures still pending (so
+            // don't call it from a completion). They, the synchronous
+            // captures and a stream from the device take turns at it, one
+            // readout each; a capture during a stream gets a frame of its
+            // own, which the stream skips.
+            using CaptureFn = std::function<void(const Frame&)>;
+            // `done` gets the Frame, empty on failure, on an executor thread
+            void captureFrameAsync(CaptureFn done, bool applyAgc = true,
+                                   CaptureExecutor* executor = nullptr);
+            std::future<cv::Mat>   captureImageAsync(bool applyAgc = true,
+                                                     CaptureExecutor* executor = nullptr);
+            std::future<TempStats> getTemperatureStatsAsync(bool applyAgc = true,
+                                                            CaptureExecutor* executor = nullptr);
+#if defined(__cpp_impl_coroutine)
+            // `Frame f = co_await cam.captureFrameAwait();` in C++20 code:
+            // suspends until the frame is in and resumes on the executor
+            auto captureFrameAwait(bool applyAgc = true,
+                                   CaptureExecutor* executor = nullptr) {
+                struct Awaiter {
+                    ThermalCamera*   cam;
+                    bool             applyAgc;
+                    CaptureExecutor* executor;
+                    Frame            frame;
+
+                    bool await_ready() const noexcept { return false; }
+                    void await_suspend(std::coroutine_handle<> h) {
+                        cam->captureFrameAsync([this, h](const Frame& f) {
+                            frame = f;
+                            h.resume();
+                        }, applyAgc, executor);
+                    }
+                    Frame await_resume() { return std::move(frame); }
+                };
+                return Awaiter{this, applyAgc, executor, Frame()};
+            }
+#endif
+
+            // — Burst capture — 
+            // n consecutive readouts straight into one tensor (see
+            // BurstTensor): each frame is read, or its temperature map
+            // fetched, into its own slot, converted there only if the
+            // tensor's type differs from the camera's, and normalized in
+            // place. Nothing is allocated per frame. false if a read failed
+            // (the frames before it are in place) or the layout is invalid.
+            bool captureBurstInto(BurstTensor& out, int n,
+                                  const BurstLayout& layout = BurstLayout());
+            // same, into a new tensor; empty on failure
+            BurstTensor captureBurst(int n, const BurstLayout& layout = BurstLayout());
         
             // — Continuous video stream — 
             void startStream(std::function<void(const cv::Mat&)> frameCb,
-                             bool applyAgc = true);
+                             bool applyAgc = true,
+                             const StreamOptions& opts = StreamOptions());
+            // same, with sequence number / timestamp / drop count per frame
+            void startStream(FrameFn frameCb,
+                             bool applyAgc = true,
+                             const StreamOptions& opts = StreamOptions());
+            // same, delivering the whole Frame
+            void startStream(FrameCb frameCb,
+                             bool applyAgc = true,
+                             const StreamOptions& opts = StreamOptions());
+            // a stream for the subscribers only (no defaults: a lone
+            // captureless lambda would convert to bool)
+            void startStream(bool applyAgc, const StreamOptions& opts);
+            // A stream also ends by itself once its source gives up (reads
+            // fail past their retries, a replay reaches its end), pipelined
+            // or not; startStream() then works again without stopStream().
             void stopStream();
+            // queue depth / drop counters of a pipelined stream (zeros otherwise)
+            PipelineStats streamStats() const;
+            // deadline jitter and skipped slots of the running stream
+            PacerStats pacingStats() const;
+            // outages and recoveries of a reconnecting stream
+            LinkStats linkStats() const;
+
+            // — Subscribers — 
+            // Every streamed Frame also goes to each subscriber, through its
+            // own bounded queue to its own thread (see FrameFanout), so one
+            // that is slow loses frames of its own instead of holding back
+            // the stream or the others. Subscriptions outlive stopStream and
+            // may be added and removed while streaming. A queued frame is
+            // still held, so its temperature map is fetched before the next
+            // read like any other (FrameTracker).
+            int  subscribe(FrameCb cb, const SubscribeOptions& opts = SubscribeOptions());
+            bool unsubscribe(int id);
+            std::vector<SubscriberStats> subscriberStats() const { return fanout_.stats(); }
         
             // — Temperature statistics (min/max) — 
+            // shorthand for captureFrame(applyAgc).stats()
             TempStats getTemperatureStats(bool applyAgc = true);
+
+            // — Regions of interest — 
+            // spots, rectangles and polygons measured on every Frame
+            // (Frame::rois()); may be edited while streaming
+            RoiEngine& rois() { return rois_; }
+            // shorthand for captureFrame(applyAgc).rois()
+            std::vector<RoiStats> measureRois(bool applyAgc = true);
+
+            // — Hotspot detection — 
+            // connected regions above opts.thresholdC on every Frame
+            // (Frame::blobs()) from now on; may be changed while streaming.
+            // Streamed frames then carry their temperature map.
+            void setBlobDetection(const BlobOptions& opts);
+            void disableBlobDetection();
+
+            // — Threshold alarms — 
+            // rules checked on every streamed frame on the acquisition
+            // thread, before it is queued or delivered; events go to the
+            // engine's onAlarm callback. May be edited while streaming.
+            // While any rule exists every frame keeps its source attached,
+            // and each streamed frame reads its temperature map on the
+            // acquisition thread, whether or not a rule fires.
+            AlarmEngine& alarms() { return alarms_; }
         
             // — Calibration & settings — 
-            bool doCalibration();            // runs shutter calibration
+            // runs shutter calibration, and keeps it in the calibration
+            // cache if there is one
+            bool doCalibration();
+            // Where this camera's calibration is kept (nullptr: nowhere).
+            // open(), and a reconnecting stream's reopen, apply the entry
+            // for the camera's serial and model if the cache has a usable
+            // one, so no shutter cycle is needed; set it before open().
+            void setCalibrationCache(std::shared_ptr<CalibrationCache> cache);
+            // the last open or reopen applied a cached calibration
+            bool calibrationRestored() const { return calibrationRestored_; }
             void setEmissivity(float e);     // 0.01–1.0
+            // describes this camera's frames for a RecordingWriter
+            RecordingMeta recordingMeta(bool applyAgc = true,
+                                        bool withTemperature = true) const;
             void setAgc(bool enable);        // enable/disable AGC
+            // I3_COLORMAP_* id, or PALETTE_JET (the default)
+            void setColormap(int palette);
+
+            // — Frame buffer pool — 
+            // heapAllocations stays flat once streaming has reached steady state
+            FramePoolStats bufferStats() const;
+
+            // — Metrics — 
+            // Read / convert / colorize / callback latency histograms,
+            // failed reads by return code, and dropped frames. Off until
+            // enabled; a reconnecting stream times a read that waits out an
+            // outage as one long read.
+            void enableMetrics(bool on = true);
+            MetricsSnapshot metrics() const;
+            void resetMetrics();
+            // serve them (enabling them) in Prometheus text format at
+            // http://127.0.0.1:<port>/metrics; false if it can't listen
+            bool serveMetrics(int port);
+            void stopMetricsServer();
         
         private:
+            class DeviceSource;
+            class ReconnectingSource;
+            struct Link;
+            struct CaptureOp;
+            struct CaptureQueue;
+
+            // dev_ is only opened, closed and used under readMutex_
+            bool openHandles(int model, unsigned int deviceNumber);
+            void closeHandles();
+            // open and not lost to an unplug; caller holds readMutex_
+            bool deviceUp() const;
+            // the open camera's serial, scanned for on first use if open()
+            // wasn't given it; 0 if the scan doesn't find the camera
+            unsigned int serialNumber() const;
+            // the cached calibration onto the freshly opened device
+            void restoreCalibration(int model, unsigned int serial);
+            void subscribeHotplug();
+            // stream thread: wait for the device and reopen it; false if the
+            // stream was stopped meanwhile
+            bool reconnect();
+            void linkLost();
+            void linkFrame();
+
+            // one step of an asynchronous capture, on its executor
+            void stepCapture(const std::shared_ptr<CaptureOp>& op);
+            void finishCapture(const std::shared_ptr<CaptureOp>& op, const Frame& f);
+            void waitForCaptures();
+
             // internal thread func
-            void streamLoop(bool applyAgc);
+            void streamLoop(std::shared_ptr<FrameSource> src, bool applyAgc,
+                            bool withTemperature,
+                            std::shared_ptr<const OutputSet> outputs,
+                            FrameTracker* tracker, int cpu);
+
+            // raw frame -> the image captureImage hands out
+            // passRaw16: TE_B with AGC, where the 16-bit frame is the image
+            static void render(FramePool& pool, const cv::Mat& raw, cv::Mat& out,
+                               bool applyAgc, bool passRaw16, int palette,
+                               const ModelKernels& kernels, CameraMetrics* metrics);
+            // to the subscribers and the stream callback, timed and counted
+            void deliver(const Frame& f);
+            // runs the alarm rules on the frame's temperature map
+            void checkAlarms(const Frame& f);
+            // caller holds readMutex_ if `src` is the camera
+            Frame makeFrame(const std::shared_ptr<FrameSource>& src, cv::Mat raw,
+                            const FrameInfo& info, bool applyAgc,
+                            bool withTemperature,
+                            std::shared_ptr<const OutputSet> outputs = nullptr);
         
-            // low‐level handles (only one is non‐null at a time)
-            i3::TE_A* teA_{nullptr};
-            i3::TE_B* teB_{nullptr};
+            // the open device (SDK or simulated), null when closed
+            std::unique_ptr<DeviceBackend> dev_;
+            // its model's kernels, picked when it opens
+            std::atomic<const ModelKernels*> kernels_{&genericKernels()};
 
             bool agc_{false}; // AGC enabled/disabled
+            float emissivity_{std::numeric_limits<float>::quiet_NaN()}; // last set
+            // swapped atomically: a reconnect reads it on the stream thread
+            std::shared_ptr<CalibrationCache> calibrationCache_;
+            std::atomic<bool> calibrationRestored_{false};
+            std::atomic<int> palette_{PALETTE_JET};
+            RoiEngine        rois_;
+            // null while off; swapped atomically, frames keep their copy
+            std::shared_ptr<const BlobOptions> blobOptions_;
+            AlarmEngine      alarms_;
+
+            // recycles every per-frame buffer; outlives us if Mats are still held
+            FramePool*             pool_;
+            // FrameSource view of dev_, stable across reopens
+            std::shared_ptr<FrameSource> device_;
+            // frames read from device_ / from a StreamOptions::source
+            FrameTracker           deviceTracker_;
+            FrameTracker           sourceTracker_;
+            // one reader of device_ at a time, from retiring the last frame
+            // to tracking the new one: streams, captures, bursts and probes.
+            // Also held wherever dev_ is looked at, since a reconnecting
+            // stream replaces it
+            mutable std::mutex     readMutex_;
+
+            // shared with the render step of frames that may outlive us
+            std::shared_ptr<CameraMetrics> metrics_;
+            std::unique_ptr<MetricsServer> metricsServer_;
 
             // streaming state
             std::thread            streamThread_;
             std::atomic<bool>      streaming_{false};
-            std::function<void(const cv::Mat&)> frameCallback_;
+            FrameCb                frameCallback_;
+            FrameFanout            fanout_;
+            FramePacer             pacer_;
+            bool                   paced_{false};
+            std::unique_ptr<StreamPipeline> pipeline_;
+
+            // asynchronous captures waiting for the device or running
+            std::unique_ptr<CaptureQueue> captures_;
 
-            // hotplug callback
-            static HotplugFn       hotplugCallback_;
-            static void            hotplugProxy(i3::TE_STATE state);
+            // hotplug: what we opened and how it's doing; shared with the
+            // handler, which may run after we are gone
+            std::shared_ptr<Link>  link_;
+            int                    hotplugToken_{-1};
+            static int             globalHotplugToken_;
         };
 
     } // namespace thermal
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace thermal {
+
+    struct CodecOptions {
+        // rows per tile; tiles are coded independently, in parallel
+        int  tileRows         = 32;
+        // predict from the previous frame where that is cheaper
+        bool temporal         = true;
+        // every n-th frame is coded without the previous one, so decoding
+        // can start (or recover) there; 0 = only the first frame
+        int  keyframeInterval = 30;
+        // false keeps the whole frame on the calling thread
+        bool parallel         = true;
+    };
+
+    // Lossless codec for the CV_16U frames RecvImage produces.
+    //
+    // Each tile of rows picks the spatial or the temporal signal (the frame
+    // itself, or its difference to the previous frame) by which predicts
+    // better. The signal goes through the LOCO-I median edge predictor,
+    // and the residuals are Golomb-Rice coded with the parameter adapted
+    // per context (local gradient activity). Smooth thermal scenes come
+    // down to a few bits per pixel.
+    //
+    // A frame is: magic "TC16", width, height, tile rows, tile count, a
+    // keyframe flag, then per tile its mode and byte size, then the tiles.
+    class ThermalEncoder {
+        public:
+            explicit ThermalEncoder(const CodecOptions& opts = CodecOptions());
+
+            // Compress one frame into `out` (replaced). Returns its size,
+            // 0 if `raw16` isn't a CV_16U frame.
+            size_t encode(const cv::Mat& raw16, std::vector<uint8_t>& out);
+            // the next frame is a keyframe
+            void reset();
+
+            const CodecOptions& options() const { return opts_; }
+
+        private:
+            CodecOptions opts_;
+            cv::Mat      prev_;
+            uint64_t     frames_{0};
+            std::vector<std::vector<uint8_t>> tiles_;   // per-tile scratch
+        };
+
+    // Counterpart of ThermalEncoder; frames must arrive in the order they
+    // were encoded, starting at a keyframe.
+    class ThermalDecoder {
+        public:
+            // parallel = false keeps the whole frame on the calling thread
+            explicit ThermalDecoder(bool parallel = true) : parallel_(parallel) {}
+
+            // false (and a warning) on corrupt data, or a frame that needs
+            // a previous frame this decoder doesn't have
+            bool decode(const uint8_t* data, size_t size, cv::Mat& raw16);
+            bool decode(const std::vector<uint8_t>& data, cv::Mat& raw16) {
+                return decode(data.data(), data.size(), raw16);
+            }
+            void reset() { prev_.release(); }
+
+            static bool isKeyframe(const uint8_t* data, size_t size);
+
+        private:
+            bool    parallel_;
+            cv::Mat prev_;
+        };
+
+} // namespace thermal
@@ -0,0 +1,14 @@
+#pragma once
+
+namespace thermal {
+
+    // Binds the calling thread to one core (pthread_setaffinity_np), so a
+    // busy acquisition thread keeps its caches and doesn't get migrated
+    // next to another camera's. `cpu` wraps around the online core count;
+    // returns false where affinity isn't supported or the call fails.
+    bool pinCurrentThread(int cpu);
+
+    // online cores on this machine (at least 1)
+    int onlineCpuCount();
+
+} // namespace thermal
@@ -24,6 +24,9 @@ int main(){
     const int ENGINE_MODEL = 3;  
     auto devNum = devices[0].deviceNumber;
     thermal::ThermalCamera cam;
+    // calibrations are kept in the working directory, so the next run
+    // started from the same place begins with this one's
+    cam.setCalibrationCache(std::make_shared<thermal::CalibrationCache>("."));
     if (!cam.open(ENGINE_MODEL, devNum)) {
         std::cerr << "Failed to open camera #" << devNum << "\n";
         return -1;
@@ -31,33 +34,34 @@ int main(){
     std::cout << "Camera opened successfully.\n";
 
 
-    // 3) Capture and show a single frame (with hardware AGC)
+    // 3) Capture a single frame (with hardware AGC) and show it
+    //    together with its min/max temperatures — one readout for both
     {
-      auto img = cam.captureImage(true);
-      if (img.empty()) {
-          std::cerr << "captureImage() returned empty frame\n";
+      auto frame = cam.captureFrame(true);
+      if (frame.empty()) {
+          std::cerr << "captureFrame() returned empty frame\n";
       } else {
+        const auto &img = frame.color();
         //   cv::imshow("Single Frame", img);
         //   cv::waitKey(0);  // press any key to continue
         std::cout << "Captured single frame of size: " << img.size() << "\n";
             cv::imwrite("thermal_image.png", img);
             std::cout << "Saved image to thermal_image.png\n";
-      }
-    }
-    
 
-    // 4) Print min/max temperature stats
-    {
-      auto stats = cam.getTemperatureStats(true);
-      std::cout << "Min Temp: " << stats.minTemp << " °C at "
-                << "(" << stats.minLoc.x << "," << stats.minLoc.y << ")\n";
-      std::cout << "Max Temp: " << stats.maxTemp << " °C at "
-                << "(" << stats.maxLoc.x << "," << stats.maxLoc.y << ")\n";
+        // 4) Print min/max temperature stats of that same frame
+        const auto &stats = frame.stats();
+        std::cout << "Min Temp: " << stats.minTemp << " °C at "
+                  << "(" << stats.minLoc.x << "," << stats.minLoc.y << ")\n";
+        std::cout << "Max Temp: " << stats.maxTemp << " °C at "
+                  << "(" << stats.maxLoc.x << "," << stats.maxLoc.y << ")\n";
+      }
     }
 
 
-    // 5) Perform shutter calibration
-    if (cam.doCalibration()) {
+    // 5) Perform shutter calibration, unless open() restored a cached one
+    if (cam.calibrationRestored()) {
+      std::cout << "Shutter calibration restored from cache.\n";
+    } else if (cam.doCalibration()) {
       std::cout << "Shutter calibration succeeded.\n";
     } else {
         std::cout << "Shutter calibration failed or not supported.\n";
@@ -69,18 +73,25 @@ int main(){
     std::cout << "Emissivity set to 0.98\n";
 
 
-    // 7) Start live streaming for 10 seconds
+    // 7) Start live streaming for 10 seconds; the window only ever shows
+    //    the newest frame, so a slow redraw can't hold the stream back
     std::cout << "Starting live stream for 10 seconds...\n";
-    cam.startStream(
-        [](const cv::Mat &frame) {
-            if (frame.empty()) return;
-            cv::imshow("Live Stream", frame);
+    thermal::SubscribeOptions view;
+    view.policy = thermal::Backpressure::LatestOnly;
+    view.name   = "display";
+    int viewer = cam.subscribe(
+        [](const thermal::Frame &frame) {
+            const cv::Mat &img = frame.color();
+            if (img.empty()) return;
+            cv::imshow("Live Stream", img);
             cv::waitKey(1);
         },
-        /*applyAgc=*/true
+        view
     );
+    cam.startStream(/*applyAgc=*/true, thermal::StreamOptions());
     std::this_thread::sleep_for(std::chrono::seconds(10));
     cam.stopStream();
+    cam.unsubscribe(viewer);
     std::cout << "Live stream stopped.\n";
 
     
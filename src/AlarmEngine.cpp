@@ -0,0 +1,323 @@
+#include "AlarmEngine.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define THERMAL_X86 1
+#endif
+
+namespace thermal {
+
+    namespace {
+
+        // Whether any pixel of a row is past a limit. On CV_16U the limit
+        // is inclusive (v >= c for Above, v <= c for Below), on CV_32F
+        // strict; all of them return at the first group holding a hit.
+        struct ScanKernels {
+            bool (*aboveU16)(const uint16_t* p, size_t n, uint16_t c);
+            bool (*belowU16)(const uint16_t* p, size_t n, uint16_t c);
+            bool (*aboveF32)(const float* p, size_t n, float c);
+            bool (*belowF32)(const float* p, size_t n, float c);
+        };
+
+        // — Scalar —
+        template <bool Above>
+        bool anyU16Scalar(const uint16_t* p, size_t n, uint16_t c) {
+            for (size_t i = 0; i < n; ++i)
+                if (Above ? p[i] >= c : p[i] <= c) return true;
+            return false;
+        }
+
+        template <bool Above>
+        bool anyF32Scalar(const float* p, size_t n, float c) {
+            for (size_t i = 0; i < n; ++i)
+                if (Above ? p[i] > c : p[i] < c) return true;
+            return false;
+        }
+
+#ifdef THERMAL_X86
+        // — SSE4.1 —
+        // four vectors per test, so the branch is taken rarely
+        template <bool Above>
+        __attribute__((target("sse4.1")))
+        bool anyU16Sse41(const uint16_t* p, size_t n, uint16_t c) {
+            const __m128i vc = _mm_set1_epi16(short(c));
+            size_t i = 0;
+            for (; i + 32 <= n; i += 32) {
+                __m128i hit = _mm_setzero_si128();
+                for (int k = 0; k < 4; ++k) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 8 * k));
+                    // v >= c <=> max(v, c) == v; v <= c <=> min(v, c) == v
+                    __m128i e = Above ? _mm_max_epu16(v, vc) : _mm_min_epu16(v, vc);
+                    hit = _mm_or_si128(hit, _mm_cmpeq_epi16(e, v));
+                }
+                if (!_mm_testz_si128(hit, hit)) return true;
+            }
+            return anyU16Scalar<Above>(p + i, n - i, c);
+        }
+
+        template <bool Above>
+        __attribute__((target("sse4.1")))
+        bool anyF32Sse41(const float* p, size_t n, float c) {
+            const __m128 vc = _mm_set1_ps(c);
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                __m128 hit = _mm_setzero_ps();
+                for (int k = 0; k < 4; ++k) {
+                    __m128 v = _mm_loadu_ps(p + i + 4 * k);
+                    hit = _mm_or_ps(hit, Above ? _mm_cmpgt_ps(v, vc) : _mm_cmplt_ps(v, vc));
+                }
+                if (_mm_movemask_ps(hit)) return true;
+            }
+            return anyF32Scalar<Above>(p + i, n - i, c);
+        }
+
+        // — AVX2 —
+        template <bool Above>
+        __attribute__((target("avx2")))
+        bool anyU16Avx2(const uint16_t* p, size_t n, uint16_t c) {
+            const __m256i vc = _mm256_set1_epi16(short(c));
+            size_t i = 0;
+            for (; i + 64 <= n; i += 64) {
+                __m256i hit = _mm256_setzero_si256();
+                for (int k = 0; k < 4; ++k) {
+                    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 16 * k));
+                    __m256i e = Above ? _mm256_max_epu16(v, vc) : _mm256_min_epu16(v, vc);
+                    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi16(e, v));
+                }
+                if (!_mm256_testz_si256(hit, hit)) return true;
+            }
+            return anyU16Sse41<Above>(p + i, n - i, c);
+        }
+
+        template <bool Above>
+        __attribute__((target("avx2")))
+        bool anyF32Avx2(const float* p, size_t n, float c) {
+            const __m256 vc = _mm256_set1_ps(c);
+            size_t i = 0;
+            for (; i + 32 <= n; i += 32) {
+                __m256 hit = _mm256_setzero_ps();
+                for (int k = 0; k < 4; ++k) {
+                    __m256 v = _mm256_loadu_ps(p + i + 8 * k);
+                    hit = _mm256_or_ps(hit, _mm256_cmp_ps(v, vc, Above ? _CMP_GT_OQ : _CMP_LT_OQ));
+                }
+                if (_mm256_movemask_ps(hit)) return true;
+            }
+            return anyF32Sse41<Above>(p + i, n - i, c);
+        }
+#endif // THERMAL_X86
+
+        // what `level` runs as on this CPU; resolved once per engine, as
+        // evaluate() picks kernels for every rule
+        SimdLevel resolve(SimdLevel level) {
+            const SimdLevel best = detectSimdLevel();
+            if (level == SimdLevel::Auto ||
+                (level == SimdLevel::AVX2 && best != SimdLevel::AVX2) ||
+                (level == SimdLevel::SSE41 && best != SimdLevel::AVX2 &&
+                 best != SimdLevel::SSE41))
+                return best;
+            return level;
+        }
+
+        // NEON builds use the scalar loops
+        ScanKernels kernelsFor(SimdLevel level) {
+            switch (level) {
+#ifdef THERMAL_X86
+                case SimdLevel::AVX2:
+                    return {anyU16Avx2<true>, anyU16Avx2<false>,
+                            anyF32Avx2<true>, anyF32Avx2<false>};
+                case SimdLevel::SSE41:
+                    return {anyU16Sse41<true>, anyU16Sse41<false>,
+                            anyF32Sse41<true>, anyF32Sse41<false>};
+#endif
+                default:
+                    return {anyU16Scalar<true>, anyU16Scalar<false>,
+                            anyF32Scalar<true>, anyF32Scalar<false>};
+            }
+        }
+
+        // a rule's threshold in the CV_16U encoding: v > c <=> v >= the
+        // first, v < c <=> v <= the second; 65536 and -1 mean no pixel can
+        int aboveLimitU16(float c) {
+            double v = std::floor(double(c) * 100.0 + 5000.0) + 1.0;
+            return int(std::min(65536.0, std::max(0.0, v)));
+        }
+
+        int belowLimitU16(float c) {
+            double v = std::ceil(double(c) * 100.0 + 5000.0) - 1.0;
+            return int(std::min(65535.0, std::max(-1.0, v)));
+        }
+
+        inline float toCelsius(const cv::Mat& temp, double v) {
+            return temp.type() == CV_16U ? float((v - 5000.0) / 100.0) : float(v);
+        }
+
+        // row by row, unless the region is one contiguous block
+        template <typename T, typename RowFn>
+        bool anyRow(const cv::Mat& m, RowFn row) {
+            const int rows = m.isContinuous() ? 1 : m.rows;
+            const size_t len = m.isContinuous() ? m.total() : size_t(m.cols);
+            for (int y = 0; y < rows; ++y)
+                if (row(m.ptr<T>(y), len)) return true;
+            return false;
+        }
+    }
+
+    AlarmEngine::AlarmEngine(SimdLevel level) : level_(resolve(level)) {}
+
+    int AlarmEngine::addRule(const AlarmRule& rule) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        Rule r;
+        r.id  = nextId_++;
+        r.def = rule;
+        rules_.push_back(std::move(r));
+        count_.store(int(rules_.size()), std::memory_order_relaxed);
+        return rules_.back().id;
+    }
+
+    bool AlarmEngine::remove(int id) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = std::find_if(rules_.begin(), rules_.end(),
+                               [id](const Rule& r) { return r.id == id; });
+        if (it == rules_.end()) return false;
+        rules_.erase(it);
+        count_.store(int(rules_.size()), std::memory_order_relaxed);
+        return true;
+    }
+
+    void AlarmEngine::clear() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        rules_.clear();
+        count_.store(0, std::memory_order_relaxed);
+    }
+
+    bool AlarmEngine::active(int id) const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        for (const Rule& r : rules_)
+            if (r.id == id) return r.raised;
+        return false;
+    }
+
+    void AlarmEngine::onAlarm(AlarmFn fn) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        callback_ = fn ? std::make_shared<const AlarmFn>(std::move(fn)) : nullptr;
+    }
+
+    void AlarmEngine::reset() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        for (Rule& r : rules_) {
+            r.streak = 0;
+            r.raised = false;
+            r.history.clear();
+        }
+    }
+
+    bool AlarmEngine::check(Rule& r, const cv::Mat& region, const FrameInfo& info,
+                            float& value) const {
+        const ScanKernels k = kernelsFor(level_);
+        const bool u16 = region.type() == CV_16U;
+        const float c = r.def.thresholdC;
+        switch (r.def.condition) {
+            case AlarmCondition::Above: {
+                if (!u16)
+                    return anyRow<float>(region, [&](const float* p, size_t n) {
+                        return k.aboveF32(p, n, c);
+                    });
+                const int lim = aboveLimitU16(c);
+                if (lim > 65535) return false;
+                return anyRow<uint16_t>(region, [&](const uint16_t* p, size_t n) {
+                    return k.aboveU16(p, n, uint16_t(lim));
+                });
+            }
+            case AlarmCondition::Below: {
+                if (!u16)
+                    return anyRow<float>(region, [&](const float* p, size_t n) {
+                        return k.belowF32(p, n, c);
+                    });
+                const int lim = belowLimitU16(c);
+                if (lim < 0) return false;
+                return anyRow<uint16_t>(region, [&](const uint16_t* p, size_t n) {
+                    return k.belowU16(p, n, uint16_t(lim));
+                });
+            }
+            case AlarmCondition::Rise: {
+                float mx;
+                if (u16) {
+                    uint16_t lo, hi;
+                    minMaxU16(region, lo, hi, level_);
+                    mx = toCelsius(region, hi);
+                } else {
+                    double hi;
+                    cv::minMaxLoc(region, nullptr, &hi);
+                    mx = float(hi);
+                }
+                // sliding minimum of the maxima over the last `seconds`
+                const auto since = info.timestamp -
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double>(r.def.seconds));
+                auto& h = r.history;
+                while (!h.empty() && h.front().t < since) h.pop_front();
+                while (!h.empty() && h.back().value >= mx) h.pop_back();
+                h.push_back({info.timestamp, mx});
+                value = mx - h.front().value;
+                return value > c;
+            }
+        }
+        return false;
+    }
+
+    void AlarmEngine::fill(const Rule& r, const cv::Mat& region, cv::Point origin,
+                           bool raised, float value, const FrameInfo& info) {
+        double lo, hi;
+        cv::Point loLoc, hiLoc;
+        cv::minMaxLoc(region, &lo, &hi, &loLoc, &hiLoc);
+        AlarmEvent e;
+        e.ruleId = r.id;
+        e.raised = raised;
+        e.info   = info;
+        if (r.def.condition == AlarmCondition::Below) {
+            e.value = toCelsius(region, lo);
+            e.where = origin + loLoc;
+        } else {
+            e.value = r.def.condition == AlarmCondition::Rise ? value
+                                                              : toCelsius(region, hi);
+            e.where = origin + hiLoc;
+        }
+        events_.push_back(e);
+    }
+
+    int AlarmEngine::evaluate(const cv::Mat& temp, const FrameInfo& info) {
+        if (empty() || temp.empty() ||
+            (temp.type() != CV_16U && temp.type() != CV_32F))
+            return 0;
+        std::shared_ptr<const AlarmFn> cb;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            events_.clear();
+            const cv::Rect frame(0, 0, temp.cols, temp.rows);
+            for (Rule& r : rules_) {
+                const cv::Rect box = r.def.region.empty() ? frame : r.def.region & frame;
+                if (box.empty()) continue;
+                const cv::Mat region = temp(box);
+                float value = 0;
+                const bool holds = check(r, region, info, value);
+                const int need = std::max(1, r.def.frames);
+                r.streak = holds ? std::min(r.streak + 1, need) : 0;
+                if (!r.raised && r.streak == need) {
+                    r.raised = true;
+                    fill(r, region, box.tl(), true, value, info);
+                } else if (r.raised && !holds) {
+                    r.raised = false;
+                    fill(r, region, box.tl(), false, value, info);
+                }
+            }
+            cb = callback_;
+        }
+        // outside the lock, so the callback may edit the rules
+        if (cb)
+            for (const AlarmEvent& e : events_) (*cb)(e);
+        return int(events_.size());
+    }
+
+} // namespace thermal
@@ -0,0 +1,221 @@
+#include "BlobDetector.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <type_traits>
+
+namespace thermal {
+
+    namespace {
+        // thresholdC in the map's own units; v > it <=> above thresholdC
+        int thresholdU16(float c) {
+            double v = std::floor(double(c) * 100.0 + 5000.0);
+            return int(std::min(65535.0, std::max(-1.0, v)));
+        }
+
+        inline float toCelsius(const cv::Mat& temp, double v) {
+            return temp.type() == CV_16U ? float((v - 5000.0) / 100.0) : float(v);
+        }
+    }
+
+    void BlobDetector::resize(int width, int height, int tiles) {
+        if (width != width_ || height != height_) {
+            width_  = width;
+            height_ = height;
+            parent_.assign(size_t(width) * height, 0);
+            slot_.assign(size_t(width) * height, -1);
+        }
+        if (int(tileAcc_.size()) < tiles) tileAcc_.resize(tiles);
+    }
+
+    int BlobDetector::find(int p) {
+        // path halving; every link points to a smaller index
+        while (parent_[p] != p) {
+            parent_[p] = parent_[parent_[p]];
+            p = parent_[p];
+        }
+        return p;
+    }
+
+    template <typename T>
+    void BlobDetector::labelTile(const cv::Mat& temp, T threshold, int tile, int y0, int y1) {
+        using Pixel = typename std::conditional<std::is_same<T, float>::value,
+                                                float, uint16_t>::type;
+        const int w = width_;
+        int32_t* parent = parent_.data();
+        auto unite = [&](int i, int j) {
+            i = find(i);
+            j = find(j);
+            if (i < j) parent[j] = i;
+            else if (j < i) parent[i] = j;
+        };
+
+        // pass 1: provisional links to the neighbours already seen (the
+        // decision tree of Wu et al. for 8-connectivity); the tile's first
+        // row doesn't look up, tiles are joined in mergeTiles
+        for (int y = y0; y < y1; ++y) {
+            const Pixel* row = temp.ptr<Pixel>(y);
+            const Pixel* up  = y > y0 ? temp.ptr<Pixel>(y - 1) : nullptr;
+            const int base = y * w;
+            for (int x = 0; x < w; ++x) {
+                if (!(T(row[x]) > threshold)) continue;
+                const int p = base + x;
+                const bool a = x > 0 && T(row[x - 1]) > threshold;
+                const bool c = up && T(up[x]) > threshold;
+                if (!opts_.eightConnected) {
+                    if (a && c) { parent[p] = parent[p - 1]; unite(p - 1, p - w); }
+                    else if (a) parent[p] = parent[p - 1];
+                    else if (c) parent[p] = parent[p - w];
+                    else        parent[p] = p;
+                    continue;
+                }
+                if (c) { parent[p] = parent[p - w]; continue; }
+                const bool b = up && x > 0 && T(up[x - 1]) > threshold;
+                const bool d = up && x + 1 < w && T(up[x + 1]) > threshold;
+                if (b) {
+                    parent[p] = parent[p - w - 1];
+                    if (d) unite(p - w - 1, p - w + 1);
+                } else if (a) {
+                    parent[p] = parent[p - 1];
+                    if (d) unite(p - 1, p - w + 1);
+                } else if (d) {
+                    parent[p] = parent[p - w + 1];
+                } else {
+                    parent[p] = p;
+                }
+            }
+        }
+
+        // pass 2: flatten (parents come earlier in the scan, so theirs are
+        // final already) and accumulate per tile-local root
+        std::vector<Acc>& acc = tileAcc_[tile];
+        acc.clear();
+        for (int y = y0; y < y1; ++y) {
+            const Pixel* row = temp.ptr<Pixel>(y);
+            const int base = y * w;
+            for (int x = 0; x < w; ++x) {
+                const T v = T(row[x]);
+                if (!(v > threshold)) continue;
+                const int p = base + x;
+                const int r = parent[p] = parent[parent[p]];
+                int s = slot_[r];
+                if (s < 0) {
+                    s = slot_[r] = int(acc.size());
+                    acc.push_back({r, 0, x, y, x, y, 0, 0, 0.0, -FLT_MAX, p});
+                }
+                Acc& a = acc[s];
+                ++a.area;
+                a.x0 = std::min(a.x0, x);
+                a.x1 = std::max(a.x1, x);
+                a.y1 = y;
+                a.sumX += x;
+                a.sumY += y;
+                a.sum  += double(v);
+                if (float(v) > a.peak) { a.peak = float(v); a.peakIdx = p; }
+            }
+        }
+        for (const Acc& a : acc) slot_[a.root] = -1;
+    }
+
+    template <typename T>
+    void BlobDetector::mergeTiles(const cv::Mat& temp, T threshold, int tiles,
+                                  int tileRows) {
+        using Pixel = typename std::conditional<std::is_same<T, float>::value,
+                                                float, uint16_t>::type;
+        const int w = width_;
+        auto unite = [&](int i, int j) {
+            i = find(i);
+            j = find(j);
+            if (i < j) parent_[j] = i;
+            else if (j < i) parent_[i] = j;
+        };
+        for (int t = 1; t < tiles; ++t) {
+            const int y = t * tileRows;
+            const Pixel* row = temp.ptr<Pixel>(y);
+            const Pixel* up  = temp.ptr<Pixel>(y - 1);
+            for (int x = 0; x < w; ++x) {
+                if (!(T(row[x]) > threshold)) continue;
+                const int p = y * w + x;
+                if (T(up[x]) > threshold) unite(p, p - w);
+                if (!opts_.eightConnected) continue;
+                if (x > 0 && T(up[x - 1]) > threshold) unite(p, p - w - 1);
+                if (x + 1 < w && T(up[x + 1]) > threshold) unite(p, p - w + 1);
+            }
+        }
+
+        merged_.clear();
+        for (int t = 0; t < tiles; ++t) {
+            for (const Acc& a : tileAcc_[t]) {
+                const int g = find(a.root);
+                int s = slot_[g];
+                if (s < 0) {
+                    slot_[g] = int(merged_.size());
+                    merged_.push_back(a);
+                    merged_.back().root = g;
+                    continue;
+                }
+                Acc& m = merged_[s];
+                m.area += a.area;
+                m.x0 = std::min(m.x0, a.x0);
+                m.y0 = std::min(m.y0, a.y0);
+                m.x1 = std::max(m.x1, a.x1);
+                m.y1 = std::max(m.y1, a.y1);
+                m.sumX += a.sumX;
+                m.sumY += a.sumY;
+                m.sum  += a.sum;
+                if (a.peak > m.peak || (a.peak == m.peak && a.peakIdx < m.peakIdx)) {
+                    m.peak = a.peak;
+                    m.peakIdx = a.peakIdx;
+                }
+            }
+        }
+        for (const Acc& m : merged_) slot_[m.root] = -1;
+    }
+
+    void BlobDetector::detect(const cv::Mat& temp, std::vector<Blob>& out) {
+        out.clear();
+        if (temp.empty() || (temp.type() != CV_16U && temp.type() != CV_32F)) return;
+        const int h = temp.rows;
+        const int tileRows = std::max(1, opts_.tileRows);
+        const int tiles = (h + tileRows - 1) / tileRows;
+        resize(temp.cols, h, tiles);
+
+        auto run = [&](auto threshold) {
+            auto labelTiles = [&](const cv::Range& r) {
+                for (int t = r.start; t < r.end; ++t)
+                    labelTile(temp, threshold, t, t * tileRows,
+                              std::min(h, (t + 1) * tileRows));
+            };
+            if (opts_.parallel && tiles > 1) cv::parallel_for_(cv::Range(0, tiles), labelTiles);
+            else labelTiles(cv::Range(0, tiles));
+            mergeTiles(temp, threshold, tiles, tileRows);
+        };
+        if (temp.type() == CV_16U) run(thresholdU16(opts_.thresholdC));
+        else                       run(opts_.thresholdC);
+
+        for (const Acc& m : merged_) {
+            if (m.area < opts_.minArea) continue;
+            Blob b;
+            b.area     = m.area;
+            b.centroid = cv::Point2f(float(double(m.sumX) / m.area),
+                                     float(double(m.sumY) / m.area));
+            b.box      = cv::Rect(m.x0, m.y0, m.x1 - m.x0 + 1, m.y1 - m.y0 + 1);
+            b.peakTemp = toCelsius(temp, m.peak);
+            b.peakLoc  = cv::Point(m.peakIdx % width_, m.peakIdx / width_);
+            b.meanTemp = toCelsius(temp, m.sum / m.area);
+            out.push_back(b);
+        }
+        std::sort(out.begin(), out.end(), [](const Blob& a, const Blob& b) {
+            if (a.peakTemp != b.peakTemp) return a.peakTemp > b.peakTemp;
+            return a.peakLoc.y != b.peakLoc.y ? a.peakLoc.y < b.peakLoc.y
+                                              : a.peakLoc.x < b.peakLoc.x;
+        });
+    }
+
+    void detectBlobs(const cv::Mat& temp, const BlobOptions& opts, std::vector<Blob>& out) {
+        thread_local BlobDetector detector;
+        detector.setOptions(opts);
+        detector.detect(temp, out);
+    }
+
+} // namespace thermal
@@ -0,0 +1,61 @@
+#include "BurstTensor.h"
+#include <iostream>
+
+namespace thermal {
+
+    cv::Mat BurstTensor::frame(int i) const {
+        if (i < 0 || i >= frames() || tensor.empty()) return cv::Mat();
+        const int h = tensor.rows / frames();
+        // whole rows: the view stays contiguous
+        return tensor(cv::Rect(0, i * h, tensor.cols, h));
+    }
+
+    bool validBurstLayout(const BurstLayout& layout) {
+        if (layout.type != CV_16U && layout.type != CV_32F) {
+            std::cerr << "[ERROR] captureBurst: tensor type must be CV_16U or CV_32F\n";
+            return false;
+        }
+        if (layout.normalize != BurstNorm::None && layout.type != CV_32F) {
+            std::cerr << "[ERROR] captureBurst: normalization needs a CV_32F tensor\n";
+            return false;
+        }
+        return true;
+    }
+
+    void prepareBurst(BurstTensor& out, int n, int h, int w, int type) {
+        cv::Mat& t = out.tensor;
+        if (t.empty() || t.rows != n * h || t.cols != w || t.type() != type ||
+            !t.isContinuous())
+            t.create(n * h, w, type);
+        out.info.resize(n);
+    }
+
+    void convertBurstFrame(const cv::Mat& src, cv::Mat& dst, bool celsius) {
+        if (!celsius || src.type() == dst.type())
+            src.convertTo(dst, dst.type());
+        else if (src.type() == CV_16U)
+            src.convertTo(dst, CV_32F, 0.01, -50.0);    // TE_A map to °C
+        else
+            src.convertTo(dst, CV_16U, 100.0, 5000.0);  // °C to the TE_A encoding
+    }
+
+    void normalizeBurstFrame(cv::Mat& frame, BurstNorm norm) {
+        double scale = 1.0, offset = 0.0;
+        if (norm == BurstNorm::MinMax) {
+            double lo, hi;
+            cv::minMaxLoc(frame, &lo, &hi);
+            if (hi > lo) scale = 1.0 / (hi - lo);
+            offset = -lo * scale;
+        } else if (norm == BurstNorm::Standardize) {
+            cv::Scalar mean, dev;
+            cv::meanStdDev(frame, mean, dev);
+            if (dev[0] > 0) scale = 1.0 / dev[0];
+            offset = -mean[0] * scale;
+        } else {
+            return;
+        }
+        // in place: the destination already has the frame's size and type
+        frame.convertTo(frame, CV_32F, scale, offset);
+    }
+
+} // namespace thermal
@@ -0,0 +1,230 @@
+#include "CalibrationCache.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace thermal {
+
+    namespace {
+        const char     ENTRY_MAGIC[4] = {'H', 'K', 'C', 'A'};
+        const uint32_t FORMAT_VERSION = 1;
+        // far above any sensor's offset table; guards against a bad size field
+        const uint64_t MAX_PAYLOAD    = uint64_t(64) << 20;
+
+        struct EntryHeader {
+            char     magic[4];
+            uint32_t version;
+            int32_t  model;
+            uint32_t serial;
+            int32_t  width, height;
+            int64_t  savedAtNs;     // system_clock
+            uint64_t payloadBytes;  // the SDK file that follows
+            uint64_t checksum;      // FNV-1a of the payload
+            uint8_t  reserved[16];
+        };
+        static_assert(sizeof(EntryHeader) == 64, "entry header must be 64 bytes");
+
+        uint64_t fnv1a(const std::vector<char>& data) {
+            uint64_t h = 14695981039346656037ull;
+            for (char c : data) {
+                h ^= uint8_t(c);
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+
+        int64_t wallNs() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        bool readAll(int fd, void* data, size_t n) {
+            char* p = static_cast<char*>(data);
+            while (n) {
+                ssize_t k = ::read(fd, p, n);
+                if (k < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                if (k == 0) return false;   // short file
+                p += k;
+                n -= size_t(k);
+            }
+            return true;
+        }
+
+        bool writeAll(int fd, const void* data, size_t n) {
+            const char* p = static_cast<const char*>(data);
+            while (n) {
+                ssize_t k = ::write(fd, p, n);
+                if (k < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                p += k;
+                n -= size_t(k);
+            }
+            return true;
+        }
+
+        // the whole of a (small) file
+        bool readFile(const std::string& path, std::vector<char>& out) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+            struct stat st;
+            bool ok = ::fstat(fd, &st) == 0 && uint64_t(st.st_size) <= MAX_PAYLOAD;
+            if (ok) {
+                out.resize(size_t(st.st_size));
+                ok = readAll(fd, out.data(), out.size());
+            }
+            ::close(fd);
+            return ok;
+        }
+    }
+
+
+    CalibrationCache::CalibrationCache(std::string dir, std::chrono::seconds maxAge)
+        : dir_(std::move(dir)), maxAge_(maxAge) {
+        if (dir_.empty()) dir_ = ".";
+    }
+
+    std::string CalibrationCache::pathFor(unsigned int serial, int model) const {
+        char name[48];
+        std::snprintf(name, sizeof(name), "/calib-%d-%08x.hkcal", model, serial);
+        return dir_ + name;
+    }
+
+    std::string CalibrationCache::tempPath(unsigned int serial, int model) {
+        return pathFor(serial, model) + ".tmp" + std::to_string(::getpid()) + "-" +
+               std::to_string(tempSeq_++);
+    }
+
+    bool CalibrationCache::load(DeviceBackend& dev, unsigned int serial, int model) {
+        const std::string path = pathFor(serial, model);
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            ++misses_;
+            return false;
+        }
+
+        EntryHeader h{};
+        std::vector<char> payload;
+        const char* problem = nullptr;
+        bool stale = false;
+        if (!readAll(fd, &h, sizeof(h)) || std::memcmp(h.magic, ENTRY_MAGIC, 4) != 0 ||
+            h.version != FORMAT_VERSION) {
+            problem = "not a calibration entry";
+        } else if (h.model != model || h.serial != serial ||
+                   h.width != dev.width() || h.height != dev.height()) {
+            problem = "made for another device";
+        } else if (h.payloadBytes > MAX_PAYLOAD) {
+            problem = "bad size";
+        } else {
+            // a save time in the future means the clock was set back since;
+            // its age is unknown, so it is stale too
+            const int64_t age = wallNs() - h.savedAtNs;
+            const int64_t maxAge = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                maxAge_).count();
+            if (maxAge > 0 && (age < 0 || age > maxAge)) {
+                stale = true;
+                problem = "stale";
+            } else {
+                payload.resize(size_t(h.payloadBytes));
+                if (!readAll(fd, payload.data(), payload.size()) || fnv1a(payload) != h.checksum)
+                    problem = "checksum mismatch";
+            }
+        }
+        ::close(fd);
+
+        if (!problem) {
+            // the SDK loads from a file of its own format only
+            const std::string tmp = tempPath(serial, model);
+            int out = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+            if (out < 0) {
+                std::cerr << "[ERROR] calibration cache: cannot create " << tmp << ": "
+                          << std::strerror(errno) << "\n";
+                ++misses_;
+                return false;
+            }
+            bool written = writeAll(out, payload.data(), payload.size());
+            written = ::close(out) == 0 && written;
+            bool applied = written && dev.loadCalibration(tmp);
+            ::unlink(tmp.c_str());
+            if (applied) {
+                ++hits_;
+                return true;
+            }
+            if (!written) {
+                ++misses_;
+                return false;
+            }
+            problem = "refused by the device";
+        }
+
+        std::cerr << "[WARN] calibration cache: " << path << ": " << problem
+                  << ", removed\n";
+        ::unlink(path.c_str());
+        ++(stale ? stale_ : corrupt_);
+        return false;
+    }
+
+    bool CalibrationCache::store(DeviceBackend& dev, unsigned int serial, int model) {
+        const std::string tmp = tempPath(serial, model);
+        std::vector<char> payload;
+        bool saved = dev.saveCalibration(tmp) && readFile(tmp, payload);
+        ::unlink(tmp.c_str());
+        if (!saved) {
+            std::cerr << "[WARN] calibration cache: device " << std::hex << serial
+                      << std::dec << " did not save its calibration\n";
+            return false;
+        }
+
+        EntryHeader h{};
+        std::memcpy(h.magic, ENTRY_MAGIC, 4);
+        h.version      = FORMAT_VERSION;
+        h.model        = model;
+        h.serial       = serial;
+        h.width        = dev.width();
+        h.height       = dev.height();
+        h.savedAtNs    = wallNs();
+        h.payloadBytes = payload.size();
+        h.checksum     = fnv1a(payload);
+
+        // complete on disk before it replaces the old entry
+        const std::string path = pathFor(serial, model);
+        const std::string part = tempPath(serial, model);
+        int fd = ::open(part.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "[ERROR] calibration cache: cannot create " << part << ": "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+        bool ok = writeAll(fd, &h, sizeof(h)) &&
+                  writeAll(fd, payload.data(), payload.size()) &&
+                  ::fsync(fd) == 0;
+        ok = ::close(fd) == 0 && ok;
+        if (!ok || ::rename(part.c_str(), path.c_str()) != 0) {
+            std::cerr << "[ERROR] calibration cache: cannot write " << path << ": "
+                      << std::strerror(errno) << "\n";
+            ::unlink(part.c_str());
+            return false;
+        }
+        ++stores_;
+        return true;
+    }
+
+    bool CalibrationCache::remove(unsigned int serial, int model) {
+        return ::unlink(pathFor(serial, model).c_str()) == 0;
+    }
+
+    CalibrationCacheStats CalibrationCache::stats() const {
+        return {hits_.load(), misses_.load(), stale_.load(), corrupt_.load(),
+                stores_.load()};
+    }
+
+} // namespace thermal
@@ -0,0 +1,213 @@
+#include "CameraPool.h"
+#include <algorithm>
+#include <iostream>
+
+namespace thermal {
+
+    CameraPool::~CameraPool() {
+        closeAll();
+    }
+
+    // — Membership —
+    size_t CameraPool::openAll() {
+        size_t opened = 0;
+        for (const DeviceInfo& dev : ThermalCamera::scanDevices())
+            if (open(dev)) ++opened;
+        return opened;
+    }
+
+    bool CameraPool::open(const DeviceInfo& dev) {
+        if (running_) return false;
+        std::unique_ptr<Member> m = openMember(dev);
+        if (!m) return false;
+        members_.push_back(std::move(m));
+        return true;
+    }
+
+    std::unique_ptr<CameraPool::Member> CameraPool::openMember(const DeviceInfo& dev) {
+        int model = ThermalCamera::modelForProduct(dev.productVersion);
+        if (model == 0) {
+            std::cerr << "[WARN] device #" << dev.deviceNumber
+                      << ": unsupported product 0x" << std::hex
+                      << dev.productVersion << std::dec << "\n";
+            return nullptr;
+        }
+        std::unique_ptr<Member> m(new Member);
+        m->info = dev;
+        m->cam.reset(new ThermalCamera);
+        m->cam->setCalibrationCache(calibrationCache_);
+        if (!m->cam->open(model, dev)) {
+            std::cerr << "[ERROR] device #" << dev.deviceNumber
+                      << ": open failed\n";
+            return nullptr;
+        }
+        return m;
+    }
+
+    std::vector<DeviceBringUp> CameraPool::bringUpAll(ReadyFn onReady,
+                                                      const BringUpOptions& opts) {
+        using Millis = std::chrono::duration<double, std::milli>;
+        if (running_) return {};
+        const std::vector<DeviceInfo> devs = ThermalCamera::scanDevices();
+        std::vector<DeviceBringUp> results(devs.size());
+        std::vector<std::unique_ptr<Member>> ready(devs.size());
+
+        // each worker takes the next device until none are left, so a
+        // slow one holds up only its own worker
+        const auto start = std::chrono::steady_clock::now();
+        std::atomic<size_t> next{0};
+        auto work = [&] {
+            for (;;) {
+                const size_t i = next++;
+                if (i >= devs.size()) break;
+                DeviceBringUp& r = results[i];
+                r = {devs[i], false, false, false, 0, 0, 0.0, 0.0};
+                std::unique_ptr<Member> m = openMember(devs[i]);
+                r.openMs = Millis(std::chrono::steady_clock::now() - start).count();
+                if (!m) continue;
+                r.opened = true;
+                r.calibrationRestored = m->cam->calibrationRestored();
+                ReadyResult probe = m->cam->waitUntilReady(opts.probe);
+                r.probes   = probe.probes;
+                r.lastCode = probe.lastCode;
+                if (!probe.ready) {
+                    std::cerr << "[WARN] device #" << devs[i].deviceNumber
+                              << ": no valid frame after " << probe.probes
+                              << " reads (last code=" << probe.lastCode << "), closed\n";
+                    continue;   // ~Member closes it
+                }
+                r.ready   = true;
+                r.readyMs = Millis(std::chrono::steady_clock::now() - start).count();
+                if (onReady) onReady(*m->cam, r);
+                ready[i] = std::move(m);
+            }
+        };
+        const size_t n = opts.parallel > 0 ? std::min(devs.size(), size_t(opts.parallel))
+                                           : devs.size();
+        if (n == 0) return results;
+        std::vector<std::thread> workers;
+        for (size_t t = 1; t < n; ++t) workers.emplace_back(work);
+        work();
+        for (std::thread& t : workers) t.join();
+
+        for (auto& m : ready)
+            if (m) members_.push_back(std::move(m));
+        return results;
+    }
+
+    void CameraPool::addSource(std::shared_ptr<FrameSource> source,
+                               unsigned int serial) {
+        if (running_ || !source) return;
+        std::unique_ptr<Member> m(new Member);
+        m->info   = {unsigned(members_.size()), 0, serial};
+        m->cam.reset(new ThermalCamera);
+        m->source = std::move(source);
+        members_.push_back(std::move(m));
+    }
+
+    void CameraPool::closeAll() {
+        stop();
+        members_.clear();   // ~ThermalCamera closes the device
+    }
+
+    ThermalCamera* CameraPool::camera(unsigned int serial) {
+        for (auto& m : members_)
+            if (m->info.serialNumber == serial) return m->cam.get();
+        return nullptr;
+    }
+
+
+    // — Streaming —
+    void CameraPool::start(FrameFn cb, bool applyAgc,
+                           const StreamOptions& opts,
+                           const PoolOptions& poolOpts) {
+        if (running_ || !cb || members_.empty()) return;
+        callback_ = std::move(cb);
+        options_  = poolOpts;
+        started_  = std::chrono::steady_clock::now();
+        running_  = true;
+
+        for (size_t i = 0; i < members_.size(); ++i) {
+            Member& m = *members_[i];
+            m.frames = m.delivered = m.dropped = 0;
+            m.queue.reset(options_.merged
+                          ? new SpscRing<Frame>(options_.queueCapacity) : nullptr);
+
+            StreamOptions o = opts;
+            o.source = m.source;
+            o.cpu    = options_.pinThreads ? int(i) : -1;
+            const bool prepare = options_.prepare, withTemp = opts.temperature;
+            const bool reduced = !opts.outputs.empty();
+            m.cam->startStream(ThermalCamera::FrameCb([this, &m, prepare, withTemp,
+                                                       reduced](const Frame& f) {
+                ++m.frames;
+                if (prepare) {
+                    if (reduced) f.outputs();
+                    else         f.color();
+                    f.blobs();
+                    if (withTemp) f.stats();
+                }
+                if (!m.queue) {
+                    callback_(m.info.serialNumber, f);
+                    ++m.delivered;
+                    return;
+                }
+                Frame copy = f;
+                if (!m.queue->push(copy)) ++m.dropped;
+            }), applyAgc, o);
+        }
+        if (options_.merged)
+            mergeThread_ = std::thread(&CameraPool::mergeLoop, this);
+    }
+
+    void CameraPool::stop() {
+        if (!running_) return;
+        // cameras first, so nothing is pushed once the merge thread is gone
+        for (auto& m : members_) m->cam->stopStream();
+        running_ = false;
+        stopped_ = std::chrono::steady_clock::now();
+        if (mergeThread_.joinable()) mergeThread_.join();
+        for (auto& m : members_) m->queue.reset();
+    }
+
+    void CameraPool::mergeLoop() {
+        unsigned spins = 0;
+        Frame f;
+        while (running_) {
+            bool any = false;
+            for (auto& m : members_) {
+                if (!m->queue->pop(f)) continue;
+                callback_(m->info.serialNumber, f);
+                ++m->delivered;
+                f = Frame();    // let the buffers go back to the pool now
+                any = true;
+            }
+            if (any) { spins = 0; continue; }
+            // same backoff as the stream pipeline's idle stages
+            if (++spins < 64) continue;
+            if (spins < 128) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    PoolStats CameraPool::stats() const {
+        PoolStats s{{}, 0, 0, 0, 0.0};
+        double secs = 0.0;
+        if (started_ != std::chrono::steady_clock::time_point()) {
+            auto end = running_ ? std::chrono::steady_clock::now() : stopped_;
+            secs = std::chrono::duration<double>(end - started_).count();
+        }
+        for (const auto& m : members_) {
+            CameraStats c{m->info.serialNumber, m->info.deviceNumber,
+                          m->frames, m->delivered, m->dropped,
+                          secs > 0 ? m->delivered / secs : 0.0};
+            s.frames    += c.frames;
+            s.delivered += c.delivered;
+            s.dropped   += c.dropped;
+            s.fps       += c.fps;
+            s.cameras.push_back(c);
+        }
+        return s;
+    }
+
+} // namespace thermal
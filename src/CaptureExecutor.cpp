@@ -0,0 +1,63 @@
+#include "CaptureExecutor.h"
+#include <algorithm>
+
+namespace thermal {
+
+    CaptureExecutor::CaptureExecutor(int threads) {
+        threads = std::max(1, threads);
+        for (int i = 0; i < threads; ++i)
+            threads_.emplace_back(&CaptureExecutor::run, this);
+    }
+
+    CaptureExecutor::~CaptureExecutor() {
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (std::thread& t : threads_) t.join();
+    }
+
+    void CaptureExecutor::postAt(Clock::time_point due, Task task) {
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            queue_.push({due, seq_++, std::move(task)});
+        }
+        // a new earliest task has to cut a worker's wait short
+        cv_.notify_one();
+    }
+
+    size_t CaptureExecutor::pending() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return queue_.size();
+    }
+
+    void CaptureExecutor::run() {
+        std::unique_lock<std::mutex> lk(mutex_);
+        while (!stop_) {
+            if (queue_.empty()) {
+                cv_.wait(lk);
+                continue;
+            }
+            const Clock::time_point due = queue_.top().due;
+            if (due > Clock::now()) {
+                cv_.wait_until(lk, due);
+                continue;
+            }
+            // top() is const; the entry is popped right after
+            Task task = std::move(const_cast<Entry&>(queue_.top()).task);
+            queue_.pop();
+            // another task may be due as well
+            if (!queue_.empty()) cv_.notify_one();
+            lk.unlock();
+            task();
+            lk.lock();
+        }
+    }
+
+    CaptureExecutor& CaptureExecutor::shared() {
+        static CaptureExecutor executor(2);
+        return executor;
+    }
+
+} // namespace thermal
@@ -0,0 +1,109 @@
+#include "Colorize.h"
+#include "TempStats.h"
+#include "i3system_TE.h"
+#include <opencv2/core/utility.hpp>
+#include <opencv2/imgproc.hpp>
+#include <cstring>
+#include <mutex>
+
+namespace thermal {
+
+    namespace {
+        const int NUM_I3_PALETTES = I3_COLORMAP_RAINBOW + 1;
+
+        struct Lut {
+            std::once_flag once;
+            uint8_t bgr[256 * 3];
+        };
+
+        // index 0 is JET, 1.. are the i3 palettes
+        Lut luts[NUM_I3_PALETTES + 1];
+
+        void buildLut(int palette, uint8_t* bgr) {
+            uint8_t ramp[256];
+            for (int i = 0; i < 256; ++i) ramp[i] = uint8_t(i);
+            if (palette == PALETTE_JET) {
+                cv::Mat gray(1, 256, CV_8U, ramp), color;
+                cv::applyColorMap(gray, color, cv::COLORMAP_JET);
+                std::memcpy(bgr, color.ptr(), 256 * 3);
+            } else {
+                i3::ApplyColorMap(bgr, ramp, palette, 256, 1);
+            }
+        }
+
+        // see ColorRange
+        void colorizeRows(const cv::Mat& raw16, cv::Mat& bgr, const uint8_t* lut,
+                          ColorRange r, int y0, int y1) {
+            const int w = raw16.cols;
+            const uint16_t lo = r.lo;
+            const uint32_t span = r.span, scale = r.scale;
+            for (int y = y0; y < y1; ++y) {
+                const uint16_t* src = raw16.ptr<uint16_t>(y);
+                uint8_t* dst = bgr.ptr(y);
+                for (int x = 0; x < w; ++x) {
+                    uint32_t v = src[x] > lo ? uint32_t(src[x] - lo) : 0u;
+                    if (v > span) v = span;
+                    uint32_t idx = (v * scale + 0x8000u) >> 16;
+                    if (idx > 255) idx = 255;
+                    const uint8_t* c = lut + idx * 3;
+                    dst[3 * x]     = c[0];
+                    dst[3 * x + 1] = c[1];
+                    dst[3 * x + 2] = c[2];
+                }
+            }
+        }
+    }
+
+    const uint8_t* paletteLut(int palette) {
+        if (palette < 0 || palette >= NUM_I3_PALETTES) palette = PALETTE_JET;
+        Lut& l = luts[palette + 1];
+        std::call_once(l.once, [&] { buildLut(palette, l.bgr); });
+        return l.bgr;
+    }
+
+    ColorRange colorRange(uint16_t lo, uint16_t hi) {
+        // hi <= lo: flat frame, everything maps to the bottom of the palette
+        uint32_t range = hi > lo ? uint32_t(hi - lo) : 0u;
+        uint32_t scale = range ? ((255u << 16) + range / 2) / range : 0u;
+        return {lo, range, scale};
+    }
+
+    ColorRange colorRange(const cv::Mat& raw16, bool applyAgc) {
+        // AGC already spread the scene over 16 bits: keep the top byte,
+        // exactly what the old convertTo(CV_8U, 1/256) did
+        if (applyAgc) return {0, UINT16_MAX, 256};
+        uint16_t mn, mx;
+        minMaxU16(raw16, mn, mx);
+        return colorRange(mn, mx);
+    }
+
+    namespace {
+        void colorizeScaled(const cv::Mat& raw16, cv::Mat& bgr, int palette,
+                            ColorRange range) {
+            CV_Assert(raw16.type() == CV_16U);
+            const uint8_t* lut = paletteLut(palette);
+            if (bgr.rows != raw16.rows || bgr.cols != raw16.cols || bgr.type() != CV_8UC3)
+                bgr.create(raw16.rows, raw16.cols, CV_8UC3);
+
+            const int rows = raw16.rows;
+            if (raw16.total() < size_t(COLORIZE_PARALLEL_MIN_PIXELS)) {
+                colorizeRows(raw16, bgr, lut, range, 0, rows);
+                return;
+            }
+            cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& r) {
+                colorizeRows(raw16, bgr, lut, range, r.start, r.end);
+            });
+        }
+    }
+
+    void colorize16(const cv::Mat& raw16, cv::Mat& bgr, int palette,
+                    uint16_t lo, uint16_t hi) {
+        colorizeScaled(raw16, bgr, palette, colorRange(lo, hi));
+    }
+
+    void colorize16(const cv::Mat& raw16, cv::Mat& bgr, int palette,
+                    bool applyAgc) {
+        colorizeScaled(raw16, bgr, palette, colorRange(raw16, applyAgc));
+    }
+
+} // namespace thermal
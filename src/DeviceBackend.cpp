@@ -0,0 +1,23 @@
+#include "DeviceBackend.h"
+#include "SimulatedDevice.h"
+#include <algorithm>
+
+namespace thermal {
+
+    std::unique_ptr<DeviceBackend> openDeviceBackend(int model, unsigned int devNum) {
+        if (SimulatedBus::present(devNum)) return SimulatedBus::open(model, devNum);
+        return openSdkBackend(model, devNum);
+    }
+
+    std::vector<DeviceInfo> scanDeviceBackends() {
+        std::vector<DeviceInfo> list = SimulatedBus::scan();
+        for (const DeviceInfo& d : scanSdkDevices())
+            if (!SimulatedBus::present(d.deviceNumber)) list.push_back(d);
+        std::sort(list.begin(), list.end(),
+                  [](const DeviceInfo& a, const DeviceInfo& b) {
+                      return a.deviceNumber < b.deviceNumber;
+                  });
+        return list;
+    }
+
+} // namespace thermal
@@ -0,0 +1,184 @@
+#include "Frame.h"
+#include "ModelKernels.h"
+
+namespace thermal {
+
+    // — Frame —
+    struct Frame::State {
+        cv::Mat    raw;
+        FrameInfo  info;
+        RenderFn   render;
+        FramePool* pool;
+        const ModelKernels* kernels;
+        std::shared_ptr<const RoiSet> roiSet;
+        std::shared_ptr<const BlobOptions> blobOptions;
+        std::shared_ptr<const OutputSet>   outputSpecs;
+        bool       keepTemperature;
+        bool       outputsNeedTemperature;
+
+        // dropped once pinned; the mutex keeps a reader from touching the
+        // SDK after pin() has let the producer read the next frame
+        std::mutex sourceMutex;
+        std::shared_ptr<FrameSource> source;
+
+        std::once_flag tempRawOnce, tempOnce, statsOnce, colorOnce, roisOnce, blobsOnce,
+                       outputsOnce;
+        cv::Mat   tempRaw, temp, color;
+        TempStats stats{};
+        std::vector<RoiStats> rois;
+        std::vector<Blob>     blobs;
+        std::vector<FrameOutput> outputs;
+    };
+
+    Frame::Frame(cv::Mat raw, const FrameInfo& info, RenderFn render,
+                 std::shared_ptr<FrameSource> source, FramePool* pool,
+                 std::shared_ptr<const RoiSet> rois, bool keepTemperature,
+                 std::shared_ptr<const BlobOptions> blobs,
+                 std::shared_ptr<const OutputSet> outputs,
+                 const ModelKernels* kernels)
+        : s_(std::make_shared<State>()) {
+        s_->raw    = std::move(raw);
+        s_->info   = info;
+        s_->render = std::move(render);
+        s_->source = std::move(source);
+        s_->pool   = pool;
+        s_->kernels = kernels ? kernels : &genericKernels();
+        s_->roiSet = std::move(rois);
+        s_->blobOptions = std::move(blobs);
+        s_->keepTemperature = keepTemperature;
+        s_->outputsNeedTemperature = outputs && needsTemperature(*outputs);
+        s_->outputSpecs = std::move(outputs);
+    }
+
+    const cv::Mat& Frame::raw() const {
+        return s_->raw;
+    }
+
+    const FrameInfo& Frame::info() const {
+        return s_->info;
+    }
+
+    void Frame::pin() const {
+        rois();
+        if (s_->keepTemperature || s_->blobOptions || s_->outputsNeedTemperature)
+            temperatureRaw();
+        std::lock_guard<std::mutex> lk(s_->sourceMutex);
+        s_->source.reset();
+    }
+
+    const cv::Mat& Frame::temperatureRaw() const {
+        State& s = *s_;
+        std::call_once(s.tempRawOnce, [&s] {
+            std::lock_guard<std::mutex> lk(s.sourceMutex);
+            if (!s.source) return;
+            int type = s.source->temperatureType();
+            if (type >= 0) {
+                cv::Mat t;
+                if (s.pool) s.pool->acquire(t, s.raw.rows, s.raw.cols, type);
+                else        t.create(s.raw.rows, s.raw.cols, type);
+                if (s.source->readTemperature(t)) s.tempRaw = t;
+            }
+            s.source.reset();
+        });
+        return s.tempRaw;
+    }
+
+    const cv::Mat& Frame::temperature() const {
+        State& s = *s_;
+        const cv::Mat& native = temperatureRaw();
+        std::call_once(s.tempOnce, [&s, &native] {
+            if (native.empty() || native.type() == CV_32F) {
+                s.temp = native;
+                return;
+            }
+            if (s.pool) s.pool->acquire(s.temp, native.rows, native.cols, CV_32F);
+            // (value - 5000) / 100
+            s.kernels->celsius(native, s.temp);
+        });
+        return s.temp;
+    }
+
+    const TempStats& Frame::stats() const {
+        State& s = *s_;
+        const cv::Mat& native = temperatureRaw();
+        std::call_once(s.statsOnce, [&s, &native] {
+            s.stats = computeTempStats(native);
+        });
+        return s.stats;
+    }
+
+    const cv::Mat& Frame::color() const {
+        State& s = *s_;
+        std::call_once(s.colorOnce, [&s] {
+            if (s.render) s.render(s.raw, s.color);
+            else          s.color = s.raw;
+        });
+        return s.color;
+    }
+
+
+    const std::vector<RoiStats>& Frame::rois() const {
+        State& s = *s_;
+        std::call_once(s.roisOnce, [this, &s] {
+            if (!s.roiSet) return;
+            if (s.roiSet->sparse()) {
+                std::lock_guard<std::mutex> lk(s.sourceMutex);
+                float probe;
+                if (s.source && s.source->temperatureAt(0, 0, probe)) {
+                    FrameSource& src = *s.source;
+                    s.rois = s.roiSet->measure([&src](int x, int y) {
+                        float c = 0;
+                        src.temperatureAt(x, y, c);
+                        return c;
+                    }, s.raw.cols, s.raw.rows);
+                    return;
+                }
+            }
+            s.rois = s.roiSet->measure(temperatureRaw());
+        });
+        return s.rois;
+    }
+
+    const std::vector<Blob>& Frame::blobs() const {
+        State& s = *s_;
+        if (!s.blobOptions) return s.blobs;
+        const cv::Mat& native = temperatureRaw();
+        std::call_once(s.blobsOnce, [&s, &native] {
+            detectBlobs(native, *s.blobOptions, s.blobs);
+        });
+        return s.blobs;
+    }
+
+    const std::vector<FrameOutput>& Frame::outputs() const {
+        State& s = *s_;
+        if (!s.outputSpecs) return s.outputs;
+        static const cv::Mat none;
+        const cv::Mat& native = s.outputsNeedTemperature ? temperatureRaw() : none;
+        std::call_once(s.outputsOnce, [&s, &native] {
+            renderOutputs(s.raw, native, *s.outputSpecs, s.render, s.pool, s.outputs);
+        });
+        return s.outputs;
+    }
+
+
+    // — FrameTracker —
+    void FrameTracker::retire() {
+        std::shared_ptr<Frame::State> last;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            last = last_.lock();
+            last_.reset();
+        }
+        if (last) {
+            Frame f;
+            f.s_ = std::move(last);
+            f.pin();
+        }
+    }
+
+    void FrameTracker::track(const Frame& f) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        last_ = f.s_;
+    }
+
+} // namespace thermal
@@ -0,0 +1,166 @@
+#include "FrameFanout.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <thread>
+
+namespace thermal {
+
+    struct FrameFanout::Subscriber {
+        int              id;
+        SubscribeOptions opts;
+        Callback         cb;
+
+        std::mutex              mutex;
+        std::condition_variable ready;      // a frame was queued, or stop
+        std::condition_variable space;      // a frame was taken (Block)
+        // ring of queued frames
+        std::vector<Frame>      slots;
+        size_t                  head{0}, count{0};
+        bool                    stopping{false};
+        bool                    inCallback{false};
+
+        uint64_t received{0}, delivered{0}, dropped{0};
+        size_t   maxDepth{0};
+        double   lagMs{0};
+
+        std::thread thread;
+    };
+
+    FrameFanout::~FrameFanout() {
+        clear();
+    }
+
+    int FrameFanout::subscribe(Callback cb, const SubscribeOptions& opts) {
+        if (!cb) return -1;
+        auto s = std::make_shared<Subscriber>();
+        s->opts = opts;
+        s->cb   = std::move(cb);
+        const size_t cap = opts.policy == Backpressure::LatestOnly
+                         ? 1 : std::max<size_t>(1, opts.capacity);
+        s->slots.resize(cap);
+        s->thread = std::thread(&FrameFanout::deliverLoop, s);
+
+        std::lock_guard<std::mutex> lk(mutex_);
+        s->id = nextId_++;
+        auto list = subscribers_ ? std::make_shared<List>(*subscribers_)
+                                 : std::make_shared<List>();
+        list->push_back(s);
+        std::atomic_store(&subscribers_, std::shared_ptr<const List>(std::move(list)));
+        return s->id;
+    }
+
+    bool FrameFanout::unsubscribe(int id) {
+        std::shared_ptr<Subscriber> s;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (!subscribers_) return false;
+            auto list = std::make_shared<List>();
+            for (const auto& sub : *subscribers_) {
+                if (sub->id == id) s = sub;
+                else               list->push_back(sub);
+            }
+            if (!s) return false;
+            std::atomic_store(&subscribers_, std::shared_ptr<const List>(std::move(list)));
+        }
+        stop(*s);
+        return true;
+    }
+
+    void FrameFanout::clear() {
+        std::shared_ptr<const List> list;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            list = subscribers_;
+            std::atomic_store(&subscribers_, std::shared_ptr<const List>());
+        }
+        if (!list) return;
+        for (const auto& s : *list) stop(*s);
+    }
+
+    bool FrameFanout::empty() const {
+        auto list = std::atomic_load(&subscribers_);
+        return !list || list->empty();
+    }
+
+    void FrameFanout::stop(Subscriber& s) {
+        {
+            std::lock_guard<std::mutex> lk(s.mutex);
+            s.stopping = true;
+        }
+        s.ready.notify_all();
+        s.space.notify_all();
+        // from its own callback: the loop ends once that returns
+        if (s.thread.get_id() == std::this_thread::get_id()) s.thread.detach();
+        else                                                  s.thread.join();
+    }
+
+    void FrameFanout::publish(const Frame& f) {
+        auto list = std::atomic_load(&subscribers_);
+        if (!list) return;
+        for (const auto& s : *list) {
+            Frame evicted;      // released after the lock
+            {
+                std::unique_lock<std::mutex> lk(s->mutex);
+                if (s->stopping) continue;
+                ++s->received;
+                const size_t cap = s->slots.size();
+                if (s->count == cap) {
+                    if (s->opts.policy == Backpressure::Block) {
+                        s->space.wait(lk, [&] { return s->count < cap || s->stopping; });
+                        if (s->stopping) continue;
+                    } else {
+                        evicted = std::move(s->slots[s->head]);
+                        s->head = (s->head + 1) % cap;
+                        --s->count;
+                        ++s->dropped;
+                    }
+                }
+                s->slots[(s->head + s->count) % cap] = f;
+                s->maxDepth = std::max(s->maxDepth, ++s->count);
+            }
+            s->ready.notify_one();
+        }
+    }
+
+    void FrameFanout::deliverLoop(std::shared_ptr<Subscriber> s) {
+        std::unique_lock<std::mutex> lk(s->mutex);
+        for (;;) {
+            s->ready.wait(lk, [&] { return s->stopping || s->count > 0; });
+            if (s->stopping) break;
+            Frame f = std::move(s->slots[s->head]);
+            s->head = (s->head + 1) % s->slots.size();
+            --s->count;
+            s->inCallback = true;
+            if (!f.empty())
+                s->lagMs = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - f.info().timestamp).count();
+            lk.unlock();
+            s->space.notify_one();
+
+            s->cb(f);
+            f = Frame();
+
+            lk.lock();
+            s->inCallback = false;
+            ++s->delivered;
+        }
+        // what is still queued is never delivered
+        for (Frame& q : s->slots) q = Frame();
+        s->count = 0;
+    }
+
+    std::vector<SubscriberStats> FrameFanout::stats() const {
+        std::vector<SubscriberStats> out;
+        auto list = std::atomic_load(&subscribers_);
+        if (!list) return out;
+        for (const auto& s : *list) {
+            std::lock_guard<std::mutex> lk(s->mutex);
+            out.push_back({s->id, s->opts.name, s->received, s->delivered, s->dropped,
+                           s->count, s->maxDepth,
+                           s->count + (s->inCallback ? 1u : 0u), s->lagMs});
+        }
+        return out;
+    }
+
+} // namespace thermal
@@ -0,0 +1,333 @@
+#include "FrameOutputs.h"
+#include "TempStats.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define THERMAL_X86 1
+#endif
+
+namespace thermal {
+
+    namespace {
+        const int MAX_SCALE = 64;       // keeps the 32-bit box sums from overflowing
+
+        void allocate(FramePool* pool, cv::Mat& m, int rows, int cols, int type) {
+            if (pool) pool->acquire(m, rows, cols, type);
+            else      m.create(rows, cols, type);
+        }
+
+        // Column accumulation of CV_16U rows, the bulk of both passes
+        struct RowKernels {
+            // acc[x] += row[x]
+            void (*accumulate)(const uint16_t* row, uint32_t* acc, size_t n);
+            // colMax[x] = max(colMax[x], row[x]); colSum[x] += row[x]
+            void (*maxSum)(const uint16_t* row, uint16_t* colMax, uint32_t* colSum, size_t n);
+        };
+
+        // — Scalar —
+        void accumulateScalar(const uint16_t* row, uint32_t* acc, size_t n) {
+            for (size_t x = 0; x < n; ++x) acc[x] += row[x];
+        }
+
+        void maxSumScalar(const uint16_t* row, uint16_t* colMax, uint32_t* colSum, size_t n) {
+            for (size_t x = 0; x < n; ++x) {
+                colMax[x] = std::max(colMax[x], row[x]);
+                colSum[x] += row[x];
+            }
+        }
+
+#ifdef THERMAL_X86
+        // — SSE4.1 —
+        __attribute__((target("sse4.1")))
+        inline void add8Sse41(__m128i v, uint32_t* sum) {
+            __m128i* lo = reinterpret_cast<__m128i*>(sum);
+            __m128i* hi = reinterpret_cast<__m128i*>(sum + 4);
+            _mm_storeu_si128(lo, _mm_add_epi32(_mm_loadu_si128(lo), _mm_cvtepu16_epi32(v)));
+            _mm_storeu_si128(hi, _mm_add_epi32(_mm_loadu_si128(hi),
+                                               _mm_cvtepu16_epi32(_mm_srli_si128(v, 8))));
+        }
+
+        __attribute__((target("sse4.1")))
+        void accumulateSse41(const uint16_t* row, uint32_t* acc, size_t n) {
+            size_t x = 0;
+            for (; x + 8 <= n; x += 8)
+                add8Sse41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x)), acc + x);
+            accumulateScalar(row + x, acc + x, n - x);
+        }
+
+        __attribute__((target("sse4.1")))
+        void maxSumSse41(const uint16_t* row, uint16_t* colMax, uint32_t* colSum, size_t n) {
+            size_t x = 0;
+            for (; x + 8 <= n; x += 8) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+                __m128i* m = reinterpret_cast<__m128i*>(colMax + x);
+                _mm_storeu_si128(m, _mm_max_epu16(_mm_loadu_si128(m), v));
+                add8Sse41(v, colSum + x);
+            }
+            maxSumScalar(row + x, colMax + x, colSum + x, n - x);
+        }
+
+        // — AVX2 —
+        __attribute__((target("avx2")))
+        inline void add16Avx2(__m256i v, uint32_t* sum) {
+            __m256i* lo = reinterpret_cast<__m256i*>(sum);
+            __m256i* hi = reinterpret_cast<__m256i*>(sum + 8);
+            _mm256_storeu_si256(lo, _mm256_add_epi32(_mm256_loadu_si256(lo),
+                                _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v))));
+            _mm256_storeu_si256(hi, _mm256_add_epi32(_mm256_loadu_si256(hi),
+                                _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1))));
+        }
+
+        __attribute__((target("avx2")))
+        void accumulateAvx2(const uint16_t* row, uint32_t* acc, size_t n) {
+            size_t x = 0;
+            for (; x + 16 <= n; x += 16)
+                add16Avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x)), acc + x);
+            accumulateScalar(row + x, acc + x, n - x);
+        }
+
+        __attribute__((target("avx2")))
+        void maxSumAvx2(const uint16_t* row, uint16_t* colMax, uint32_t* colSum, size_t n) {
+            size_t x = 0;
+            for (; x + 16 <= n; x += 16) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+                __m256i* m = reinterpret_cast<__m256i*>(colMax + x);
+                _mm256_storeu_si256(m, _mm256_max_epu16(_mm256_loadu_si256(m), v));
+                add16Avx2(v, colSum + x);
+            }
+            maxSumScalar(row + x, colMax + x, colSum + x, n - x);
+        }
+#endif // THERMAL_X86
+
+        // NEON builds use the scalar loops, which the compiler vectorizes
+        RowKernels kernelsFor(SimdLevel level) {
+            switch (level) {
+#ifdef THERMAL_X86
+                case SimdLevel::AVX2:  return {accumulateAvx2, maxSumAvx2};
+                case SimdLevel::SSE41: return {accumulateSse41, maxSumSse41};
+#endif
+                default:               return {accumulateScalar, maxSumScalar};
+            }
+        }
+
+        const RowKernels& rowKernels() {
+            static const RowKernels k = kernelsFor(detectSimdLevel());
+            return k;
+        }
+
+        // the same, by element type: CV_32F rows are summed in float
+        inline void accumulate(const uint16_t* row, uint32_t* acc, size_t n) {
+            rowKernels().accumulate(row, acc, n);
+        }
+        inline void accumulate(const float* row, float* acc, size_t n) {
+            for (size_t x = 0; x < n; ++x) acc[x] += row[x];
+        }
+        inline void maxSum(const uint16_t* row, uint16_t* colMax, uint32_t* colSum, size_t n) {
+            rowKernels().maxSum(row, colMax, colSum, n);
+        }
+        inline void maxSum(const float* row, float* colMax, double* colSum, size_t n) {
+            for (size_t x = 0; x < n; ++x) {
+                colMax[x] = std::max(colMax[x], row[x]);
+                colSum[x] += row[x];
+            }
+        }
+
+        // sum / n, rounded for the integer encoding; multiplies by 1 / n
+        // rather than dividing (exact: the quotient's fraction is a
+        // multiple of 1 / n, far above the rounding error)
+        struct Average {
+            explicit Average(uint32_t n) : n_(n), inv_(1.0 / n) {}
+            uint16_t operator()(uint32_t sum) const {
+                return uint16_t(double(sum + n_ / 2) * inv_ + 1e-7);
+            }
+            float operator()(float sum) const { return float(sum * inv_); }
+            uint32_t n_;
+            double   inv_;
+        };
+
+        inline float toCelsius(uint16_t v) { return (v - 5000) / 100.0f; }
+        inline float toCelsius(float v)    { return v; }
+        inline float meanCelsius(uint64_t sum, double n) {
+            return float((double(sum) / n - 5000.0) / 100.0);
+        }
+        inline float meanCelsius(double sum, double n) { return float(sum / n); }
+
+        // each s columns of an s-row block summed and averaged into one
+        // thumbnail pixel; S > 0 fixes s at compile time, so the common
+        // scales get an unrolled loop
+        template <int S, typename T, typename Sum>
+        void sumAcross(const Sum* acc, T* out, int tw, int s) {
+            const int n = S > 0 ? S : s;
+            const Average avg(uint32_t(n * n));
+            for (int tx = 0; tx < tw; ++tx) {
+                Sum a = 0;
+                for (int k = 0; k < n; ++k) a += acc[tx * n + k];
+                out[tx] = avg(a);
+            }
+        }
+
+        // The single pass behind renderOutputs: row y goes into every
+        // thumbnail's per-column sums and every crop that covers it; every
+        // `scale` rows the column sums are summed across and written out.
+        template <typename T, typename Sum>
+        void reduceRows(const cv::Mat& raw, const OutputSet& specs,
+                        const std::vector<cv::Rect>& boxes, std::vector<cv::Mat>& reduced) {
+            thread_local std::vector<Sum>    sums;
+            thread_local std::vector<size_t> offsets;
+            offsets.assign(specs.size(), 0);
+            size_t total = 0;
+            for (size_t i = 0; i < specs.size(); ++i) {
+                if (specs[i].kind != OutputKind::Thumbnail || reduced[i].empty()) continue;
+                offsets[i] = total;
+                total += size_t(boxes[i].width);
+            }
+            sums.assign(total, Sum(0));
+
+            for (int y = 0; y < raw.rows; ++y) {
+                const T* row = raw.ptr<T>(y);
+                for (size_t i = 0; i < specs.size(); ++i) {
+                    cv::Mat& r = reduced[i];
+                    if (r.empty()) continue;
+                    const cv::Rect& box = boxes[i];
+                    if (y < box.y || y >= box.y + box.height) continue;
+                    if (specs[i].kind == OutputKind::Crop) {
+                        std::memcpy(r.ptr<T>(y - box.y), row + box.x, size_t(box.width) * sizeof(T));
+                        continue;
+                    }
+                    Sum* acc = sums.data() + offsets[i];
+                    const int bw = box.width, tw = r.cols, s = bw / tw;
+                    accumulate(row, acc, size_t(bw));
+                    if (y % s != s - 1) continue;
+                    T* out = r.ptr<T>(y / s);
+                    switch (s) {
+                        case 2:  sumAcross<2>(acc, out, tw, s); break;
+                        case 4:  sumAcross<4>(acc, out, tw, s); break;
+                        case 8:  sumAcross<8>(acc, out, tw, s); break;
+                        default: sumAcross<0>(acc, out, tw, s); break;
+                    }
+                    std::fill(acc, acc + bw, Sum(0));
+                }
+            }
+        }
+
+        // per-column max and sum over each row of cells, then across the
+        // columns of each cell; Sum holds a column of one cell
+        template <typename T, typename Sum, typename Total>
+        void gridPass(const cv::Mat& temp, int cols, int rows, cv::Mat& max, cv::Mat& mean) {
+            const int w = temp.cols, h = temp.rows;
+            thread_local std::vector<T>   colMax;
+            thread_local std::vector<Sum> colSum;
+            colMax.resize(w);
+            colSum.resize(w);
+
+            for (int by = 0; by < rows; ++by) {
+                const int y0 = int(int64_t(by) * h / rows), y1 = int(int64_t(by + 1) * h / rows);
+                std::fill(colMax.begin(), colMax.end(), std::numeric_limits<T>::lowest());
+                std::fill(colSum.begin(), colSum.end(), Sum(0));
+                T*   cm = colMax.data();
+                Sum* cs = colSum.data();
+                for (int y = y0; y < y1; ++y) maxSum(temp.ptr<T>(y), cm, cs, size_t(w));
+                float* mx = max.ptr<float>(by);
+                float* mn = mean.ptr<float>(by);
+                for (int b = 0; b < cols; ++b) {
+                    const int x0 = int(int64_t(b) * w / cols), x1 = int(int64_t(b + 1) * w / cols);
+                    T m = std::numeric_limits<T>::lowest();
+                    Total t = 0;
+                    for (int x = x0; x < x1; ++x) {
+                        m = std::max(m, cm[x]);
+                        t += cs[x];
+                    }
+                    mx[b] = toCelsius(m);
+                    mn[b] = meanCelsius(t, double(x1 - x0) * (y1 - y0));
+                }
+            }
+        }
+    }
+
+    OutputSpec OutputSpec::thumbnail(int scale) {
+        OutputSpec s;
+        s.kind  = OutputKind::Thumbnail;
+        s.scale = scale;
+        return s;
+    }
+
+    OutputSpec OutputSpec::crop(cv::Rect region) {
+        OutputSpec s;
+        s.kind   = OutputKind::Crop;
+        s.region = region;
+        return s;
+    }
+
+    OutputSpec OutputSpec::blockGrid(int cols, int rows) {
+        OutputSpec s;
+        s.kind = OutputKind::BlockGrid;
+        s.grid = cv::Size(cols, rows);
+        return s;
+    }
+
+    bool needsTemperature(const OutputSet& specs) {
+        return std::any_of(specs.begin(), specs.end(), [](const OutputSpec& s) {
+            return s.kind == OutputKind::BlockGrid;
+        });
+    }
+
+    void blockGrid(const cv::Mat& temp, cv::Size grid, cv::Mat& max, cv::Mat& mean,
+                   FramePool* pool) {
+        if (temp.empty() || (temp.type() != CV_16U && temp.type() != CV_32F)) return;
+        // at most one cell per pixel, so none is empty
+        const int cols = std::min(std::max(1, grid.width), temp.cols);
+        const int rows = std::min(std::max(1, grid.height), temp.rows);
+        allocate(pool, max, rows, cols, CV_32F);
+        allocate(pool, mean, rows, cols, CV_32F);
+        if (temp.type() == CV_16U) gridPass<uint16_t, uint32_t, uint64_t>(temp, cols, rows, max, mean);
+        else                       gridPass<float, double, double>(temp, cols, rows, max, mean);
+    }
+
+    void renderOutputs(const cv::Mat& raw, const cv::Mat& temp, const OutputSet& specs,
+                       const std::function<void(const cv::Mat&, cv::Mat&)>& render,
+                       FramePool* pool, std::vector<FrameOutput>& out) {
+        out.assign(specs.size(), FrameOutput());
+        const bool images = !raw.empty() && (raw.type() == CV_16U || raw.type() == CV_32F);
+        const cv::Rect frame(0, 0, raw.cols, raw.rows);
+        std::vector<cv::Mat>  reduced(specs.size());
+        std::vector<cv::Rect> boxes(specs.size());
+        bool any = false;
+        for (size_t i = 0; i < specs.size(); ++i) {
+            const OutputSpec& spec = specs[i];
+            out[i].kind = spec.kind;
+            switch (spec.kind) {
+                case OutputKind::Thumbnail: {
+                    const int s = std::min(std::max(1, spec.scale), MAX_SCALE);
+                    const int tw = raw.cols / s, th = raw.rows / s;
+                    if (!images || tw == 0 || th == 0) break;
+                    boxes[i] = cv::Rect(0, 0, tw * s, th * s);
+                    allocate(pool, reduced[i], th, tw, raw.type());
+                    any = true;
+                    break;
+                }
+                case OutputKind::Crop:
+                    boxes[i] = spec.region & frame;
+                    if (!images || boxes[i].empty()) break;
+                    allocate(pool, reduced[i], boxes[i].height, boxes[i].width, raw.type());
+                    any = true;
+                    break;
+                case OutputKind::BlockGrid:
+                    blockGrid(temp, spec.grid, out[i].max, out[i].mean, pool);
+                    break;
+            }
+        }
+        if (!any) return;
+
+        if (raw.type() == CV_16U) reduceRows<uint16_t, uint32_t>(raw, specs, boxes, reduced);
+        else                      reduceRows<float, float>(raw, specs, boxes, reduced);
+        for (size_t i = 0; i < specs.size(); ++i) {
+            if (reduced[i].empty()) continue;
+            if (render) render(reduced[i], out[i].image);
+            else        out[i].image = reduced[i];
+        }
+    }
+
+} // namespace thermal
@@ -0,0 +1,64 @@
+#include "FramePacer.h"
+#include <thread>
+
+namespace thermal {
+
+    FramePacer::FramePacer(double fps, CatchUpPolicy policy) {
+        reset(fps, policy);
+    }
+
+    void FramePacer::reset(double fps, CatchUpPolicy policy) {
+        fps_     = fps > 0 ? fps : 30.0;
+        policy_  = policy;
+        period_  = std::chrono::duration_cast<Clock::duration>(
+                       std::chrono::duration<double>(1.0 / fps_));
+        started_ = false;
+        ticks_ = skipped_ = late_ = 0;
+        jitterSumNs_ = jitterMaxNs_ = 0;
+    }
+
+    uint64_t FramePacer::wait() {
+        if (!started_) {
+            // first frame goes out immediately and anchors the schedule
+            started_  = true;
+            deadline_ = Clock::now() + period_;
+            ++ticks_;
+            return 0;
+        }
+
+        auto now = Clock::now();
+        bool wasLate = now > deadline_;
+        if (!wasLate) {
+            std::this_thread::sleep_until(deadline_);
+            now = Clock::now();
+        }
+
+        uint64_t jitter = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       now - deadline_).count());
+        jitterSumNs_ += jitter;
+        if (jitter > jitterMaxNs_) jitterMaxNs_ = jitter;
+        if (wasLate) ++late_;
+        ++ticks_;
+
+        uint64_t missed = 0;
+        if (policy_ == CatchUpPolicy::Skip && now - deadline_ >= period_) {
+            missed = uint64_t((now - deadline_) / period_);
+            deadline_ += period_ * missed;
+            skipped_ += missed;
+        }
+        deadline_ += period_;
+        return missed;
+    }
+
+    PacerStats FramePacer::stats() const {
+        uint64_t ticks = ticks_;
+        // the anchoring first tick has no deadline to be measured against
+        uint64_t measured = ticks > 1 ? ticks - 1 : 0;
+        return {
+            ticks, skipped_, late_,
+            measured ? jitterSumNs_ / 1e3 / double(measured) : 0.0,
+            jitterMaxNs_ / 1e3,
+        };
+    }
+
+} // namespace thermal
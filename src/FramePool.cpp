@@ -0,0 +1,116 @@
+#include "FramePool.h"
+
+namespace thermal {
+
+    FramePool* FramePool::create() {
+        return new FramePool();
+    }
+
+    FramePool::~FramePool() {
+        for (cv::UMatData* u : idle_) {
+            cv::fastFree(u->origdata);
+            u->origdata = u->data = nullptr;
+            delete u;
+        }
+    }
+
+    void FramePool::release() {
+        bool last;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            released_ = true;
+            last = (outstanding_ == 0);
+        }
+        if (last) delete this;
+    }
+
+    // Grab an idle block of exactly `bytes`, or fall back to the heap.
+    // Frames only come in a handful of sizes, so a linear scan is enough.
+    cv::UMatData* FramePool::take(size_t bytes) const {
+        for (size_t i = 0; i < idle_.size(); ++i) {
+            if (idle_[i]->size == bytes) {
+                cv::UMatData* u = idle_[i];
+                idle_[i] = idle_.back();
+                idle_.pop_back();
+                return u;
+            }
+        }
+        auto u = new cv::UMatData(this);
+        u->data = u->origdata = static_cast<uchar*>(cv::fastMalloc(bytes));
+        u->size = bytes;
+        ++heapAllocations_;
+        // grow the free list now, while we are allocating anyway, so that
+        // handing the block back in deallocate() never has to
+        idle_.reserve(++blocks_);
+        return u;
+    }
+
+    void FramePool::reserve(size_t bytes, size_t count) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        size_t have = 0;
+        for (cv::UMatData* u : idle_)
+            if (u->size == bytes) ++have;
+        while (have++ < count)
+            idle_.push_back(take(bytes));
+    }
+
+    void FramePool::acquire(cv::Mat& m, int rows, int cols, int type) {
+        if (!m.empty() && m.rows == rows && m.cols == cols && m.type() == type)
+            return;
+        m.release();
+        // only route this one create() through us: the storage remembers its
+        // allocator, the Mat header must not outlive the pool with a stale one
+        m.allocator = const_cast<FramePool*>(this);
+        m.create(rows, cols, type);
+        m.allocator = nullptr;
+    }
+
+    FramePoolStats FramePool::stats() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return {heapAllocations_, acquisitions_, outstanding_, idle_.size()};
+    }
+
+
+    // — cv::MatAllocator interface —
+    cv::UMatData* FramePool::allocate(int dims, const int* sizes, int type,
+                                      void* data, size_t* step,
+                                      cv::AccessFlag flags,
+                                      cv::UMatUsageFlags usage) const {
+        // user-supplied storage is not ours to recycle
+        if (data)
+            return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data,
+                                                        step, flags, usage);
+
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; --i) {
+            if (step) step[i] = total;
+            total *= sizes[i];
+        }
+
+        std::lock_guard<std::mutex> lk(mutex_);
+        cv::UMatData* u = take(total);
+        u->data     = u->origdata;
+        u->refcount = u->urefcount = 0;
+        u->flags    = cv::UMatData::MemoryFlag(0);
+        ++acquisitions_;
+        ++outstanding_;
+        return u;
+    }
+
+    bool FramePool::allocate(cv::UMatData* u, cv::AccessFlag,
+                             cv::UMatUsageFlags) const {
+        return u != nullptr;
+    }
+
+    void FramePool::deallocate(cv::UMatData* u) const {
+        if (!u) return;
+        bool last;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            idle_.push_back(u);
+            last = (--outstanding_ == 0) && released_;
+        }
+        if (last) delete this;
+    }
+
+} // namespace thermal
@@ -0,0 +1,115 @@
+#include "FrameSource.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+namespace thermal {
+
+    int FrameSource::frameType(bool) const {
+        return CV_16U;
+    }
+
+    int readFrame(FrameSource& src, cv::Mat& dst, bool applyAgc, int maxRetries,
+                  CameraMetrics* metrics) {
+        if (maxRetries <= 0) maxRetries = src.readAttempts();
+        if (metrics && !metrics->enabled()) metrics = nullptr;
+        int retry = 0, ret = 0;
+        // Retry if the first attempt fails
+        // (e.g. if the camera is still warming up)
+        do {
+            {
+                StageTimer timer(metrics, Stage::Read);
+                ret = src.read(dst, applyAgc);
+            }
+            if (ret != 1 && metrics) metrics->countRetry(ret);
+            if (ret == 1 || maxRetries == 1) break;
+            std::cerr << "[WARN] RecvImage failed (code=" << ret
+                      << "), retrying " << (retry+1) << "/" << maxRetries << "\n";
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        } while (++retry < maxRetries);
+
+        if (ret != 1 && metrics) metrics->countReadFailure();
+        if (ret != 1 && maxRetries > 1) {
+            std::cerr << "[ERROR] readFrame: giving up after "
+                      << maxRetries << " retries (last code=" << ret << ")\n";
+        }
+        return ret;
+    }
+
+
+    // — Synthetic source —
+    SyntheticFrameSource::SyntheticFrameSource(int width, int height, double fps)
+        : w_(width), h_(height), fps_(fps),
+          period_(fps > 0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                std::chrono::duration<double>(1.0 / fps))
+                          : std::chrono::steady_clock::duration::zero()),
+          next_(std::chrono::steady_clock::now()),
+          background_(size_t(width) * height),
+          backgroundAgc_(size_t(width) * height) {
+        // raw counts sit in a narrow band like a real sensor; the AGC variant
+        // is the same scene stretched over the full 16-bit range
+        for (int y = 0; y < h_; ++y) {
+            for (int x = 0; x < w_; ++x) {
+                size_t i = size_t(y) * w_ + x;
+                background_[i]    = static_cast<unsigned short>(7000 + 6 * x + 4 * y);
+                backgroundAgc_[i] = static_cast<unsigned short>(
+                    (60000.0 * (x + y)) / (w_ + h_));
+            }
+        }
+    }
+
+    int SyntheticFrameSource::read(cv::Mat& dst, bool applyAgc) {
+        if (period_.count() > 0) {
+            next_ += period_;
+            auto now = std::chrono::steady_clock::now();
+            if (next_ > now) std::this_thread::sleep_until(next_);
+            else             next_ = now;   // fell behind: don't try to catch up
+        }
+
+        renderScene(dst, applyAgc, frames_);
+        ++frames_;
+        return 1;
+    }
+
+    bool SyntheticFrameSource::readTemperature(cv::Mat& dst) {
+        if (frames_ == 0) return false;
+        renderScene(dst, false, frames_ - 1);
+        return true;
+    }
+
+    bool SyntheticFrameSource::temperatureAt(int x, int y, float& celsius) {
+        if (frames_ == 0 || x < 0 || y < 0 || x >= w_ || y >= h_) return false;
+        int cx, cy, R;
+        blob(frames_ - 1, cx, cy, R);
+        bool inBlob = x >= cx - R && x < cx + R && y >= cy - R && y < cy + R;
+        int v = inBlob ? 12000 : background_[size_t(y) * w_ + x];
+        celsius = (v - 5000) * 0.01f;
+        return true;
+    }
+
+    void SyntheticFrameSource::blob(uint64_t frame, int& cx, int& cy, int& r) const {
+        // the blob walks along the diagonal, one pixel per frame
+        r  = std::max(4, w_ / 32);
+        cx = int(frame % uint64_t(w_));
+        cy = int((frame * h_ / w_) % uint64_t(h_));
+    }
+
+    void SyntheticFrameSource::renderScene(cv::Mat& dst, bool applyAgc,
+                                           uint64_t frame) const {
+        const auto& bg = applyAgc ? backgroundAgc_ : background_;
+        const unsigned short hot = applyAgc ? 65000 : 12000;
+        std::memcpy(dst.ptr<unsigned short>(), bg.data(),
+                    bg.size() * sizeof(unsigned short));
+
+        int cx, cy, R;
+        blob(frame, cx, cy, R);
+        for (int y = std::max(0, cy - R); y < std::min(h_, cy + R); ++y) {
+            unsigned short* row = dst.ptr<unsigned short>(y);
+            for (int x = std::max(0, cx - R); x < std::min(w_, cx + R); ++x)
+                row[x] = hot;
+        }
+    }
+
+} // namespace thermal
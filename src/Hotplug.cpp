@@ -0,0 +1,68 @@
+#include "Hotplug.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace thermal {
+
+    namespace {
+        struct Subscriber {
+            int deviceNumber;
+            std::shared_ptr<HotplugDispatcher::Handler> handler;
+        };
+
+        struct Registry {
+            std::mutex                mutex;
+            std::map<int, Subscriber> subs;     // by token
+            int                       nextToken = 1;
+            bool                      installed = false;
+        };
+
+        Registry& registry() {
+            static Registry r;
+            return r;
+        }
+    }
+
+    int HotplugDispatcher::subscribe(int deviceNumber, Handler h) {
+        if (!h) return -1;
+        Registry& r = registry();
+        bool install = false;
+        int token;
+        {
+            std::lock_guard<std::mutex> lk(r.mutex);
+            token = r.nextToken++;
+            r.subs[token] = {deviceNumber, std::make_shared<Handler>(std::move(h))};
+            install = !r.installed;
+            r.installed = true;
+        }
+        if (install) i3::SetHotplugCallback(&HotplugDispatcher::dispatch);
+        return token;
+    }
+
+    void HotplugDispatcher::unsubscribe(int token) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lk(r.mutex);
+        r.subs.erase(token);
+    }
+
+    void HotplugDispatcher::inject(i3::TE_STATE state) {
+        dispatch(state);
+    }
+
+    void HotplugDispatcher::dispatch(i3::TE_STATE state) {
+        std::vector<std::shared_ptr<Handler>> targets;
+        {
+            Registry& r = registry();
+            std::lock_guard<std::mutex> lk(r.mutex);
+            for (const auto& kv : r.subs) {
+                const Subscriber& s = kv.second;
+                if (s.deviceNumber == ANY_DEVICE || s.deviceNumber == state.nUsbNum)
+                    targets.push_back(s.handler);
+            }
+        }
+        for (const auto& h : targets) (*h)(state);
+    }
+
+} // namespace thermal
@@ -0,0 +1,255 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace thermal {
+
+    // — Histogram —
+    int LatencyHistogram::bucketOf(uint64_t ns) {
+        const uint64_t SUB = uint64_t(1) << SUB_BITS;
+        if (ns < SUB) return int(ns);
+        int e = 63 - __builtin_clzll(ns);                   // >= SUB_BITS
+        int sub = int((ns >> (e - SUB_BITS)) & (SUB - 1));
+        return ((e - SUB_BITS + 1) << SUB_BITS) + sub;
+    }
+
+    uint64_t LatencyHistogram::upperBound(int bucket) {
+        const int SUB = 1 << SUB_BITS;
+        if (bucket < SUB) return uint64_t(bucket);
+        int group = bucket >> SUB_BITS, sub = bucket & (SUB - 1);
+        uint64_t width = uint64_t(1) << (group - 1);
+        return uint64_t(SUB + sub) * width + (width - 1);
+    }
+
+    void LatencyHistogram::record(uint64_t ns) {
+        counts_[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t mx = max_.load(std::memory_order_relaxed);
+        while (ns > mx && !max_.compare_exchange_weak(mx, ns, std::memory_order_relaxed)) {}
+    }
+
+    HistogramSnapshot LatencyHistogram::snapshot() const {
+        HistogramSnapshot s;
+        s.count = 0;
+        for (int b = 0; b < BUCKETS; ++b) {
+            uint64_t n = counts_[b].load(std::memory_order_relaxed);
+            if (!n) continue;
+            s.buckets.push_back({upperBound(b), n});
+            s.count += n;
+        }
+        // the count comes from the buckets, so percentiles stay consistent
+        // with them while other threads keep recording
+        s.sumNs = sum_.load(std::memory_order_relaxed);
+        s.maxNs = max_.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    void LatencyHistogram::reset() {
+        for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t HistogramSnapshot::percentileNs(double q) const {
+        if (!count) return 0;
+        uint64_t rank = uint64_t(q * double(count) + 0.5);
+        if (rank < 1) rank = 1;
+        uint64_t seen = 0;
+        for (const auto& b : buckets) {
+            seen += b.second;
+            if (seen >= rank) return std::min(b.first, maxNs ? maxNs : b.first);
+        }
+        return buckets.back().first;
+    }
+
+
+    // — Camera metrics —
+    void CameraMetrics::countRetry(int code) {
+        int i = (code >= 2 && code <= 4) ? code : 0;
+        retries_[i].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    MetricsSnapshot CameraMetrics::snapshot() const {
+        MetricsSnapshot s;
+        s.frames       = frames_.load(std::memory_order_relaxed);
+        s.readFailures = readFailures_.load(std::memory_order_relaxed);
+        for (int i = 0; i < 5; ++i)
+            s.retries[i] = retries_[i].load(std::memory_order_relaxed);
+        s.dropped      = dropped_.load(std::memory_order_relaxed);
+        for (int i = 0; i < int(Stage::Count); ++i)
+            s.stages[i] = stages_[i].snapshot();
+        return s;
+    }
+
+    void CameraMetrics::reset() {
+        frames_.store(0, std::memory_order_relaxed);
+        readFailures_.store(0, std::memory_order_relaxed);
+        for (auto& r : retries_) r.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+        for (auto& h : stages_) h.reset();
+    }
+
+
+    // — Prometheus text format —
+    namespace {
+        const char* const STAGE_NAMES[] = {"read", "convert", "colorize", "callback"};
+        // histogram bucket bounds exported, in seconds
+        const double EXPORT_BOUNDS[] = {
+            50e-6, 100e-6, 250e-6, 500e-6, 1e-3, 2.5e-3, 5e-3, 10e-3,
+            25e-3, 50e-3, 100e-3, 250e-3, 500e-3, 1.0, 2.5
+        };
+
+        std::string escapeLabel(const std::string& v) {
+            std::string out;
+            for (char c : v) {
+                if (c == '\\' || c == '"') out += '\\';
+                if (c == '\n') { out += "\\n"; continue; }
+                out += c;
+            }
+            return out;
+        }
+    }
+
+    std::string formatPrometheus(
+        const std::vector<std::pair<std::string, MetricsSnapshot>>& cameras) {
+        std::ostringstream o;
+        auto counter = [&](const char* name, const char* help,
+                           uint64_t MetricsSnapshot::* field) {
+            o << "# HELP " << name << ' ' << help << "\n# TYPE " << name << " counter\n";
+            for (const auto& c : cameras)
+                o << name << "{camera=\"" << escapeLabel(c.first) << "\"} "
+                  << c.second.*field << '\n';
+        };
+        counter("thermal_frames_total", "Frames captured or delivered.",
+                &MetricsSnapshot::frames);
+        counter("thermal_read_failures_total", "Reads given up after the last retry.",
+                &MetricsSnapshot::readFailures);
+        counter("thermal_frames_dropped_total", "Frames skipped by pacing or a full pipeline.",
+                &MetricsSnapshot::dropped);
+
+        o << "# HELP thermal_read_retries_total Failed read attempts by RecvImage code.\n"
+             "# TYPE thermal_read_retries_total counter\n";
+        for (const auto& c : cameras)
+            for (int code = 0; code < 5; ++code) {
+                if (code == 1) continue;
+                o << "thermal_read_retries_total{camera=\"" << escapeLabel(c.first)
+                  << "\",code=\"" << (code ? std::to_string(code) : "other") << "\"} "
+                  << c.second.retries[code] << '\n';
+            }
+
+        for (int st = 0; st < int(Stage::Count); ++st) {
+            std::string name = std::string("thermal_") + STAGE_NAMES[st] + "_seconds";
+            o << "# HELP " << name << " Time spent in the " << STAGE_NAMES[st] << " stage.\n"
+              << "# TYPE " << name << " histogram\n";
+            for (const auto& c : cameras) {
+                const HistogramSnapshot& h = c.second.stages[st];
+                std::string label = "camera=\"" + escapeLabel(c.first) + "\"";
+                size_t i = 0;
+                uint64_t cumulative = 0;
+                for (double le : EXPORT_BOUNDS) {
+                    // a bucket counts once all of it fits under the bound
+                    const uint64_t leNs = uint64_t(le * 1e9);
+                    while (i < h.buckets.size() && h.buckets[i].first <= leNs)
+                        cumulative += h.buckets[i++].second;
+                    o << name << "_bucket{" << label << ",le=\"" << le << "\"} "
+                      << cumulative << '\n';
+                }
+                o << name << "_bucket{" << label << ",le=\"+Inf\"} " << h.count << '\n'
+                  << name << "_sum{" << label << "} " << h.sumNs * 1e-9 << '\n'
+                  << name << "_count{" << label << "} " << h.count << '\n';
+            }
+        }
+        return o.str();
+    }
+
+
+    // — HTTP endpoint —
+    MetricsServer::~MetricsServer() {
+        stop();
+    }
+
+    bool MetricsServer::start(int port, BodyFn body, const std::string& bindAddress) {
+        stop();
+        fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd_ < 0) {
+            std::cerr << "[ERROR] MetricsServer: socket: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        int one = 1;
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port   = htons(uint16_t(port));
+        if (::inet_pton(AF_INET, bindAddress.c_str(), &addr.sin_addr) != 1 ||
+            ::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(fd_, 4) != 0) {
+            std::cerr << "[ERROR] MetricsServer: can't listen on " << bindAddress
+                      << ":" << port << ": " << std::strerror(errno) << "\n";
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+
+        body_ = std::move(body);
+        running_ = true;
+        thread_ = std::thread(&MetricsServer::serveLoop, this);
+        std::cerr << "[INFO] metrics on http://" << bindAddress << ":" << port_ << "/metrics\n";
+        return true;
+    }
+
+    void MetricsServer::stop() {
+        running_ = false;
+        if (thread_.joinable()) thread_.join();
+        if (fd_ >= 0) {
+            ::close(fd_);
+            fd_ = -1;
+        }
+    }
+
+    void MetricsServer::serveLoop() {
+        while (running_) {
+            // wake up now and then to notice stop()
+            pollfd p{fd_, POLLIN, 0};
+            if (::poll(&p, 1, 200) <= 0) continue;
+            int c = ::accept(fd_, nullptr, nullptr);
+            if (c < 0) continue;
+
+            // the request itself doesn't matter beyond being a GET
+            char req[1024];
+            pollfd pc{c, POLLIN, 0};
+            ssize_t n = ::poll(&pc, 1, 1000) > 0 ? ::recv(c, req, sizeof(req) - 1, 0) : 0;
+            std::string head = n > 0 ? std::string(req, size_t(n)) : std::string();
+
+            std::string status = "200 OK", text;
+            if (head.compare(0, 4, "GET ") == 0) text = body_();
+            else { status = "405 Method Not Allowed"; text = "GET only\n"; }
+
+            std::string resp = "HTTP/1.1 " + status + "\r\n"
+                               "Content-Type: text/plain; version=0.0.4\r\n"
+                               "Content-Length: " + std::to_string(text.size()) + "\r\n"
+                               "Connection: close\r\n\r\n" + text;
+            const char* p0 = resp.data();
+            size_t left = resp.size();
+            while (left > 0) {
+                ssize_t w = ::send(c, p0, left, MSG_NOSIGNAL);
+                if (w <= 0) break;
+                p0 += w;
+                left -= size_t(w);
+            }
+            ::close(c);
+        }
+    }
+
+} // namespace thermal
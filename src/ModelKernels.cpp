@@ -0,0 +1,230 @@
+#include "ModelKernels.h"
+#include "Colorize.h"
+#include "ModelTraits.h"
+#include "TempStats.h"
+#include <opencv2/core/utility.hpp>
+#include <algorithm>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define THERMAL_X86 1
+#endif
+
+namespace thermal {
+
+    namespace {
+
+        // — Fixed-size loops —
+        // Written once and inlined into a baseline and an AVX2 copy per
+        // resolution. With W and N constants and no early exits the
+        // compiler vectorizes them without a scalar tail.
+        template <int N>
+        inline __attribute__((always_inline))
+        void minMaxBody(const uint16_t* __restrict p, uint16_t& mn, uint16_t& mx) {
+            uint16_t a = UINT16_MAX, b = 0;
+            for (int i = 0; i < N; ++i) {
+                a = std::min(a, p[i]);
+                b = std::max(b, p[i]);
+            }
+            mn = a; mx = b;
+        }
+
+        // palette indices of a row first (branch-free, so it vectorizes),
+        // then the lookups
+        template <int W>
+        inline __attribute__((always_inline))
+        void colorizeRowsBody(const cv::Mat& raw16, cv::Mat& bgr, const uint8_t* lut,
+                              ColorRange r, int y0, int y1) {
+            alignas(32) uint8_t idx[W];
+            const uint16_t lo = r.lo;
+            const uint32_t span = r.span, scale = r.scale;
+            for (int y = y0; y < y1; ++y) {
+                const uint16_t* __restrict src = raw16.ptr<uint16_t>(y);
+                for (int x = 0; x < W; ++x) {
+                    uint32_t v = src[x] > lo ? uint32_t(src[x] - lo) : 0u;
+                    v = std::min(v, span);
+                    idx[x] = uint8_t(std::min((v * scale + 0x8000u) >> 16, 255u));
+                }
+                uint8_t* dst = bgr.ptr(y);
+                for (int x = 0; x < W; ++x) {
+                    const uint8_t* c = lut + idx[x] * 3;
+                    dst[3 * x]     = c[0];
+                    dst[3 * x + 1] = c[1];
+                    dst[3 * x + 2] = c[2];
+                }
+            }
+        }
+
+        // the model's temperature map to °C: TE_A an integer conversion and
+        // a scale, TE_B a copy
+        template <class Traits>
+        inline __attribute__((always_inline))
+        void celsiusBody(const typename Traits::Temp* __restrict p, float* __restrict out) {
+            for (int i = 0; i < Traits::pixels; ++i) out[i] = Traits::celsius(p[i]);
+        }
+
+        template <class Traits>
+        struct FixedLoops {
+            using Temp = typename Traits::Temp;
+            void (*minMax)(const uint16_t* p, uint16_t& mn, uint16_t& mx);
+            void (*colorizeRows)(const cv::Mat& raw16, cv::Mat& bgr, const uint8_t* lut,
+                                 ColorRange r, int y0, int y1);
+            void (*celsius)(const Temp* p, float* out);
+        };
+
+        // — Baseline —
+        template <int W, int H>
+        void minMaxBase(const uint16_t* p, uint16_t& mn, uint16_t& mx) {
+            minMaxBody<W * H>(p, mn, mx);
+        }
+        template <int W>
+        void colorizeRowsBase(const cv::Mat& raw16, cv::Mat& bgr, const uint8_t* lut,
+                              ColorRange r, int y0, int y1) {
+            colorizeRowsBody<W>(raw16, bgr, lut, r, y0, y1);
+        }
+        template <class Traits>
+        void celsiusBase(const typename Traits::Temp* p, float* out) {
+            celsiusBody<Traits>(p, out);
+        }
+
+#ifdef THERMAL_X86
+        // — AVX2 —
+        template <int W, int H>
+        __attribute__((target("avx2")))
+        void minMaxAvx2(const uint16_t* p, uint16_t& mn, uint16_t& mx) {
+            minMaxBody<W * H>(p, mn, mx);
+        }
+        template <int W>
+        __attribute__((target("avx2")))
+        void colorizeRowsAvx2(const cv::Mat& raw16, cv::Mat& bgr, const uint8_t* lut,
+                              ColorRange r, int y0, int y1) {
+            colorizeRowsBody<W>(raw16, bgr, lut, r, y0, y1);
+        }
+        template <class Traits>
+        __attribute__((target("avx2")))
+        void celsiusAvx2(const typename Traits::Temp* p, float* out) {
+            celsiusBody<Traits>(p, out);
+        }
+#endif
+
+        template <class Traits>
+        FixedLoops<Traits> loopsFor(SimdLevel level) {
+            constexpr int W = Traits::width, H = Traits::height;
+#ifdef THERMAL_X86
+            if (level == SimdLevel::AVX2)
+                return {minMaxAvx2<W, H>, colorizeRowsAvx2<W>, celsiusAvx2<Traits>};
+#endif
+            (void)level;
+            return {minMaxBase<W, H>, colorizeRowsBase<W>, celsiusBase<Traits>};
+        }
+
+        // TE_A °C * 100 + 5000 or TE_B °C, whatever the size
+        void genericCelsius(const cv::Mat& native, cv::Mat& out) {
+            if (native.type() == CV_16U) native.convertTo(out, CV_32F, 0.01, -50.0);
+            else                         native.copyTo(out);
+        }
+
+        const char* familyName(DeviceFamily f) {
+            return f == DeviceFamily::TE_A ? "TE_A" : "TE_B";
+        }
+
+        // — Kernel sets —
+        template <class Traits>
+        class FixedKernels : public ModelKernels {
+            public:
+                static constexpr int W = Traits::width, H = Traits::height;
+
+                FixedKernels()
+                    : loops_(loopsFor<Traits>(detectSimdLevel())),
+                      name_(std::string(familyName(Traits::family)) + " " +
+                            std::to_string(W) + "x" + std::to_string(H)) {}
+
+                const char* name() const override { return name_.c_str(); }
+                bool fixedSize() const override { return true; }
+
+                void colorize(const cv::Mat& raw16, cv::Mat& bgr, int palette,
+                              bool applyAgc) const override {
+                    if (raw16.type() != CV_16U || raw16.cols != W || raw16.rows != H ||
+                        !raw16.isContinuous()) {
+                        colorize16(raw16, bgr, palette, applyAgc);
+                        return;
+                    }
+                    uint16_t mn = 0, mx = 0;
+                    if (!applyAgc) loops_.minMax(raw16.ptr<uint16_t>(), mn, mx);
+                    const ColorRange range = applyAgc ? colorRange(raw16, true)
+                                                      : colorRange(mn, mx);
+                    const uint8_t* lut = paletteLut(palette);
+                    if (bgr.rows != H || bgr.cols != W || bgr.type() != CV_8UC3)
+                        bgr.create(H, W, CV_8UC3);
+
+                    if (Traits::pixels < COLORIZE_PARALLEL_MIN_PIXELS) {
+                        loops_.colorizeRows(raw16, bgr, lut, range, 0, H);
+                        return;
+                    }
+                    cv::parallel_for_(cv::Range(0, H), [&](const cv::Range& r) {
+                        loops_.colorizeRows(raw16, bgr, lut, range, r.start, r.end);
+                    });
+                }
+
+                void celsius(const cv::Mat& native, cv::Mat& out) const override {
+                    // a strided view given as `out` keeps its storage that way
+                    if (native.type() != Traits::tempType || native.cols != W ||
+                        native.rows != H || !native.isContinuous() ||
+                        (!out.empty() && !out.isContinuous())) {
+                        genericCelsius(native, out);
+                        return;
+                    }
+                    if (out.rows != H || out.cols != W || out.type() != CV_32F ||
+                        !out.isContinuous())
+                        out.create(H, W, CV_32F);
+                    // in place for TE_B: already °C
+                    if (out.data == native.data) return;
+                    loops_.celsius(native.ptr<typename Traits::Temp>(), out.ptr<float>());
+                }
+
+            private:
+                FixedLoops<Traits> loops_;
+                std::string        name_;
+            };
+
+        class GenericKernels : public ModelKernels {
+            public:
+                const char* name() const override { return "generic"; }
+                bool fixedSize() const override { return false; }
+
+                void colorize(const cv::Mat& raw16, cv::Mat& bgr, int palette,
+                              bool applyAgc) const override {
+                    colorize16(raw16, bgr, palette, applyAgc);
+                }
+
+                void celsius(const cv::Mat& native, cv::Mat& out) const override {
+                    genericCelsius(native, out);
+                }
+            };
+
+        template <class Traits>
+        bool matches(DeviceFamily family, int width, int height) {
+            return family == Traits::family && width == Traits::width &&
+                   height == Traits::height;
+        }
+
+    } // namespace
+
+    const ModelKernels& modelKernels(DeviceFamily family, int width, int height) {
+        static const FixedKernels<TraitsEQ1> qvgaA;     // EQ1, EQ2
+        static const FixedKernels<TraitsEV1> vgaA;      // EV1, EV2
+        static const FixedKernels<TraitsQ1>  qvgaB;     // Q1, Q2
+        static const FixedKernels<TraitsV1>  vgaB;      // V1
+        if (matches<TraitsEQ1>(family, width, height)) return qvgaA;
+        if (matches<TraitsEV1>(family, width, height)) return vgaA;
+        if (matches<TraitsQ1>(family, width, height))  return qvgaB;
+        if (matches<TraitsV1>(family, width, height))  return vgaB;
+        return genericKernels();
+    }
+
+    const ModelKernels& genericKernels() {
+        static const GenericKernels generic;
+        return generic;
+    }
+
+} // namespace thermal
@@ -0,0 +1,511 @@
+#include "Recording.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace thermal {
+
+    namespace {
+        const char     HEADER_MAGIC[4] = {'H', 'K', 'R', 'C'};
+        const char     CHUNK_MAGIC[4]  = {'H', 'K', 'C', 'K'};
+        const char     INDEX_MAGIC[4]  = {'H', 'K', 'I', 'X'};
+        const uint32_t FORMAT_VERSION  = 1;
+        const size_t   BLOCK           = 64;
+        // far beyond any sensor; keeps a bad header's layout from wrapping
+        const int32_t  MAX_SIDE        = 1 << 14;
+        const uint32_t REC_HAS_TEMP    = 1;
+        // a partly filled batch is written after this long
+        const std::chrono::milliseconds FLUSH_INTERVAL(1000);
+
+        struct FileHeader {
+            char     magic[4];
+            uint32_t version;
+            int32_t  width, height, rawType, tempType;
+            uint32_t agc, serial;
+            float    emissivity;
+            uint32_t recordBytes;
+            double   fps;
+            int64_t  startWallNs;   // system_clock, when recording began
+            uint8_t  reserved[8];
+        };
+        struct ChunkHeader {
+            char     magic[4];
+            uint32_t frames;
+            uint8_t  reserved[56];
+        };
+        // a record is this header padded to BLOCK, the raw frame, then the
+        // temperature map, each padded to BLOCK
+        struct RecordHeader {
+            uint64_t sequence;
+            int64_t  timestampNs;   // steady_clock
+            uint64_t dropped;
+            float    fpaTemp;
+            uint32_t flags;
+        };
+        struct Trailer {
+            char     magic[4];
+            uint32_t version;
+            uint64_t indexOffset;
+            uint64_t count;
+            uint8_t  reserved[40];
+        };
+        static_assert(sizeof(FileHeader)  == BLOCK, "header must be one block");
+        static_assert(sizeof(ChunkHeader) == BLOCK, "chunk header must be one block");
+        static_assert(sizeof(Trailer)     == BLOCK, "trailer must be one block");
+        static_assert(sizeof(RecordHeader) <= BLOCK, "record header must fit a block");
+
+        size_t blocks(size_t n) { return (n + BLOCK - 1) / BLOCK * BLOCK; }
+
+        size_t elemBytes(int type) {
+            return type == CV_32F ? 4 : type == CV_16U ? 2 : 0;
+        }
+
+        // record layout for a given meta: offsets of the two planes, total
+        struct Layout {
+            size_t rawBytes, tempBytes, tempOffset, recordBytes;
+        };
+        Layout layoutOf(const RecordingMeta& m) {
+            Layout l;
+            size_t px   = size_t(m.width) * m.height;
+            l.rawBytes  = px * elemBytes(m.rawType);
+            l.tempBytes = m.tempType >= 0 ? px * elemBytes(m.tempType) : 0;
+            l.tempOffset  = BLOCK + blocks(l.rawBytes);
+            l.recordBytes = l.tempOffset + blocks(l.tempBytes);
+            return l;
+        }
+
+        // copy a (possibly strided) Mat into a packed plane
+        void pack(const cv::Mat& m, unsigned char* dst) {
+            const size_t row = size_t(m.cols) * elemBytes(m.type());
+            for (int y = 0; y < m.rows; ++y)
+                std::memcpy(dst + y * row, m.ptr(y), row);
+        }
+
+        bool writeAll(int fd, const void* data, size_t n) {
+            const char* p = static_cast<const char*>(data);
+            while (n) {
+                ssize_t k = ::write(fd, p, n);
+                if (k < 0) {
+                    if (errno == EINTR) continue;
+                    return false;
+                }
+                p += k;
+                n -= size_t(k);
+            }
+            return true;
+        }
+
+        int64_t steadyNs(std::chrono::steady_clock::time_point t) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                t.time_since_epoch()).count();
+        }
+    }
+
+
+    // — RecordingWriter —
+    RecordingWriter::~RecordingWriter() {
+        close();
+    }
+
+    bool RecordingWriter::open(const std::string& path, const RecordingMeta& meta,
+                               size_t batchBytes, size_t maxQueued) {
+        close();
+        if (meta.width <= 0 || meta.height <= 0 || !elemBytes(meta.rawType)) {
+            std::cerr << "[ERROR] recording: unsupported frame format\n";
+            return false;
+        }
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) {
+            std::cerr << "[ERROR] recording: cannot create " << path << ": "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+
+        meta_        = meta;
+        recordBytes_ = layoutOf(meta).recordBytes;
+        maxQueued_   = maxQueued ? maxQueued : 1;
+
+        FileHeader h{};
+        std::memcpy(h.magic, HEADER_MAGIC, 4);
+        h.version     = FORMAT_VERSION;
+        h.width       = meta.width;
+        h.height      = meta.height;
+        h.rawType     = meta.rawType;
+        h.tempType    = meta.tempType;
+        h.agc         = meta.agc;
+        h.serial      = meta.serial;
+        h.emissivity  = meta.emissivity;
+        h.recordBytes = uint32_t(recordBytes_);
+        h.fps         = meta.fps;
+        h.startWallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        if (!writeAll(fd_, &h, sizeof(h))) {
+            std::cerr << "[ERROR] recording: header write failed\n";
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+
+        // every batch holds at least one record; zeroed once, so padding
+        // only ever contains zeros or bytes of an earlier frame
+        batch_.assign(std::max(batchBytes, BLOCK + recordBytes_), 0);
+        batchUsed_   = BLOCK;       // room for the chunk header
+        batchFrames_ = 0;
+        offset_      = sizeof(h);
+        index_.clear();
+        queued_ = written_ = dropped_ = chunks_ = 0;
+        bytes_  = sizeof(h);
+        failed_ = false;
+        stopping_ = false;
+        thread_ = std::thread(&RecordingWriter::writerLoop, this);
+        return true;
+    }
+
+    void RecordingWriter::close() {
+        if (fd_ < 0) return;
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        if (thread_.joinable()) thread_.join();
+
+        if (!failed_) {
+            Trailer t{};
+            std::memcpy(t.magic, INDEX_MAGIC, 4);
+            t.version     = FORMAT_VERSION;
+            t.indexOffset = offset_;
+            t.count       = index_.size();
+            bool ok = writeAll(fd_, index_.data(), index_.size() * sizeof(IndexEntry))
+                   && writeAll(fd_, &t, sizeof(t));
+            if (ok) bytes_ += index_.size() * sizeof(IndexEntry) + sizeof(t);
+            else std::cerr << "[ERROR] recording: index write failed\n";
+        }
+        ::close(fd_);
+        fd_ = -1;
+        queue_.clear();
+        index_.clear();
+        index_.shrink_to_fit();
+        batch_.clear();
+        batch_.shrink_to_fit();
+    }
+
+    bool RecordingWriter::write(const Frame& f) {
+        if (fd_ < 0 || f.empty() || failed_) return false;
+        // the map has to be read before the source moves on
+        if (meta_.tempType >= 0) f.temperatureRaw();
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            if (queue_.size() >= maxQueued_) {
+                ++dropped_;
+                return false;
+            }
+            queue_.push_back(f);
+        }
+        ++queued_;
+        cv_.notify_one();
+        return true;
+    }
+
+    RecorderStats RecordingWriter::stats() const {
+        return {queued_, written_, dropped_, bytes_, chunks_, failed_};
+    }
+
+    void RecordingWriter::writerLoop() {
+        auto lastFlush = std::chrono::steady_clock::now();
+        std::unique_lock<std::mutex> lk(mutex_);
+        for (;;) {
+            cv_.wait_for(lk, FLUSH_INTERVAL,
+                         [this] { return stopping_ || !queue_.empty(); });
+            while (!queue_.empty()) {
+                Frame f = std::move(queue_.front());
+                queue_.pop_front();
+                lk.unlock();
+                uint64_t before = chunks_;
+                append(f);
+                f = Frame();    // buffers back to the pool before we sleep
+                if (chunks_ != before) lastFlush = std::chrono::steady_clock::now();
+                lk.lock();
+            }
+            if (stopping_) break;
+            auto now = std::chrono::steady_clock::now();
+            if (batchFrames_ && now - lastFlush >= FLUSH_INTERVAL) {
+                lk.unlock();
+                flush();
+                lastFlush = now;
+                lk.lock();
+            }
+        }
+        lk.unlock();
+        flush();
+    }
+
+    void RecordingWriter::append(const Frame& f) {
+        if (failed_) return;
+        const cv::Mat& raw = f.raw();
+        if (raw.rows != meta_.height || raw.cols != meta_.width ||
+            raw.type() != meta_.rawType) {
+            ++dropped_;     // not the format this recording was opened for
+            return;
+        }
+        if (batchUsed_ + recordBytes_ > batch_.size()) flush();
+        if (failed_) return;
+
+        const Layout l = layoutOf(meta_);
+        unsigned char* rec = reinterpret_cast<unsigned char*>(batch_.data()) + batchUsed_;
+        const FrameInfo& info = f.info();
+        RecordHeader h{info.sequence, steadyNs(info.timestamp), info.dropped,
+                       info.fpaTemp, 0};
+        pack(raw, rec + BLOCK);
+        if (meta_.tempType >= 0) {
+            const cv::Mat& t = f.temperatureRaw();
+            if (t.rows == meta_.height && t.cols == meta_.width &&
+                t.type() == meta_.tempType) {
+                pack(t, rec + l.tempOffset);
+                h.flags |= REC_HAS_TEMP;
+            } else {
+                std::memset(rec + l.tempOffset, 0, l.tempBytes);
+            }
+        }
+        std::memcpy(rec, &h, sizeof(h));
+
+        index_.push_back({offset_ + batchUsed_, h.timestampNs});
+        batchUsed_ += recordBytes_;
+        ++batchFrames_;
+    }
+
+    void RecordingWriter::flush() {
+        if (!batchFrames_ || failed_) return;
+        ChunkHeader c{};
+        std::memcpy(c.magic, CHUNK_MAGIC, 4);
+        c.frames = batchFrames_;
+        std::memcpy(batch_.data(), &c, sizeof(c));
+
+        if (writeAll(fd_, batch_.data(), batchUsed_)) {
+            offset_  += batchUsed_;
+            bytes_   += batchUsed_;
+            written_ += batchFrames_;
+            ++chunks_;
+        } else {
+            std::cerr << "[ERROR] recording: write failed: "
+                      << std::strerror(errno) << "\n";
+            index_.resize(index_.size() - batchFrames_);
+            failed_ = true;
+        }
+        batchUsed_   = BLOCK;
+        batchFrames_ = 0;
+    }
+
+
+    // — RecordingReader —
+    RecordingReader::~RecordingReader() {
+        close();
+    }
+
+    bool RecordingReader::open(const std::string& path) {
+        close();
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            std::cerr << "[ERROR] recording: cannot open " << path << "\n";
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd_, &st) != 0 || size_t(st.st_size) < sizeof(FileHeader)) {
+            close();
+            return false;
+        }
+        size_ = size_t(st.st_size);
+        // private + writable: Mats handed out are zero-copy, and writing
+        // into one only copies that page instead of faulting
+        void* p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) {
+            close();
+            return false;
+        }
+        base_ = static_cast<const unsigned char*>(p);
+        madvise(p, size_, MADV_SEQUENTIAL);
+
+        FileHeader h;
+        std::memcpy(&h, base_, sizeof(h));
+        if (std::memcmp(h.magic, HEADER_MAGIC, 4) != 0 || h.version != FORMAT_VERSION) {
+            std::cerr << "[ERROR] recording: " << path << " is not a recording\n";
+            close();
+            return false;
+        }
+        meta_ = {h.width, h.height, h.rawType, h.tempType, h.agc != 0,
+                 h.serial, h.emissivity, h.fps};
+        recordBytes_ = h.recordBytes;
+        if (meta_.width <= 0 || meta_.height <= 0 ||
+            meta_.width > MAX_SIDE || meta_.height > MAX_SIDE || !elemBytes(meta_.rawType) ||
+            (meta_.tempType >= 0 && !elemBytes(meta_.tempType)) ||
+            recordBytes_ != layoutOf(meta_).recordBytes) {
+            std::cerr << "[ERROR] recording: " << path << " has a bad header\n";
+            close();
+            return false;
+        }
+
+        // a finished file ends with its index; one that doesn't add up is
+        // ignored and rebuilt below like a missing one
+        auto indexFits = [this](const Trailer& t) {
+            if (t.indexOffset < BLOCK || t.indexOffset % alignof(IndexEntry) != 0 ||
+                t.indexOffset > size_ - sizeof(t))
+                return false;
+            const uint64_t room = size_ - sizeof(t) - t.indexOffset;
+            // bounded before multiplying, so a bad count can't wrap
+            if (t.count > room / sizeof(IndexEntry) ||
+                t.count * sizeof(IndexEntry) != room)
+                return false;
+            // every record lies between the header and the index
+            const IndexEntry* e = reinterpret_cast<const IndexEntry*>(base_ + t.indexOffset);
+            for (uint64_t i = 0; i < t.count; ++i)
+                if (e[i].offset < BLOCK || e[i].offset > t.indexOffset ||
+                    recordBytes_ > t.indexOffset - e[i].offset)
+                    return false;
+            return true;
+        };
+        if (size_ >= 2 * BLOCK) {
+            Trailer t;
+            std::memcpy(&t, base_ + size_ - sizeof(t), sizeof(t));
+            if (std::memcmp(t.magic, INDEX_MAGIC, 4) == 0 && indexFits(t)) {
+                index_    = reinterpret_cast<const IndexEntry*>(base_ + t.indexOffset);
+                count_    = size_t(t.count);
+                complete_ = true;
+                return true;
+            }
+        }
+
+        // cut short: walk the chunks that made it to disk
+        std::cerr << "[WARN] recording: " << path
+                  << " has no usable index, rebuilding it\n";
+        size_t off = BLOCK;
+        while (off + BLOCK <= size_) {
+            ChunkHeader c;
+            std::memcpy(&c, base_ + off, sizeof(c));
+            if (std::memcmp(c.magic, CHUNK_MAGIC, 4) != 0) break;
+            // bounded before multiplying, so a bad count can't wrap
+            if (c.frames > (size_ - off - BLOCK) / recordBytes_) break;
+            size_t end = off + BLOCK + size_t(c.frames) * recordBytes_;
+            for (uint32_t k = 0; k < c.frames; ++k) {
+                size_t r = off + BLOCK + k * recordBytes_;
+                RecordHeader rh;
+                std::memcpy(&rh, base_ + r, sizeof(rh));
+                rebuilt_.push_back({r, rh.timestampNs});
+            }
+            off = end;
+        }
+        count_ = rebuilt_.size();
+        return true;
+    }
+
+    void RecordingReader::close() {
+        if (base_) munmap(const_cast<unsigned char*>(base_), size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+        base_ = nullptr;
+        size_ = 0;
+        index_ = nullptr;
+        rebuilt_.clear();
+        count_ = 0;
+        complete_ = false;
+    }
+
+    bool RecordingReader::frame(size_t i, cv::Mat& raw, cv::Mat& temp,
+                                FrameInfo& info) const {
+        if (i >= count_) return false;
+        unsigned char* rec = const_cast<unsigned char*>(base_) + entry(i).offset;
+        RecordHeader h;
+        std::memcpy(&h, rec, sizeof(h));
+
+        raw = cv::Mat(meta_.height, meta_.width, meta_.rawType, rec + BLOCK);
+        if (h.flags & REC_HAS_TEMP)
+            temp = cv::Mat(meta_.height, meta_.width, meta_.tempType,
+                           rec + layoutOf(meta_).tempOffset);
+        else
+            temp = cv::Mat();
+        info.sequence  = h.sequence;
+        info.timestamp = std::chrono::steady_clock::time_point(
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::nanoseconds(h.timestampNs)));
+        info.dropped   = h.dropped;
+        info.fpaTemp   = h.fpaTemp;
+        return true;
+    }
+
+    size_t RecordingReader::seek(double seconds) const {
+        if (!count_) return 0;
+        const int64_t target = entry(0).timestampNs + int64_t(seconds * 1e9);
+        size_t lo = 0, hi = count_;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (entry(mid).timestampNs < target) lo = mid + 1;
+            else                                 hi = mid;
+        }
+        return lo;
+    }
+
+
+    // — ReplaySource —
+    ReplaySource::ReplaySource(std::shared_ptr<RecordingReader> reader,
+                               double speed, bool loop)
+        : reader_(std::move(reader)), speed_(speed), loop_(loop),
+          fpa_(std::numeric_limits<float>::quiet_NaN()) {}
+
+    int ReplaySource::read(cv::Mat& dst, bool) {
+        // the recording is replayed as recorded, AGC or not
+        const size_t n = reader_->frameCount();
+        if (next_ >= n) {
+            if (!loop_ || n == 0) return 4;
+            next_ = 0;
+            restart_ = true;
+        }
+        cv::Mat raw, temp;
+        FrameInfo info;
+        if (!reader_->frame(next_, raw, temp, info)) return 4;
+
+        if (speed_ > 0) {
+            const int64_t ts = steadyNs(info.timestamp);
+            if (restart_) {
+                wallStart_  = std::chrono::steady_clock::now();
+                recStartNs_ = ts;
+                restart_    = false;
+            }
+            std::this_thread::sleep_until(wallStart_ +
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double, std::nano>((ts - recStartNs_) / speed_)));
+        }
+
+        raw.copyTo(dst);
+        temp_ = temp;
+        fpa_  = info.fpaTemp;
+        ++next_;
+        return 1;
+    }
+
+    bool ReplaySource::readTemperature(cv::Mat& dst) {
+        if (temp_.empty()) return false;
+        temp_.copyTo(dst);
+        return true;
+    }
+
+    bool ReplaySource::temperatureAt(int x, int y, float& celsius) {
+        if (temp_.empty() || x < 0 || y < 0 || x >= temp_.cols || y >= temp_.rows)
+            return false;
+        if (temp_.type() == CV_16U)
+            celsius = (int(temp_.ptr<uint16_t>(y)[x]) - 5000) * 0.01f;
+        else
+            celsius = temp_.ptr<float>(y)[x];
+        return true;
+    }
+
+    void ReplaySource::seekFrame(size_t i) {
+        next_ = std::min(i, reader_->frameCount());
+        temp_ = cv::Mat();
+        restart_ = true;
+    }
+
+} // namespace thermal
@@ -0,0 +1,236 @@
+#include "RoiEngine.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace thermal {
+
+    namespace {
+        struct Acc {
+            float     mn = FLT_MAX, mx = -FLT_MAX;
+            double    sum = 0;
+            int       n = 0;
+            cv::Point mnLoc, mxLoc;
+
+            void add(int x, int y, float v) {
+                if (v < mn) { mn = v; mnLoc = cv::Point(x, y); }
+                if (v > mx) { mx = v; mxLoc = cv::Point(x, y); }
+                sum += v;
+                ++n;
+            }
+            void merge(const Acc& o) {
+                if (!o.n) return;
+                if (o.mn < mn) { mn = o.mn; mnLoc = o.mnLoc; }
+                if (o.mx > mx) { mx = o.mx; mxLoc = o.mxLoc; }
+                sum += o.sum;
+                n   += o.n;
+            }
+            RoiStats stats(int id, RoiType type) const {
+                if (!n) return {id, type, 0.f, 0.f, 0.f, cv::Point(), cv::Point(), 0};
+                return {id, type, mn, mx, float(sum / n), mnLoc, mxLoc, n};
+            }
+        };
+    }
+
+    // — RoiSet —
+    template <typename Get>
+    std::vector<RoiStats> RoiSet::run(Get get, int width, int height) const {
+        const cv::Rect frame(0, 0, width, height);
+
+        // every pixel under a rectangle is read exactly once
+        std::vector<Acc> cells(cells_.size());
+        for (size_t c = 0; c < cells_.size(); ++c) {
+            cv::Rect r = cells_[c] & frame;
+            for (int y = r.y; y < r.y + r.height; ++y)
+                for (int x = r.x; x < r.x + r.width; ++x)
+                    cells[c].add(x, y, get(x, y));
+        }
+
+        std::vector<RoiStats> out;
+        out.reserve(rois_.size());
+        for (const Roi& roi : rois_) {
+            Acc a;
+            switch (roi.type) {
+                case RoiType::Spot:
+                    if (frame.contains(roi.box.tl()))
+                        a.add(roi.box.x, roi.box.y, get(roi.box.x, roi.box.y));
+                    break;
+                case RoiType::Rect:
+                    for (int c : roi.cells) a.merge(cells[c]);
+                    break;
+                case RoiType::Polygon:
+                    for (const Span& s : roi.spans) {
+                        if (s.y < 0 || s.y >= height) continue;
+                        int x1 = std::min(s.x1, width);
+                        for (int x = std::max(s.x0, 0); x < x1; ++x)
+                            a.add(x, s.y, get(x, s.y));
+                    }
+                    break;
+            }
+            out.push_back(a.stats(roi.id, roi.type));
+        }
+        return out;
+    }
+
+    std::vector<RoiStats> RoiSet::measure(const cv::Mat& temp) const {
+        if (temp.type() == CV_16U) {
+            return run([&temp](int x, int y) {
+                // (value - 5000) / 100, only for pixels a ROI covers
+                return (int(temp.ptr<uint16_t>(y)[x]) - 5000) * 0.01f;
+            }, temp.cols, temp.rows);
+        }
+        if (temp.type() == CV_32F) {
+            return run([&temp](int x, int y) {
+                return temp.ptr<float>(y)[x];
+            }, temp.cols, temp.rows);
+        }
+        // no map: every ROI comes back empty
+        return run([](int, int) { return 0.f; }, 0, 0);
+    }
+
+    std::vector<RoiStats> RoiSet::measure(const TempAtFn& tempAt,
+                                          int width, int height) const {
+        return run(tempAt, width, height);
+    }
+
+
+    // — RoiEngine —
+    int RoiEngine::addSpot(cv::Point p) {
+        return add(RoiType::Spot, {p});
+    }
+
+    int RoiEngine::addRect(cv::Rect r) {
+        if (r.width <= 0 || r.height <= 0) return -1;
+        return add(RoiType::Rect, {r.tl(), r.br()});
+    }
+
+    int RoiEngine::addPolygon(const std::vector<cv::Point>& pts) {
+        if (pts.size() < 3) return -1;
+        return add(RoiType::Polygon, pts);
+    }
+
+    int RoiEngine::add(RoiType type, std::vector<cv::Point> pts) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        int id = nextId_++;
+        defs_.push_back({id, type, std::move(pts)});
+        rebuild();
+        return id;
+    }
+
+    bool RoiEngine::remove(int id) {
+        std::lock_guard<std::mutex> lk(mutex_);
+        auto it = std::find_if(defs_.begin(), defs_.end(),
+                               [id](const Def& d) { return d.id == id; });
+        if (it == defs_.end()) return false;
+        defs_.erase(it);
+        rebuild();
+        return true;
+    }
+
+    void RoiEngine::clear() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        defs_.clear();
+        compiled_.reset();
+    }
+
+    bool RoiEngine::empty() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return defs_.empty();
+    }
+
+    std::shared_ptr<const RoiSet> RoiEngine::snapshot() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return compiled_;
+    }
+
+    namespace {
+        // pixels whose centre lies inside the polygon (even-odd rule), so a
+        // polygon tracing a cv::Rect's corners covers exactly that rect
+        template <typename Span>
+        std::vector<Span> rasterize(const std::vector<cv::Point>& pts) {
+            std::vector<Span> spans;
+            cv::Rect box = cv::boundingRect(pts);
+            std::vector<double> xs;
+            const size_t n = pts.size();
+            for (int y = box.y; y < box.y + box.height; ++y) {
+                const double cy = y + 0.5;
+                xs.clear();
+                for (size_t i = 0; i < n; ++i) {
+                    const cv::Point& a = pts[i];
+                    const cv::Point& b = pts[(i + 1) % n];
+                    if ((a.y <= cy) == (b.y <= cy)) continue;
+                    xs.push_back(a.x + (cy - a.y) * (b.x - a.x) / double(b.y - a.y));
+                }
+                std::sort(xs.begin(), xs.end());
+                for (size_t i = 0; i + 1 < xs.size(); i += 2) {
+                    int x0 = int(std::ceil(xs[i] - 0.5));
+                    int x1 = int(std::floor(xs[i + 1] - 0.5)) + 1;
+                    if (x1 > x0) spans.push_back({y, x0, x1});
+                }
+            }
+            return spans;
+        }
+    }
+
+    void RoiEngine::rebuild() {
+        if (defs_.empty()) { compiled_.reset(); return; }
+        auto set = std::make_shared<RoiSet>();
+
+        // Cut the plane along every rectangle edge; each resulting cell is
+        // either fully inside or fully outside any given rectangle.
+        std::vector<int> xs, ys;
+        for (const Def& d : defs_) {
+            if (d.type != RoiType::Rect) continue;
+            xs.push_back(d.pts[0].x); xs.push_back(d.pts[1].x);
+            ys.push_back(d.pts[0].y); ys.push_back(d.pts[1].y);
+        }
+        std::sort(xs.begin(), xs.end());
+        xs.erase(std::unique(xs.begin(), xs.end()), xs.end());
+        std::sort(ys.begin(), ys.end());
+        ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+        // grid cell -> index into cells_, created on first use
+        const size_t gw = xs.empty() ? 0 : xs.size() - 1;
+        std::vector<int> grid(gw * (ys.empty() ? 0 : ys.size() - 1), -1);
+
+        for (const Def& d : defs_) {
+            RoiSet::Roi roi{d.id, d.type, cv::Rect(), {}, {}};
+            switch (d.type) {
+                case RoiType::Spot:
+                    roi.box = cv::Rect(d.pts[0], cv::Size(1, 1));
+                    set->pixels_ += 1;
+                    break;
+                case RoiType::Rect: {
+                    roi.box = cv::Rect(d.pts[0], d.pts[1]);
+                    size_t i0 = std::lower_bound(xs.begin(), xs.end(), d.pts[0].x) - xs.begin();
+                    size_t i1 = std::lower_bound(xs.begin(), xs.end(), d.pts[1].x) - xs.begin();
+                    size_t j0 = std::lower_bound(ys.begin(), ys.end(), d.pts[0].y) - ys.begin();
+                    size_t j1 = std::lower_bound(ys.begin(), ys.end(), d.pts[1].y) - ys.begin();
+                    for (size_t j = j0; j < j1; ++j) {
+                        for (size_t i = i0; i < i1; ++i) {
+                            int& c = grid[j * gw + i];
+                            if (c < 0) {
+                                c = int(set->cells_.size());
+                                set->cells_.emplace_back(cv::Point(xs[i], ys[j]),
+                                                         cv::Point(xs[i + 1], ys[j + 1]));
+                                set->pixels_ += set->cells_.back().area();
+                            }
+                            roi.cells.push_back(c);
+                        }
+                    }
+                    break;
+                }
+                case RoiType::Polygon:
+                    roi.box   = cv::boundingRect(d.pts);
+                    roi.spans = rasterize<RoiSet::Span>(d.pts);
+                    for (const RoiSet::Span& s : roi.spans)
+                        set->pixels_ += s.x1 - s.x0;
+                    break;
+            }
+            set->rois_.push_back(std::move(roi));
+        }
+        set->sparse_ = set->pixels_ <= SPARSE_LIMIT;
+        compiled_ = std::move(set);
+    }
+
+} // namespace thermal
@@ -0,0 +1,125 @@
+#include "DeviceBackend.h"
+#include "i3system_TE.h"
+
+namespace thermal {
+
+    namespace {
+        // EQ1/EV1/EQ2/EV2
+        class TeABackend : public DeviceBackend {
+            public:
+                // the resolution can't change while open: asked once
+                explicit TeABackend(i3::TE_A* te)
+                    : te_(te), w_(te->GetImageWidth()), h_(te->GetImageHeight()) {}
+                ~TeABackend() override { te_->CloseTE(); }
+
+                DeviceFamily family() const override { return DeviceFamily::TE_A; }
+                int width() const override  { return w_; }
+                int height() const override { return h_; }
+                double nominalFps() const override {
+                    i3::TE_SETTING setting{};
+                    te_->GetSetting(&setting);
+                    return setting.frameRate;
+                }
+
+                int read(cv::Mat& dst, bool applyAgc) override {
+                    return te_->RecvImage(dst.ptr<unsigned short>(), applyAgc);
+                }
+                bool readTemperature(cv::Mat& dst) override {
+                    te_->CalcTemp(dst.ptr<unsigned short>());
+                    return true;
+                }
+                bool temperatureAt(int x, int y, float& celsius) override {
+                    celsius = (int(te_->CalcTemp((unsigned short)x,
+                                                 (unsigned short)y)) - 5000) / 100.f;
+                    return true;
+                }
+                float fpaTemperature() override { return te_->GetFpaTemp(); }
+
+                int  shutterCalibration() override { return te_->ShutterCalibrationOn(); }
+                bool saveCalibration(const std::string& path) override {
+                    return te_->SaveCalibration(path.c_str());
+                }
+                bool loadCalibration(const std::string& path) override {
+                    return te_->LoadCalibration(path.c_str());
+                }
+                void setEmissivity(float e) override { te_->SetEmissivity(e); }
+
+            private:
+                i3::TE_A* te_;
+                int       w_, h_;
+            };
+
+        // Q1/V1/Q2
+        class TeBBackend : public DeviceBackend {
+            public:
+                explicit TeBBackend(i3::TE_B* te)
+                    : te_(te), w_(te->GetImageWidth()), h_(te->GetImageHeight()) {}
+                ~TeBBackend() override { te_->CloseTE(); }
+
+                DeviceFamily family() const override { return DeviceFamily::TE_B; }
+                int width() const override  { return w_; }
+                int height() const override { return h_; }
+                // TE_B has no settings block: rate unknown
+
+                int read(cv::Mat& dst, bool applyAgc) override {
+                    return applyAgc ? te_->RecvImage(dst.ptr<unsigned short>())
+                                    : te_->RecvImage(dst.ptr<float>());
+                }
+                bool readTemperature(cv::Mat& dst) override {
+                    te_->CalcEntireTemp(dst.ptr<float>());
+                    return true;
+                }
+                bool temperatureAt(int x, int y, float& celsius) override {
+                    celsius = te_->CalcTemp(x, y);
+                    return true;
+                }
+                float fpaTemperature() override { return te_->GetFpaTemp(); }
+
+                int  shutterCalibration() override { return te_->ShutterCalibrationOn(); }
+                bool saveCalibration(const std::string& path) override {
+                    return te_->SaveCalibration(path.c_str());
+                }
+                bool loadCalibration(const std::string& path) override {
+                    return te_->LoadCalibration(path.c_str());
+                }
+                void setEmissivity(float e) override { te_->SetEmissivity(e); }
+
+            private:
+                i3::TE_B* te_;
+                int       w_, h_;
+            };
+    }
+
+    std::unique_ptr<DeviceBackend> openSdkBackend(int model, unsigned int devNum) {
+        if (model == 3) {
+            i3::TE_A* te = i3::OpenTE_A(devNum);
+            if (te) return std::unique_ptr<DeviceBackend>(new TeABackend(te));
+            return nullptr;
+        }
+        int product = model == 1 ? I3_TE_Q1
+                    : model == 2 ? I3_TE_V1
+                    : model == 4 ? I3_TE_Q2 : 0;
+        if (!product) return nullptr;
+        i3::TE_B* te = i3::OpenTE_B(product, devNum);
+        if (te) return std::unique_ptr<DeviceBackend>(new TeBBackend(te));
+        return nullptr;
+    }
+
+    std::vector<DeviceInfo> scanSdkDevices() {
+        i3::TEScanData devs[MAX_USB_NUM];
+        std::vector<DeviceInfo> list;
+        if (i3::ScanTE(devs) == 1) {
+            for (int i = 0; i < MAX_USB_NUM; ++i) {
+                if (devs[i].bDevCon) {
+                    list.push_back({
+                        static_cast<unsigned int>(i),
+                        devs[i].nProdVer,
+                        devs[i].nCoreID
+                    });
+                }
+            }
+        }
+        return list;
+    }
+
+} // namespace thermal
@@ -0,0 +1,369 @@
+#include "SharedFrameRing.h"
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace thermal {
+
+    namespace {
+        const char     RING_MAGIC[4]  = {'H', 'K', 'S', 'R'};
+        const uint32_t RING_VERSION   = 1;
+        const size_t   BLOCK          = 64;
+        const uint32_t SLOT_HAS_TEMP  = 1;
+        enum : uint32_t { RING_INIT = 0, RING_LIVE = 1, RING_CLOSED = 2 };
+
+        // the atomics below are shared between processes
+        static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                      std::atomic<uint32_t>::is_always_lock_free,
+                      "shared-memory atomics must be lock-free");
+
+        struct RingHeader {
+            char     magic[4];
+            uint32_t version;
+            int32_t  width, height, rawType, tempType;
+            uint32_t agc, serial;
+            float    emissivity;
+            uint32_t slots;
+            double   fps;
+            uint64_t slotBytes;
+            uint8_t  reserved[8];
+            // publisher-written, on their own cache line
+            alignas(BLOCK) std::atomic<uint32_t> state;
+            std::atomic<uint32_t> wake;     // futex word: bumped per frame
+            std::atomic<uint32_t> waiters;  // consumers blocked on `wake`
+            std::atomic<uint64_t> head;     // frames published so far
+        };
+        // each slot: this header padded to BLOCK, the raw frame, then the
+        // temperature map, each padded to BLOCK
+        struct SlotHeader {
+            // seqlock: 2k+1 while frame k is written, 2k+2 once it's there
+            std::atomic<uint64_t> seq;
+            uint64_t sequence;
+            int64_t  timestampNs;   // steady_clock; the same on the whole host
+            uint64_t dropped;
+            float    fpaTemp;
+            uint32_t flags;
+        };
+        static_assert(sizeof(RingHeader) == 2 * BLOCK, "header must be two blocks");
+        static_assert(sizeof(SlotHeader) <= BLOCK, "slot header must fit a block");
+
+        size_t blocks(size_t n) { return (n + BLOCK - 1) / BLOCK * BLOCK; }
+
+        size_t elemBytes(int type) {
+            return type == CV_32F ? 4 : type == CV_16U ? 2 : 0;
+        }
+
+        size_t tempOffset(const RecordingMeta& m) {
+            return BLOCK + blocks(size_t(m.width) * m.height * elemBytes(m.rawType));
+        }
+        size_t slotBytes(const RecordingMeta& m) {
+            size_t temp = m.tempType >= 0
+                        ? size_t(m.width) * m.height * elemBytes(m.tempType) : 0;
+            return tempOffset(m) + blocks(temp);
+        }
+
+        RingHeader* header(unsigned char* base) {
+            return reinterpret_cast<RingHeader*>(base);
+        }
+        SlotHeader* slot(unsigned char* base, uint64_t k) {
+            const RingHeader* h = header(base);
+            return reinterpret_cast<SlotHeader*>(
+                base + sizeof(RingHeader) + (k % h->slots) * h->slotBytes);
+        }
+
+        // copy a (possibly strided) Mat into a packed plane
+        void pack(const cv::Mat& m, unsigned char* dst) {
+            const size_t row = size_t(m.cols) * elemBytes(m.type());
+            for (int y = 0; y < m.rows; ++y)
+                std::memcpy(dst + y * row, m.ptr(y), row);
+        }
+
+        std::string shmName(const std::string& name) {
+            return name.empty() || name[0] == '/' ? name : "/" + name;
+        }
+
+        // shared (not process-private) futex on a word in the mapping
+        void futexWake(std::atomic<uint32_t>* word) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE,
+                    INT_MAX, nullptr, nullptr, 0);
+        }
+        void futexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs) {
+            timespec ts{timeoutMs / 1000, long(timeoutMs % 1000) * 1000000L};
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT,
+                    expected, timeoutMs >= 0 ? &ts : nullptr, nullptr, 0);
+        }
+    }
+
+
+    // — Publisher —
+    SharedFramePublisher::~SharedFramePublisher() {
+        close();
+    }
+
+    bool SharedFramePublisher::open(const std::string& name, const RecordingMeta& meta,
+                                    size_t slots) {
+        close();
+        if (meta.width <= 0 || meta.height <= 0 || !elemBytes(meta.rawType) ||
+            (meta.tempType >= 0 && !elemBytes(meta.tempType))) {
+            std::cerr << "[ERROR] shared ring: unsupported frame format\n";
+            return false;
+        }
+        if (slots < 2) slots = 2;
+        name_ = shmName(name);
+        // a ring left behind by a crashed publisher goes; consumers still
+        // mapping it keep their (closed) copy
+        shm_unlink(name_.c_str());
+        int fd = shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0) {
+            std::cerr << "[ERROR] shared ring: cannot create " << name_ << ": "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+        const size_t slotSize = slotBytes(meta);
+        size_ = sizeof(RingHeader) + slots * slotSize;
+        void* p = MAP_FAILED;
+        if (ftruncate(fd, off_t(size_)) == 0)
+            p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            std::cerr << "[ERROR] shared ring: cannot map " << name_ << ": "
+                      << std::strerror(errno) << "\n";
+            shm_unlink(name_.c_str());
+            size_ = 0;
+            return false;
+        }
+        base_ = static_cast<unsigned char*>(p);
+        meta_ = meta;
+
+        // the object starts zeroed: every slot seq 0, state RING_INIT
+        RingHeader* h = header(base_);
+        std::memcpy(h->magic, RING_MAGIC, 4);
+        h->version    = RING_VERSION;
+        h->width      = meta.width;
+        h->height     = meta.height;
+        h->rawType    = meta.rawType;
+        h->tempType   = meta.tempType;
+        h->agc        = meta.agc;
+        h->serial     = meta.serial;
+        h->emissivity = meta.emissivity;
+        h->slots      = uint32_t(slots);
+        h->fps        = meta.fps;
+        h->slotBytes  = slotSize;
+        h->state.store(RING_LIVE, std::memory_order_release);
+        return true;
+    }
+
+    void SharedFramePublisher::close() {
+        if (!base_) return;
+        RingHeader* h = header(base_);
+        h->state.store(RING_CLOSED, std::memory_order_seq_cst);
+        h->wake.fetch_add(1, std::memory_order_seq_cst);
+        futexWake(&h->wake);
+        munmap(base_, size_);
+        shm_unlink(name_.c_str());
+        base_ = nullptr;
+        size_ = 0;
+    }
+
+    bool SharedFramePublisher::publish(const Frame& f) {
+        if (!base_ || f.empty()) return false;
+        const cv::Mat& raw = f.raw();
+        if (raw.rows != meta_.height || raw.cols != meta_.width ||
+            raw.type() != meta_.rawType)
+            return false;
+
+        RingHeader* h = header(base_);
+        const uint64_t k = h->head.load(std::memory_order_relaxed);
+        SlotHeader* s = slot(base_, k);
+        unsigned char* data = reinterpret_cast<unsigned char*>(s);
+
+        s->seq.store(2 * k + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const FrameInfo& info = f.info();
+        s->sequence    = info.sequence;
+        s->timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            info.timestamp.time_since_epoch()).count();
+        s->dropped     = info.dropped;
+        s->fpaTemp     = info.fpaTemp;
+        s->flags       = 0;
+        pack(raw, data + BLOCK);
+        if (meta_.tempType >= 0) {
+            const cv::Mat& t = f.temperatureRaw();
+            if (t.rows == meta_.height && t.cols == meta_.width &&
+                t.type() == meta_.tempType) {
+                pack(t, data + tempOffset(meta_));
+                s->flags |= SLOT_HAS_TEMP;
+            }
+        }
+
+        s->seq.store(2 * k + 2, std::memory_order_release);
+        h->head.store(k + 1, std::memory_order_release);
+        // one store per frame; a syscall only if somebody is asleep
+        h->wake.fetch_add(1, std::memory_order_seq_cst);
+        if (h->waiters.load(std::memory_order_seq_cst)) futexWake(&h->wake);
+        return true;
+    }
+
+    SharedRingStats SharedFramePublisher::stats() const {
+        uint64_t n = base_ ? header(base_)->head.load(std::memory_order_relaxed) : 0;
+        return {n, 0, 0, 0};
+    }
+
+
+    // — Consumer —
+    SharedFrameConsumer::~SharedFrameConsumer() {
+        close();
+    }
+
+    bool SharedFrameConsumer::open(const std::string& name, bool fromOldest) {
+        close();
+        const std::string shm = shmName(name);
+        int fd = shm_open(shm.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            std::cerr << "[ERROR] shared ring: cannot open " << shm << ": "
+                      << std::strerror(errno) << "\n";
+            return false;
+        }
+        struct stat st;
+        void* p = MAP_FAILED;
+        if (fstat(fd, &st) == 0 && size_t(st.st_size) >= sizeof(RingHeader)) {
+            size_ = size_t(st.st_size);
+            p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            std::cerr << "[ERROR] shared ring: cannot map " << shm << "\n";
+            size_ = 0;
+            return false;
+        }
+        base_ = static_cast<unsigned char*>(p);
+
+        RingHeader* h = header(base_);
+        if (h->state.load(std::memory_order_acquire) == RING_INIT ||
+            std::memcmp(h->magic, RING_MAGIC, 4) != 0 || h->version != RING_VERSION) {
+            std::cerr << "[ERROR] shared ring: " << shm << " is not a frame ring\n";
+            close();
+            return false;
+        }
+        meta_ = {h->width, h->height, h->rawType, h->tempType, h->agc != 0,
+                 h->serial, h->emissivity, h->fps};
+        if (h->slots < 2 || h->slotBytes != slotBytes(meta_) ||
+            sizeof(RingHeader) + size_t(h->slots) * h->slotBytes > size_) {
+            std::cerr << "[ERROR] shared ring: " << shm << " has a bad layout\n";
+            close();
+            return false;
+        }
+
+        // the slot at head % slots may be mid-write, so the oldest complete
+        // frame is slots-1 back
+        const uint64_t head = h->head.load(std::memory_order_acquire);
+        cursor_ = fromOldest && head > h->slots - 1 ? head - (h->slots - 1)
+                : fromOldest ? 0 : head;
+        frames_ = overruns_ = lost_ = 0;
+        return true;
+    }
+
+    void SharedFrameConsumer::close() {
+        if (base_) munmap(base_, size_);
+        base_ = nullptr;
+        size_ = 0;
+    }
+
+    bool SharedFrameConsumer::closed() const {
+        return !base_ ||
+               header(base_)->state.load(std::memory_order_acquire) == RING_CLOSED;
+    }
+
+    bool SharedFrameConsumer::next(SharedFrame& f, int timeoutMs) {
+        if (!base_) return false;
+        RingHeader* h = header(base_);
+        const auto deadline = std::chrono::steady_clock::now() +
+                              std::chrono::milliseconds(timeoutMs);
+        for (;;) {
+            const uint64_t head = h->head.load(std::memory_order_acquire);
+            if (cursor_ < head) {
+                if (head - cursor_ > h->slots - 1) {
+                    // lapped: jump to the oldest frame that can't be mid-write
+                    const uint64_t oldest = head - (h->slots - 1);
+                    lost_ += oldest - cursor_;
+                    ++overruns_;
+                    cursor_ = oldest;
+                }
+                SlotHeader* s = slot(base_, cursor_);
+                const uint64_t s1 = s->seq.load(std::memory_order_acquire);
+                if (s1 != 2 * cursor_ + 2) {
+                    // overwritten since head was read: lapped after all
+                    ++overruns_;
+                    ++lost_;
+                    ++cursor_;
+                    continue;
+                }
+                unsigned char* data = reinterpret_cast<unsigned char*>(s);
+                f.info.sequence  = s->sequence;
+                f.info.timestamp = std::chrono::steady_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::nanoseconds(s->timestampNs)));
+                f.info.dropped   = s->dropped;
+                f.info.fpaTemp   = s->fpaTemp;
+                const uint32_t flags = s->flags;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s->seq.load(std::memory_order_relaxed) != s1) {
+                    ++overruns_;
+                    ++lost_;
+                    ++cursor_;
+                    continue;
+                }
+                f.raw = cv::Mat(meta_.height, meta_.width, meta_.rawType, data + BLOCK);
+                if (flags & SLOT_HAS_TEMP)
+                    f.temp = cv::Mat(meta_.height, meta_.width, meta_.tempType,
+                                     data + tempOffset(meta_));
+                else
+                    f.temp = cv::Mat();
+                f.index = cursor_++;
+                ++frames_;
+                return true;
+            }
+            if (h->state.load(std::memory_order_acquire) == RING_CLOSED) return false;
+
+            int waitMs = -1;
+            if (timeoutMs >= 0) {
+                auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (left <= 0) return false;
+                waitMs = int(left);
+            }
+            // register, then re-check: a frame published after `wake` was
+            // read sees us waiting and wakes us; one published before is
+            // visible in head
+            h->waiters.fetch_add(1, std::memory_order_seq_cst);
+            const uint32_t w = h->wake.load(std::memory_order_seq_cst);
+            if (h->head.load(std::memory_order_seq_cst) == head &&
+                h->state.load(std::memory_order_seq_cst) != RING_CLOSED)
+                futexWait(&h->wake, w, waitMs);
+            h->waiters.fetch_sub(1, std::memory_order_seq_cst);
+        }
+    }
+
+    bool SharedFrameConsumer::intact(const SharedFrame& f) const {
+        if (!base_) return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot(base_, f.index)->seq.load(std::memory_order_relaxed) ==
+               2 * f.index + 2;
+    }
+
+    SharedRingStats SharedFrameConsumer::stats() const {
+        uint64_t head = base_ ? header(base_)->head.load(std::memory_order_relaxed) : 0;
+        return {frames_, overruns_, lost_, head > cursor_ ? head - cursor_ : 0};
+    }
+
+} // namespace thermal
@@ -0,0 +1,329 @@
+#include "SimulatedDevice.h"
+#include "Hotplug.h"
+#include "i3system_TE.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+
+namespace thermal {
+
+    namespace {
+        const size_t NOISE_LEN = size_t(1) << 16;   // distinct per-frame offsets
+
+        // what the sensor reads without AGC for a scene temperature
+        inline float countsOf(float celsius) { return 8000.f + 40.f * celsius; }
+
+        // Everything that lives as long as the device stays plugged in.
+        struct SimDevice {
+            SimConfig          cfg;
+            std::atomic<bool>  present{true};
+            std::vector<float> background;  // °C, width x height
+            // °C; NOISE_LEN + width * height samples, so a frame's noise is
+            // one contiguous slice starting anywhere in the first NOISE_LEN
+            std::vector<float> noise;
+            float              agcLo, agcHi;
+            std::atomic<uint64_t> shutterCycles{0}, saves{0}, loads{0};
+
+            explicit SimDevice(const SimConfig& c) : cfg(c) {
+                const int w = cfg.width, h = cfg.height;
+                background.resize(size_t(w) * h);
+                const float norm = (w > 1 || h > 1) ? 1.f / float(w + h - 2 > 0 ? w + h - 2 : 1) : 0.f;
+                for (int y = 0; y < h; ++y)
+                    for (int x = 0; x < w; ++x)
+                        background[size_t(y) * w + x] = cfg.ambient + cfg.gradient * (x + y) * norm;
+
+                std::mt19937 rng(cfg.serial + 1);
+                std::normal_distribution<float> n(0.f, cfg.noise);
+                noise.resize(NOISE_LEN + background.size());
+                for (float& v : noise) v = cfg.noise > 0 ? n(rng) : 0.f;
+
+                // AGC stretches the scene's expected range over 16 bits
+                agcLo = cfg.ambient - 3 * cfg.noise - 1.f;
+                agcHi = cfg.ambient + cfg.gradient + 3 * cfg.noise + 1.f;
+                for (const SimHotSpot& s : cfg.spots) {
+                    agcLo = std::min(agcLo, s.celsius - 1.f);
+                    agcHi = std::max(agcHi, s.celsius + 1.f);
+                }
+            }
+        };
+
+        class SimBackend : public DeviceBackend {
+            public:
+                explicit SimBackend(std::shared_ptr<SimDevice> dev)
+                    : dev_(std::move(dev)),
+                      failuresLeft_(dev_->cfg.warmupFailures),
+                      period_(dev_->cfg.fps > 0
+                              ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double>(1.0 / dev_->cfg.fps))
+                              : std::chrono::steady_clock::duration::zero()),
+                      next_(std::chrono::steady_clock::now()),
+                      scene_(dev_->background.size()) {}
+
+                DeviceFamily family() const override { return dev_->cfg.family; }
+                int width() const override  { return dev_->cfg.width; }
+                int height() const override { return dev_->cfg.height; }
+                double nominalFps() const override { return dev_->cfg.fps; }
+                std::chrono::steady_clock::time_point nextFrameAt() const override {
+                    auto now = std::chrono::steady_clock::now();
+                    if (period_.count() <= 0 || failuresLeft_ > 0) return now;
+                    return std::max(now, next_ + period_);
+                }
+
+                int read(cv::Mat& dst, bool applyAgc) override {
+                    if (!dev_->present) return 4;
+                    if (failuresLeft_ > 0) {
+                        --failuresLeft_;
+                        return 2 + failCode_++ % 3;
+                    }
+                    if (period_.count() > 0) {
+                        next_ += period_;
+                        auto now = std::chrono::steady_clock::now();
+                        if (next_ > now) std::this_thread::sleep_until(next_);
+                        else             next_ = now;
+                    }
+                    render();
+                    if (applyAgc)                                  emitAgc(dst);
+                    else if (dev_->cfg.family == DeviceFamily::TE_A) emitCounts16(dst);
+                    else                                           emitCountsF(dst);
+                    haveFrame_ = true;
+                    return 1;
+                }
+
+                bool readTemperature(cv::Mat& dst) override {
+                    if (!dev_->present || !haveFrame_) return false;
+                    const int w = width(), h = height();
+                    for (int y = 0; y < h; ++y) {
+                        const float* t = &scene_[size_t(y) * w];
+                        if (dst.type() == CV_16U) {
+                            unsigned short* d = dst.ptr<unsigned short>(y);
+                            for (int x = 0; x < w; ++x)
+                                d[x] = (unsigned short)std::lround(
+                                    std::min(std::max(t[x] * 100.f + 5000.f, 0.f), 65535.f));
+                        } else {
+                            std::copy(t, t + w, dst.ptr<float>(y));
+                        }
+                    }
+                    return true;
+                }
+
+                bool temperatureAt(int x, int y, float& celsius) override {
+                    if (!dev_->present || !haveFrame_ ||
+                        x < 0 || y < 0 || x >= width() || y >= height()) return false;
+                    celsius = scene_[size_t(y) * width() + x];
+                    // the TE_A encoding only has 0.01 °C steps
+                    if (dev_->cfg.family == DeviceFamily::TE_A)
+                        celsius = std::round(celsius * 100.f) / 100.f;
+                    return true;
+                }
+
+                float fpaTemperature() override { return dev_->cfg.fpaTemp; }
+
+                int shutterCalibration() override {
+                    if (!dev_->present) return 4;
+                    if (dev_->cfg.calibrationMs > 0)
+                        std::this_thread::sleep_for(
+                            std::chrono::milliseconds(dev_->cfg.calibrationMs));
+                    ++dev_->shutterCycles;
+                    calibrated_ = true;
+                    return 1;
+                }
+
+                // the file is the per-pixel offset table, which the SDK
+                // only checks by its size
+                bool saveCalibration(const std::string& path) override {
+                    if (!dev_->present || !calibrated_) return false;
+                    std::vector<int16_t> offsets(dev_->background.size());
+                    std::mt19937 rng(dev_->cfg.serial * 31u + 7u);
+                    for (int16_t& o : offsets) o = int16_t(int(rng() % 64u) - 32);
+                    FILE* f = std::fopen(path.c_str(), "wb");
+                    if (!f) return false;
+                    bool ok = std::fwrite(offsets.data(), sizeof(int16_t), offsets.size(), f)
+                              == offsets.size();
+                    ok = std::fclose(f) == 0 && ok;
+                    if (ok) ++dev_->saves;
+                    return ok;
+                }
+
+                bool loadCalibration(const std::string& path) override {
+                    if (!dev_->present) return false;
+                    FILE* f = std::fopen(path.c_str(), "rb");
+                    if (!f) return false;
+                    std::vector<int16_t> offsets(dev_->background.size() + 1);
+                    size_t n = std::fread(offsets.data(), sizeof(int16_t), offsets.size(), f);
+                    std::fclose(f);
+                    if (n != dev_->background.size()) return false;
+                    ++dev_->loads;
+                    calibrated_ = true;
+                    return true;
+                }
+
+                void setEmissivity(float e) override { emissivity_ = e; }
+
+            private:
+                // scene temperatures of the next frame
+                void render() {
+                    const SimConfig& c = dev_->cfg;
+                    const int w = c.width, h = c.height;
+                    const float* bg = dev_->background.data();
+                    const float* nz = dev_->noise.data();
+                    // a different slice of the noise table every frame
+                    const float* fz = nz + size_t(frame_ * 7919u) % NOISE_LEN;
+                    float* sc = scene_.data();
+                    for (size_t i = 0, n = scene_.size(); i < n; ++i)
+                        sc[i] = bg[i] + fz[i];
+
+                    for (const SimHotSpot& s : c.spots) {
+                        float cx = std::fmod(s.x + s.vx * float(frame_), float(w));
+                        float cy = std::fmod(s.y + s.vy * float(frame_), float(h));
+                        if (cx < 0) cx += w;
+                        if (cy < 0) cy += h;
+                        const float r2 = s.radius * s.radius;
+                        int y0 = std::max(0, int(cy - s.radius)), y1 = std::min(h - 1, int(cy + s.radius));
+                        int x0 = std::max(0, int(cx - s.radius)), x1 = std::min(w - 1, int(cx + s.radius));
+                        for (int y = y0; y <= y1; ++y) {
+                            float dy = y + 0.5f - cy;
+                            float* row = &scene_[size_t(y) * w];
+                            for (int x = x0; x <= x1; ++x) {
+                                float dx = x + 0.5f - cx;
+                                if (dx * dx + dy * dy <= r2)
+                                    row[x] = s.celsius + fz[size_t(y) * w + x];
+                            }
+                        }
+                    }
+                    ++frame_;
+                }
+
+                void emitCounts16(cv::Mat& dst) const {
+                    const int w = width(), h = height();
+                    for (int y = 0; y < h; ++y) {
+                        const float* t = &scene_[size_t(y) * w];
+                        unsigned short* d = dst.ptr<unsigned short>(y);
+                        for (int x = 0; x < w; ++x)
+                            d[x] = (unsigned short)std::min(std::max(int(countsOf(t[x])), 0), 65535);
+                    }
+                }
+
+                void emitCountsF(cv::Mat& dst) const {
+                    const int w = width(), h = height();
+                    for (int y = 0; y < h; ++y) {
+                        const float* t = &scene_[size_t(y) * w];
+                        float* d = dst.ptr<float>(y);
+                        for (int x = 0; x < w; ++x) d[x] = countsOf(t[x]);
+                    }
+                }
+
+                void emitAgc(cv::Mat& dst) const {
+                    const int w = width(), h = height();
+                    const float lo = dev_->agcLo;
+                    const float k = 65535.f / (dev_->agcHi - dev_->agcLo);
+                    for (int y = 0; y < h; ++y) {
+                        const float* t = &scene_[size_t(y) * w];
+                        unsigned short* d = dst.ptr<unsigned short>(y);
+                        for (int x = 0; x < w; ++x)
+                            d[x] = (unsigned short)std::min(std::max(int((t[x] - lo) * k), 0), 65535);
+                    }
+                }
+
+                std::shared_ptr<SimDevice> dev_;
+                int      failuresLeft_;
+                int      failCode_{0};
+                std::chrono::steady_clock::duration   period_;
+                std::chrono::steady_clock::time_point next_;
+                std::vector<float> scene_;
+                uint64_t frame_{0};
+                bool     haveFrame_{false};
+                bool     calibrated_{false};
+                float    emissivity_{1.f};
+            };
+
+        struct Bus {
+            std::mutex mutex;
+            std::map<unsigned int, std::shared_ptr<SimDevice>> devices;
+        };
+
+        Bus& bus() {
+            static Bus b;
+            return b;
+        }
+
+        unsigned int productOf(const SimConfig& c) {
+            const bool vga = c.width >= 640;
+            if (c.family == DeviceFamily::TE_A) return vga ? I3_TE_EV1 : I3_TE_EQ1;
+            return vga ? I3_TE_V1 : I3_TE_Q1;
+        }
+    }
+
+    void SimulatedBus::plug(unsigned int devNum, const SimConfig& cfg) {
+        auto dev = std::make_shared<SimDevice>(cfg);
+        {
+            std::lock_guard<std::mutex> lk(bus().mutex);
+            auto& slot = bus().devices[devNum];
+            if (slot) slot->present = false;    // replaced: old handles die
+            slot = std::move(dev);
+        }
+        HotplugDispatcher::inject(i3::TE_STATE(TE_ARRIVAL, int(devNum)));
+    }
+
+    void SimulatedBus::unplug(unsigned int devNum) {
+        {
+            std::lock_guard<std::mutex> lk(bus().mutex);
+            auto it = bus().devices.find(devNum);
+            if (it == bus().devices.end()) return;
+            it->second->present = false;
+            bus().devices.erase(it);
+        }
+        HotplugDispatcher::inject(i3::TE_STATE(TE_REMOVAL, int(devNum)));
+    }
+
+    void SimulatedBus::clear() {
+        std::vector<unsigned int> nums;
+        {
+            std::lock_guard<std::mutex> lk(bus().mutex);
+            for (const auto& kv : bus().devices) nums.push_back(kv.first);
+        }
+        for (unsigned int n : nums) unplug(n);
+    }
+
+    bool SimulatedBus::present(unsigned int devNum) {
+        std::lock_guard<std::mutex> lk(bus().mutex);
+        return bus().devices.count(devNum) != 0;
+    }
+
+    std::vector<DeviceInfo> SimulatedBus::scan() {
+        std::vector<DeviceInfo> list;
+        std::lock_guard<std::mutex> lk(bus().mutex);
+        for (const auto& kv : bus().devices)
+            list.push_back({kv.first, productOf(kv.second->cfg), kv.second->cfg.serial});
+        return list;
+    }
+
+    std::unique_ptr<DeviceBackend> SimulatedBus::open(int model, unsigned int devNum) {
+        std::shared_ptr<SimDevice> dev;
+        {
+            std::lock_guard<std::mutex> lk(bus().mutex);
+            auto it = bus().devices.find(devNum);
+            if (it == bus().devices.end()) return nullptr;
+            dev = it->second;
+        }
+        bool wantA = model == 3;
+        if (wantA != (dev->cfg.family == DeviceFamily::TE_A)) return nullptr;
+        if (dev->cfg.openMs > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(dev->cfg.openMs));
+        return std::unique_ptr<DeviceBackend>(new SimBackend(std::move(dev)));
+    }
+
+    SimCalibrationStats SimulatedBus::calibrationStats(unsigned int devNum) {
+        std::lock_guard<std::mutex> lk(bus().mutex);
+        auto it = bus().devices.find(devNum);
+        if (it == bus().devices.end()) return {0, 0, 0};
+        const SimDevice& d = *it->second;
+        return {d.shutterCycles.load(), d.saves.load(), d.loads.load()};
+    }
+
+} // namespace thermal
@@ -0,0 +1,328 @@
+#include "SlidingTempStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define THERMAL_X86 1
+#endif
+
+namespace thermal {
+
+    namespace {
+
+        const int MAX_WINDOW = 32768;   // keeps the int32 sums from overflowing
+
+        struct WindowKernels {
+            // take frame q in, the ring row's old frame out (ring row <- q);
+            // startBlock restarts the running block maximum
+            void (*update)(const uint16_t* q, uint16_t* ring, int32_t* sum,
+                           double* sumSq, uint16_t* prefix, bool startBlock, size_t n);
+            // out = max(a, b)
+            void (*maxU16)(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t n);
+        };
+
+        // — Scalar —
+        void updateScalar(const uint16_t* q, uint16_t* ring, int32_t* sum,
+                          double* sumSq, uint16_t* prefix, bool startBlock, size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                int32_t v = q[i], r = ring[i];
+                sum[i]   += v - r;
+                sumSq[i] += double(v - r) * double(v + r);
+                prefix[i] = startBlock ? q[i] : std::max(prefix[i], q[i]);
+                ring[i]   = q[i];
+            }
+        }
+
+        void maxU16Scalar(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t n) {
+            for (size_t i = 0; i < n; ++i) out[i] = std::max(a[i], b[i]);
+        }
+
+#ifdef THERMAL_X86
+        // — SSE4.1 —
+        __attribute__((target("sse4.1")))
+        void updateSse41(const uint16_t* q, uint16_t* ring, int32_t* sum,
+                         double* sumSq, uint16_t* prefix, bool startBlock, size_t n) {
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m128i v = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(q + i)));
+                __m128i r = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ring + i)));
+                __m128i d = _mm_sub_epi32(v, r), s = _mm_add_epi32(v, r);
+                __m128i* ps = reinterpret_cast<__m128i*>(sum + i);
+                _mm_storeu_si128(ps, _mm_add_epi32(_mm_loadu_si128(ps), d));
+                // v² - r² = (v - r)(v + r), exact in doubles
+                __m128d lo = _mm_mul_pd(_mm_cvtepi32_pd(d), _mm_cvtepi32_pd(s));
+                __m128d hi = _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(d, 8)),
+                                        _mm_cvtepi32_pd(_mm_srli_si128(s, 8)));
+                _mm_storeu_pd(sumSq + i,     _mm_add_pd(_mm_loadu_pd(sumSq + i), lo));
+                _mm_storeu_pd(sumSq + i + 2, _mm_add_pd(_mm_loadu_pd(sumSq + i + 2), hi));
+
+                __m128i qv = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q + i));
+                __m128i pv = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(prefix + i));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(prefix + i),
+                                 startBlock ? qv : _mm_max_epu16(pv, qv));
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(ring + i), qv);
+            }
+            updateScalar(q + i, ring + i, sum + i, sumSq + i, prefix + i, startBlock, n - i);
+        }
+
+        __attribute__((target("sse4.1")))
+        void maxU16Sse41(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t n) {
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+                __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_max_epu16(va, vb));
+            }
+            maxU16Scalar(a + i, b + i, out + i, n - i);
+        }
+
+        // — AVX2 —
+        __attribute__((target("avx2")))
+        void updateAvx2(const uint16_t* q, uint16_t* ring, int32_t* sum,
+                        double* sumSq, uint16_t* prefix, bool startBlock, size_t n) {
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m128i qv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + i));
+                __m128i rv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ring + i));
+                __m256i v = _mm256_cvtepu16_epi32(qv), r = _mm256_cvtepu16_epi32(rv);
+                __m256i d = _mm256_sub_epi32(v, r), s = _mm256_add_epi32(v, r);
+                __m256i* ps = reinterpret_cast<__m256i*>(sum + i);
+                _mm256_storeu_si256(ps, _mm256_add_epi32(_mm256_loadu_si256(ps), d));
+                __m256d lo = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(d)),
+                                           _mm256_cvtepi32_pd(_mm256_castsi256_si128(s)));
+                __m256d hi = _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(d, 1)),
+                                           _mm256_cvtepi32_pd(_mm256_extracti128_si256(s, 1)));
+                _mm256_storeu_pd(sumSq + i,     _mm256_add_pd(_mm256_loadu_pd(sumSq + i), lo));
+                _mm256_storeu_pd(sumSq + i + 4, _mm256_add_pd(_mm256_loadu_pd(sumSq + i + 4), hi));
+
+                __m128i pv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(prefix + i));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(prefix + i),
+                                 startBlock ? qv : _mm_max_epu16(pv, qv));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(ring + i), qv);
+            }
+            updateScalar(q + i, ring + i, sum + i, sumSq + i, prefix + i, startBlock, n - i);
+        }
+
+        __attribute__((target("avx2")))
+        void maxU16Avx2(const uint16_t* a, const uint16_t* b, uint16_t* out, size_t n) {
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+                __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_max_epu16(va, vb));
+            }
+            maxU16Scalar(a + i, b + i, out + i, n - i);
+        }
+#endif // THERMAL_X86
+
+        // NEON builds use the scalar loops, which the compiler vectorizes
+        WindowKernels kernelsFor(SimdLevel level) {
+            const SimdLevel best = detectSimdLevel();
+            if (level == SimdLevel::Auto || level == SimdLevel::NEON ||
+                (level == SimdLevel::AVX2 && best != SimdLevel::AVX2) ||
+                (level == SimdLevel::SSE41 && best != SimdLevel::AVX2 &&
+                 best != SimdLevel::SSE41))
+                level = best;
+            switch (level) {
+#ifdef THERMAL_X86
+                case SimdLevel::AVX2:  return {updateAvx2, maxU16Avx2};
+                case SimdLevel::SSE41: return {updateSse41, maxU16Sse41};
+#endif
+                default:               return {updateScalar, maxU16Scalar};
+            }
+        }
+
+        inline uint16_t quantize(float c) {
+            float v = c * 100.0f + 5000.5f;
+            if (v <= 0.0f) return 0;
+            if (v >= 65535.0f) return UINT16_MAX;
+            return uint16_t(v);
+        }
+
+        inline float toCelsius(float v) { return (v - 5000.0f) / 100.0f; }
+
+    } // namespace
+
+
+    SlidingTempStats::SlidingTempStats(int width, int height, int windowFrames,
+                                       int every, SimdLevel level)
+        : width_(std::max(width, 0)), height_(std::max(height, 0)),
+          every_(std::max(every, 1)), level_(level) {
+        // even, so the window is exactly two blocks
+        window_ = std::min(std::max(windowFrames, 2), MAX_WINDOW);
+        window_ += window_ & 1;
+        block_  = window_ / 2;
+        pixels_ = size_t(width_) * height_;
+
+        ring_.assign(size_t(window_) * pixels_, 0);
+        times_.assign(size_t(window_), Clock::time_point());
+        sum_.assign(pixels_, 0);
+        sumSq_.assign(pixels_, 0.0);
+        prefix_.assign(pixels_, 0);
+        blockMax_.assign(pixels_, 0);
+        suffix_.assign(size_t(block_) * pixels_, 0);
+        scratch_.assign(pixels_, 0);
+    }
+
+    size_t SlidingTempStats::memoryBytes() const {
+        return (ring_.size() + prefix_.size() + blockMax_.size() + suffix_.size() +
+                scratch_.size()) * sizeof(uint16_t) +
+               sum_.size() * sizeof(int32_t) + sumSq_.size() * sizeof(double) +
+               times_.size() * sizeof(Clock::time_point);
+    }
+
+    void SlidingTempStats::reset() {
+        std::lock_guard<std::mutex> lk(mutex_);
+        std::fill(ring_.begin(), ring_.end(), 0);
+        std::fill(sum_.begin(), sum_.end(), 0);
+        std::fill(sumSq_.begin(), sumSq_.end(), 0.0);
+        std::fill(prefix_.begin(), prefix_.end(), 0);
+        std::fill(blockMax_.begin(), blockMax_.end(), 0);
+        std::fill(suffix_.begin(), suffix_.end(), 0);
+        pushed_ = count_ = 0;
+    }
+
+    bool SlidingTempStats::push(const Frame& f) {
+        if (f.empty()) return false;
+        return push(f.temperatureRaw(), f.info().timestamp);
+    }
+
+    bool SlidingTempStats::push(const cv::Mat& temp, Clock::time_point t) {
+        if (temp.rows != height_ || temp.cols != width_ || !pixels_ ||
+            (temp.type() != CV_16U && temp.type() != CV_32F))
+            return false;
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (pushed_++ % uint64_t(every_)) return true;
+
+        if (temp.type() == CV_16U && temp.isContinuous()) {
+            pushQuantized(temp.ptr<uint16_t>(), t);
+            return true;
+        }
+        uint16_t* q = scratch_.data();
+        for (int y = 0; y < height_; ++y, q += width_) {
+            if (temp.type() == CV_16U) {
+                std::memcpy(q, temp.ptr<uint16_t>(y), size_t(width_) * sizeof(uint16_t));
+            } else {
+                const float* p = temp.ptr<float>(y);
+                for (int x = 0; x < width_; ++x) q[x] = quantize(p[x]);
+            }
+        }
+        pushQuantized(scratch_.data(), t);
+        return true;
+    }
+
+    void SlidingTempStats::pushQuantized(const uint16_t* q, Clock::time_point t) {
+        const WindowKernels k = kernelsFor(level_);
+        const uint64_t f = count_;
+        const uint64_t blk = f / block_;
+        const int o = int(f % block_);
+
+        if (o == 0 && blk > 0) std::copy(prefix_.begin(), prefix_.end(), blockMax_.begin());
+        k.update(q, ringRow(f), sum_.data(), sumSq_.data(), prefix_.data(), o == 0, pixels_);
+        times_[f % window_] = t;
+
+        // one row of the previous block's suffix maxima, last row first;
+        // the rows it needs are still in the ring
+        if (blk > 0) {
+            const int j = block_ - 1 - o;
+            const uint16_t* x = ringRow((blk - 1) * block_ + j);
+            uint16_t* s = suffix_.data() + suffixPos(blk - 1, j);
+            if (j == block_ - 1)
+                std::memcpy(s, x, pixels_ * sizeof(uint16_t));
+            else
+                k.maxU16(x, suffix_.data() + suffixPos(blk - 1, j + 1), s, pixels_);
+        }
+        ++count_;
+    }
+
+    int SlidingTempStats::frames() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return int(std::min<uint64_t>(count_, uint64_t(window_)));
+    }
+
+    double SlidingTempStats::spanSeconds() const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (count_ < 2) return 0;
+        const uint64_t n = std::min<uint64_t>(count_, uint64_t(window_));
+        return std::chrono::duration<double>(times_[(count_ - 1) % window_] -
+                                             times_[(count_ - n) % window_]).count();
+    }
+
+    bool SlidingTempStats::mean(cv::Mat& out) const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (!count_) return false;
+        const float inv = 1.0f / float(std::min<uint64_t>(count_, uint64_t(window_)));
+        out.create(height_, width_, CV_32F);
+        float* o = out.ptr<float>();
+        for (size_t i = 0; i < pixels_; ++i) o[i] = toCelsius(float(sum_[i]) * inv);
+        return true;
+    }
+
+    bool SlidingTempStats::stddev(cv::Mat& out) const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (!count_) return false;
+        const double n = double(std::min<uint64_t>(count_, uint64_t(window_)));
+        out.create(height_, width_, CV_32F);
+        float* o = out.ptr<float>();
+        for (size_t i = 0; i < pixels_; ++i) {
+            // n² var = n Σx² - (Σx)², both sides integers
+            double s = double(sum_[i]);
+            double v = std::max(0.0, n * sumSq_[i] - s * s);
+            o[i] = float(std::sqrt(v) / n / 100.0);
+        }
+        return true;
+    }
+
+    bool SlidingTempStats::max(cv::Mat& out) const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (!count_) return false;
+        const WindowKernels k = kernelsFor(level_);
+        const uint64_t last = count_ - 1;
+        const uint64_t blk = last / block_;
+        const int o = int(last % block_);
+
+        // current block so far, the whole previous one, and the tail of the
+        // one before from the suffix maxima
+        std::vector<uint16_t> m(prefix_);
+        if (blk >= 1) k.maxU16(m.data(), blockMax_.data(), m.data(), pixels_);
+        if (blk >= 2 && o < block_ - 1)
+            k.maxU16(m.data(), suffix_.data() + suffixPos(blk - 2, o + 1), m.data(), pixels_);
+
+        out.create(height_, width_, CV_32F);
+        float* p = out.ptr<float>();
+        for (size_t i = 0; i < pixels_; ++i) p[i] = toCelsius(float(m[i]));
+        return true;
+    }
+
+    bool SlidingTempStats::delta(cv::Mat& out) const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (!count_) return false;
+        const uint64_t n = std::min<uint64_t>(count_, uint64_t(window_));
+        const uint16_t* newest = ringRow(count_ - 1);
+        const uint16_t* oldest = ringRow(count_ - n);
+        out.create(height_, width_, CV_32F);
+        float* o = out.ptr<float>();
+        for (size_t i = 0; i < pixels_; ++i)
+            o[i] = float(int(newest[i]) - int(oldest[i])) / 100.0f;
+        return true;
+    }
+
+    bool SlidingTempStats::rate(cv::Mat& out) const {
+        std::lock_guard<std::mutex> lk(mutex_);
+        if (!count_) return false;
+        const uint64_t n = std::min<uint64_t>(count_, uint64_t(window_));
+        const double span = std::chrono::duration<double>(
+            times_[(count_ - 1) % window_] - times_[(count_ - n) % window_]).count();
+        const float scale = span > 0 ? float(0.01 / span) : 0.0f;
+        const uint16_t* newest = ringRow(count_ - 1);
+        const uint16_t* oldest = ringRow(count_ - n);
+        out.create(height_, width_, CV_32F);
+        float* o = out.ptr<float>();
+        for (size_t i = 0; i < pixels_; ++i)
+            o[i] = float(int(newest[i]) - int(oldest[i])) * scale;
+        return true;
+    }
+
+} // namespace thermal
@@ -0,0 +1,169 @@
+#include "StreamPipeline.h"
+#include "Metrics.h"
+#include "ThreadAffinity.h"
+#include <chrono>
+
+namespace thermal {
+
+    namespace {
+        // Back off gently while a ring is empty/full: spin briefly, then
+        // yield, then sleep so idle stages don't burn a core.
+        void idle(unsigned& spins) {
+            if (++spins < 64) return;
+            if (spins < 128) { std::this_thread::yield(); return; }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    }
+
+    StreamPipeline::StreamPipeline(std::shared_ptr<FrameSource> source,
+                                   FramePool* pool,
+                                   MakeFn make,
+                                   PrepareFn prepare,
+                                   DeliverFn deliver,
+                                   const Config& cfg)
+        : source_(std::move(source)), pool_(pool),
+          make_(std::move(make)), prepare_(std::move(prepare)),
+          deliver_(std::move(deliver)),
+          cfg_(cfg) {
+        int n = cfg_.workers < 1 ? 1 : cfg_.workers;
+        for (int i = 0; i < n; ++i)
+            workers_.emplace_back(new Worker(cfg_.ringCapacity));
+    }
+
+    StreamPipeline::~StreamPipeline() {
+        stop();
+    }
+
+    void StreamPipeline::start() {
+        if (running_) return;
+        running_ = true;
+        deliverThread_ = std::thread(&StreamPipeline::deliverLoop, this);
+        for (auto& w : workers_)
+            w->thread = std::thread(&StreamPipeline::workerLoop, this, std::ref(*w));
+        acquireThread_ = std::thread(&StreamPipeline::acquireLoop, this);
+    }
+
+    void StreamPipeline::stop() {
+        running_ = false;
+        if (acquireThread_.joinable()) acquireThread_.join();
+        for (auto& w : workers_)
+            if (w->thread.joinable()) w->thread.join();
+        if (deliverThread_.joinable()) deliverThread_.join();
+    }
+
+    PipelineStats StreamPipeline::stats() const {
+        size_t depth = 0;
+        for (auto& w : workers_) depth += w->in.size();
+        return {acquired_, delivered_, dropped_, readErrors_,
+                depth, maxQueueDepth_};
+    }
+
+
+    // — Stages —
+    void StreamPipeline::acquireLoop() {
+        if (cfg_.cpu >= 0) pinCurrentThread(cfg_.cpu);
+        const int w = source_->width(), h = source_->height();
+        const int type = source_->frameType(cfg_.applyAgc);
+        const size_t n = workers_.size();
+        uint64_t dealt = 0;     // frames handed out so far; dealt % n picks the worker
+        uint64_t seq = 0;       // source frame slots, including skipped ones
+
+        while (running_) {
+            if (cfg_.pacer) {
+                uint64_t skipped = cfg_.pacer->wait();
+                seq += skipped;
+                if (cfg_.metrics && cfg_.metrics->enabled())
+                    cfg_.metrics->countDropped(skipped);
+            }
+            std::unique_lock<std::mutex> reading;
+            if (cfg_.readMutex) reading = std::unique_lock<std::mutex>(*cfg_.readMutex);
+            if (cfg_.tracker) cfg_.tracker->retire();
+
+            cv::Mat raw;
+            pool_->acquire(raw, h, w, type);
+            if (readFrame(*source_, raw, cfg_.applyAgc, 0, cfg_.metrics) != 1) {
+                ++readErrors_;
+                break;
+            }
+            ++acquired_;
+
+            // every frame dealt is delivered, so whatever the sequence is
+            // ahead of `dealt` by was lost to pacing skips or full rings
+            FrameInfo info;
+            info.sequence  = seq;
+            info.timestamp = std::chrono::steady_clock::now();
+            info.dropped   = seq - dealt;
+            info.fpaTemp   = source_->fpaTemperature();
+            ++seq;
+
+            Item item{make_(std::move(raw), info)};
+            if (cfg_.tracker) cfg_.tracker->track(item.frame);
+            if (reading) reading.unlock();
+
+            // a dropped frame does not advance dealt, so the next one goes to
+            // the same worker and the round-robin order stays intact
+            if (!workers_[dealt % n]->in.push(item)) {
+                ++dropped_;
+                if (cfg_.metrics && cfg_.metrics->enabled())
+                    cfg_.metrics->countDropped(1);
+                continue;
+            }
+            ++dealt;
+
+            size_t depth = 0;
+            for (auto& wk : workers_) depth += wk->in.size();
+            size_t hw = maxQueueDepth_.load(std::memory_order_relaxed);
+            if (depth > hw) maxQueueDepth_.store(depth, std::memory_order_relaxed);
+        }
+        sourceDone_ = true;
+    }
+
+    void StreamPipeline::workerLoop(Worker& w) {
+        unsigned spins = 0;
+        Item item;
+        while (running_) {
+            if (!w.in.pop(item)) {
+                if (sourceDone_ && w.in.size() == 0) break;
+                idle(spins);
+                continue;
+            }
+            spins = 0;
+            prepare_(item.frame);
+
+            // delivery is the only consumer; wait for it rather than drop,
+            // so the back-pressure lands on the acquisition rings instead
+            while (!w.out.push(item)) {
+                if (!running_) return;
+                idle(spins);
+            }
+        }
+        ++workersDone_;
+    }
+
+    void StreamPipeline::deliverLoop() {
+        const size_t n = workers_.size();
+        unsigned spins = 0;
+        uint64_t next = 0;
+        bool exhausted = false;
+        Item item;
+        while (running_) {
+            auto& w = *workers_[next % n];
+            if (!w.out.pop(item)) {
+                if (workersDone_ == int(n) && w.out.size() == 0) {
+                    exhausted = true;
+                    break;
+                }
+                idle(spins);
+                continue;
+            }
+            spins = 0;
+            deliver_(item.frame);
+            item.frame = Frame();
+            ++delivered_;
+            ++next;
+        }
+        finished_ = true;
+        if (exhausted && cfg_.onSourceDone) cfg_.onSourceDone();
+    }
+
+} // namespace thermal
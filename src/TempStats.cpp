@@ -0,0 +1,422 @@
+#include "TempStats.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define THERMAL_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define THERMAL_NEON 1
+#endif
+
+namespace thermal {
+
+    namespace {
+
+        // Pixels per block: small enough to stay in L1 between the SIMD
+        // min/max sweep and the histogram sweep, and for per-lane float sums.
+        const size_t BLOCK = 4096;
+
+        struct Kernels {
+            void (*minMaxU16)(const uint16_t* p, size_t n,
+                              uint16_t& mn, uint16_t& mx);
+            // sums of (value - pivot): with the pivot near the data the
+            // float lanes hold small numbers and E[d²] - E[d]² stays exact
+            // enough; the blocks add up in double. NaNs (dead pixels) are
+            // left out of all four.
+            void (*minMaxSumF32)(const float* p, size_t n, float pivot,
+                                 float& mn, float& mx, double& sum, double& sumSq);
+        };
+
+        // — Scalar —
+        void minMaxU16Scalar(const uint16_t* p, size_t n,
+                             uint16_t& mn, uint16_t& mx) {
+            uint16_t a = UINT16_MAX, b = 0;
+            for (size_t i = 0; i < n; ++i) {
+                a = std::min(a, p[i]);
+                b = std::max(b, p[i]);
+            }
+            mn = a; mx = b;
+        }
+
+        void minMaxSumF32Scalar(const float* p, size_t n, float pivot, float& mn,
+                                float& mx, double& sum, double& sumSq) {
+            float a = FLT_MAX, b = -FLT_MAX, s = 0, q = 0;
+            for (size_t i = 0; i < n; ++i) {
+                // std::min/max keep `a`/`b` when p[i] is NaN
+                a = std::min(a, p[i]);
+                b = std::max(b, p[i]);
+                float d = p[i] == p[i] ? p[i] - pivot : 0.0f;
+                s += d;
+                q += d * d;
+            }
+            mn = a; mx = b; sum += s; sumSq += q;
+        }
+
+#ifdef THERMAL_X86
+        // — SSE4.1 —
+        __attribute__((target("sse4.1")))
+        void reduceU16(__m128i vmn, __m128i vmx, uint16_t& mn, uint16_t& mx) {
+            // minpos finds the minimum of 8 lanes; max is the min of ~x
+            const __m128i ones = _mm_set1_epi16(-1);
+            mn = uint16_t(_mm_extract_epi16(_mm_minpos_epu16(vmn), 0));
+            mx = uint16_t(~_mm_extract_epi16(_mm_minpos_epu16(_mm_xor_si128(vmx, ones)), 0));
+        }
+
+        __attribute__((target("sse4.1")))
+        void minMaxU16Sse41(const uint16_t* p, size_t n,
+                            uint16_t& mn, uint16_t& mx) {
+            __m128i vmn = _mm_set1_epi16(-1), vmx = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                vmn = _mm_min_epu16(vmn, v);
+                vmx = _mm_max_epu16(vmx, v);
+            }
+            reduceU16(vmn, vmx, mn, mx);
+            for (; i < n; ++i) { mn = std::min(mn, p[i]); mx = std::max(mx, p[i]); }
+        }
+
+        __attribute__((target("sse4.1")))
+        float hmin(__m128 v) {
+            v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+            v = _mm_min_ss(v, _mm_shuffle_ps(v, v, 1));
+            return _mm_cvtss_f32(v);
+        }
+        __attribute__((target("sse4.1")))
+        float hmax(__m128 v) {
+            v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+            v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+            return _mm_cvtss_f32(v);
+        }
+        __attribute__((target("sse4.1")))
+        float hsum(__m128 v) {
+            v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+            v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 1));
+            return _mm_cvtss_f32(v);
+        }
+
+        __attribute__((target("sse4.1")))
+        void minMaxSumF32Sse41(const float* p, size_t n, float pivot, float& mn,
+                               float& mx, double& sum, double& sumSq) {
+            __m128 vmn = _mm_set1_ps(FLT_MAX), vmx = _mm_set1_ps(-FLT_MAX);
+            __m128 vs = _mm_setzero_ps(), vq = _mm_setzero_ps();
+            const __m128 vp = _mm_set1_ps(pivot);
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                __m128 v = _mm_loadu_ps(p + i);
+                // minps/maxps return the second operand if either is NaN
+                vmn = _mm_min_ps(v, vmn);
+                vmx = _mm_max_ps(v, vmx);
+                __m128 d = _mm_and_ps(_mm_sub_ps(v, vp), _mm_cmpord_ps(v, v));
+                vs  = _mm_add_ps(vs, d);
+                vq  = _mm_add_ps(vq, _mm_mul_ps(d, d));
+            }
+            float a = hmin(vmn), b = hmax(vmx), s = hsum(vs), q = hsum(vq);
+            for (; i < n; ++i) {
+                a = std::min(a, p[i]); b = std::max(b, p[i]);
+                float d = p[i] == p[i] ? p[i] - pivot : 0.0f;
+                s += d; q += d * d;
+            }
+            mn = a; mx = b; sum += s; sumSq += q;
+        }
+
+        // — AVX2 —
+        __attribute__((target("avx2")))
+        void minMaxU16Avx2(const uint16_t* p, size_t n,
+                           uint16_t& mn, uint16_t& mx) {
+            __m256i vmn = _mm256_set1_epi16(-1), vmx = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+                vmn = _mm256_min_epu16(vmn, v);
+                vmx = _mm256_max_epu16(vmx, v);
+            }
+            __m128i lo = _mm_min_epu16(_mm256_castsi256_si128(vmn),
+                                       _mm256_extracti128_si256(vmn, 1));
+            __m128i hi = _mm_max_epu16(_mm256_castsi256_si128(vmx),
+                                       _mm256_extracti128_si256(vmx, 1));
+            reduceU16(lo, hi, mn, mx);
+            for (; i < n; ++i) { mn = std::min(mn, p[i]); mx = std::max(mx, p[i]); }
+        }
+
+        __attribute__((target("avx2,fma")))
+        void minMaxSumF32Avx2(const float* p, size_t n, float pivot, float& mn,
+                              float& mx, double& sum, double& sumSq) {
+            __m256 vmn = _mm256_set1_ps(FLT_MAX), vmx = _mm256_set1_ps(-FLT_MAX);
+            __m256 vs = _mm256_setzero_ps(), vq = _mm256_setzero_ps();
+            const __m256 vp = _mm256_set1_ps(pivot);
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256 v = _mm256_loadu_ps(p + i);
+                vmn = _mm256_min_ps(v, vmn);
+                vmx = _mm256_max_ps(v, vmx);
+                __m256 d = _mm256_and_ps(_mm256_sub_ps(v, vp),
+                                         _mm256_cmp_ps(v, v, _CMP_ORD_Q));
+                vs  = _mm256_add_ps(vs, d);
+                vq  = _mm256_fmadd_ps(d, d, vq);
+            }
+            float a = hmin(_mm_min_ps(_mm256_castps256_ps128(vmn), _mm256_extractf128_ps(vmn, 1)));
+            float b = hmax(_mm_max_ps(_mm256_castps256_ps128(vmx), _mm256_extractf128_ps(vmx, 1)));
+            float s = hsum(_mm_add_ps(_mm256_castps256_ps128(vs), _mm256_extractf128_ps(vs, 1)));
+            float q = hsum(_mm_add_ps(_mm256_castps256_ps128(vq), _mm256_extractf128_ps(vq, 1)));
+            for (; i < n; ++i) {
+                a = std::min(a, p[i]); b = std::max(b, p[i]);
+                float d = p[i] == p[i] ? p[i] - pivot : 0.0f;
+                s += d; q += d * d;
+            }
+            mn = a; mx = b; sum += s; sumSq += q;
+        }
+#endif // THERMAL_X86
+
+#ifdef THERMAL_NEON
+        // — NEON —
+        void minMaxU16Neon(const uint16_t* p, size_t n,
+                           uint16_t& mn, uint16_t& mx) {
+            uint16x8_t vmn = vdupq_n_u16(UINT16_MAX), vmx = vdupq_n_u16(0);
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                uint16x8_t v = vld1q_u16(p + i);
+                vmn = vminq_u16(vmn, v);
+                vmx = vmaxq_u16(vmx, v);
+            }
+            mn = vminvq_u16(vmn); mx = vmaxvq_u16(vmx);
+            for (; i < n; ++i) { mn = std::min(mn, p[i]); mx = std::max(mx, p[i]); }
+        }
+
+        void minMaxSumF32Neon(const float* p, size_t n, float pivot, float& mn,
+                              float& mx, double& sum, double& sumSq) {
+            float32x4_t vmn = vdupq_n_f32(FLT_MAX), vmx = vdupq_n_f32(-FLT_MAX);
+            float32x4_t vs = vdupq_n_f32(0), vq = vdupq_n_f32(0);
+            const float32x4_t vp = vdupq_n_f32(pivot);
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4) {
+                float32x4_t v = vld1q_f32(p + i);
+                // the IEEE minNum/maxNum forms skip NaN like the others
+                vmn = vminnmq_f32(vmn, v);
+                vmx = vmaxnmq_f32(vmx, v);
+                float32x4_t d = vreinterpretq_f32_u32(
+                    vandq_u32(vreinterpretq_u32_f32(vsubq_f32(v, vp)), vceqq_f32(v, v)));
+                vs  = vaddq_f32(vs, d);
+                vq  = vfmaq_f32(vq, d, d);
+            }
+            float a = vminvq_f32(vmn), b = vmaxvq_f32(vmx);
+            float s = vaddvq_f32(vs), q = vaddvq_f32(vq);
+            for (; i < n; ++i) {
+                a = std::min(a, p[i]); b = std::max(b, p[i]);
+                float d = p[i] == p[i] ? p[i] - pivot : 0.0f;
+                s += d; q += d * d;
+            }
+            mn = a; mx = b; sum += s; sumSq += q;
+        }
+#endif // THERMAL_NEON
+
+        bool supported(SimdLevel level) {
+            switch (level) {
+                case SimdLevel::Scalar: return true;
+#ifdef THERMAL_X86
+                case SimdLevel::SSE41:  return __builtin_cpu_supports("sse4.1");
+                case SimdLevel::AVX2:   return __builtin_cpu_supports("avx2") &&
+                                               __builtin_cpu_supports("fma");
+#endif
+#ifdef THERMAL_NEON
+                case SimdLevel::NEON:   return true;
+#endif
+                default:                return false;
+            }
+        }
+
+        Kernels kernelsFor(SimdLevel level) {
+            if (level == SimdLevel::Auto || !supported(level))
+                level = detectSimdLevel();
+            switch (level) {
+#ifdef THERMAL_X86
+                case SimdLevel::AVX2:  return {minMaxU16Avx2, minMaxSumF32Avx2};
+                case SimdLevel::SSE41: return {minMaxU16Sse41, minMaxSumF32Sse41};
+#endif
+#ifdef THERMAL_NEON
+                case SimdLevel::NEON:  return {minMaxU16Neon, minMaxSumF32Neon};
+#endif
+                default:               return {minMaxU16Scalar, minMaxSumF32Scalar};
+            }
+        }
+
+        // 0.01 °C bins over the whole 16-bit range. Per thread so streams on
+        // different cameras don't contend; only the [min, max] span is ever
+        // touched and it is cleared again while being read, so there is no
+        // per-frame memset.
+        std::vector<uint32_t>& histogram() {
+            thread_local std::vector<uint32_t> h(65536, 0);
+            return h;
+        }
+
+        // index of the first element equal to `v` (it is known to be there)
+        template <typename T>
+        size_t findFirst(const T* p, size_t n, T v) {
+            size_t i = 0;
+            while (i < n && p[i] != v) ++i;
+            return i;
+        }
+
+        // NaN, which the caller keeps out, would go to bin 0
+        inline uint16_t quantize(float c) {
+            float v = c * 100.0f + 5000.5f;
+            if (!(v > 0.0f)) return 0;
+            if (v >= 65535.0f) return UINT16_MAX;
+            return uint16_t(v);
+        }
+
+        inline float toCelsius(uint32_t v) { return (float(v) - 5000.0f) / 100.0f; }
+
+        // nearest-rank percentiles from the histogram span [lo, hi];
+        // optionally also its exact mean/variance; clears what it reads
+        void scanHistogram(std::vector<uint32_t>& h, uint32_t lo, uint32_t hi,
+                           size_t n, TempStats& s, double* sum, double* sumSq) {
+            const double P[4] = {0.05, 0.50, 0.95, 0.99};
+            float* out[4] = {&s.p5, &s.p50, &s.p95, &s.p99};
+            size_t rank[4];
+            for (int k = 0; k < 4; ++k)
+                rank[k] = std::max<size_t>(1, size_t(std::ceil(P[k] * double(n))));
+
+            size_t cum = 0;
+            int k = 0;
+            double s1 = 0, s2 = 0;
+            for (uint32_t v = lo; v <= hi; ++v) {
+                uint32_t c = h[v];
+                if (!c) continue;
+                h[v] = 0;
+                cum += c;
+                while (k < 4 && cum >= rank[k]) *out[k++] = toCelsius(v);
+                // offsets from lo keep the squares small and exact
+                double d = double(v - lo);
+                s1 += c * d;
+                s2 += c * d * d;
+            }
+            if (sum)   *sum   = s1;
+            if (sumSq) *sumSq = s2;
+        }
+
+    } // namespace
+
+
+    SimdLevel detectSimdLevel() {
+#ifdef THERMAL_X86
+        if (supported(SimdLevel::AVX2))  return SimdLevel::AVX2;
+        if (supported(SimdLevel::SSE41)) return SimdLevel::SSE41;
+#endif
+#ifdef THERMAL_NEON
+        return SimdLevel::NEON;
+#endif
+        return SimdLevel::Scalar;
+    }
+
+    const char* simdLevelName(SimdLevel level) {
+        switch (level) {
+            case SimdLevel::Auto:   return simdLevelName(detectSimdLevel());
+            case SimdLevel::Scalar: return "scalar";
+            case SimdLevel::SSE41:  return "sse4.1";
+            case SimdLevel::AVX2:   return "avx2";
+            case SimdLevel::NEON:   return "neon";
+        }
+        return "unknown";
+    }
+
+    void minMaxU16(const cv::Mat& img, uint16_t& mn, uint16_t& mx,
+                   SimdLevel level) {
+        mn = UINT16_MAX; mx = 0;
+        if (img.empty() || img.type() != CV_16U) return;
+        const Kernels k = kernelsFor(level);
+        for (int y = 0, rows = img.isContinuous() ? 1 : img.rows; y < rows; ++y) {
+            size_t len = img.isContinuous() ? img.total() : size_t(img.cols);
+            uint16_t a, b;
+            k.minMaxU16(img.ptr<uint16_t>(y), len, a, b);
+            mn = std::min(mn, a);
+            mx = std::max(mx, b);
+        }
+    }
+
+    TempStats computeTempStats(const cv::Mat& temp, SimdLevel level) {
+        TempStats s{};
+        if (temp.empty() || !temp.isContinuous()) return s;
+        const Kernels k = kernelsFor(level);
+        const size_t n = temp.total();
+        const int w = temp.cols;
+        auto& hist = histogram();
+
+        size_t minBlock = 0, maxBlock = 0;
+
+        if (temp.type() == CV_16U) {
+            const uint16_t* p = temp.ptr<uint16_t>();
+            uint16_t mn = UINT16_MAX, mx = 0;
+            for (size_t b = 0; b < n; b += BLOCK) {
+                size_t len = std::min(BLOCK, n - b);
+                uint16_t bmn, bmx;
+                k.minMaxU16(p + b, len, bmn, bmx);
+                // strict compares keep the first occurrence, like the old loop
+                if (bmn < mn) { mn = bmn; minBlock = b; }
+                if (bmx > mx) { mx = bmx; maxBlock = b; }
+                for (size_t i = 0; i < len; ++i) ++hist[p[b + i]];
+            }
+            size_t minP = minBlock + findFirst(p + minBlock, n - minBlock, mn);
+            size_t maxP = maxBlock + findFirst(p + maxBlock, n - maxBlock, mx);
+
+            double sum, sumSq;
+            scanHistogram(hist, mn, mx, n, s, &sum, &sumSq);
+            double mean = sum / double(n);
+            double var  = std::max(0.0, sumSq / double(n) - mean * mean);
+
+            s.minTemp = toCelsius(mn);
+            s.maxTemp = toCelsius(mx);
+            s.minLoc  = {int(minP % w), int(minP / w)};
+            s.maxLoc  = {int(maxP % w), int(maxP / w)};
+            s.mean    = toCelsius(uint32_t(mn)) + float(mean / 100.0);
+            s.stddev  = float(std::sqrt(var) / 100.0);
+        }
+        else if (temp.type() == CV_32F) {
+            const float* p = temp.ptr<float>();
+            // any live pixel is near the rest of the scene; none: no stats
+            const size_t first = size_t(std::find_if(p, p + n, [](float v) {
+                return std::isfinite(v);
+            }) - p);
+            if (first == n) return s;
+            const float pivot = p[first];
+
+            float mn = FLT_MAX, mx = -FLT_MAX;
+            double sum = 0, sumSq = 0;
+            size_t dead = 0;
+            for (size_t b = 0; b < n; b += BLOCK) {
+                size_t len = std::min(BLOCK, n - b);
+                float bmn, bmx;
+                k.minMaxSumF32(p + b, len, pivot, bmn, bmx, sum, sumSq);
+                if (bmn < mn) { mn = bmn; minBlock = b; }
+                if (bmx > mx) { mx = bmx; maxBlock = b; }
+                for (size_t i = 0; i < len; ++i) {
+                    const float v = p[b + i];
+                    if (v == v) ++hist[quantize(v)];
+                    else        ++dead;
+                }
+            }
+            size_t minP = minBlock + findFirst(p + minBlock, n - minBlock, mn);
+            size_t maxP = maxBlock + findFirst(p + maxBlock, n - maxBlock, mx);
+
+            // percentiles, mean and spread of the live pixels only
+            const size_t live = n - dead;
+            scanHistogram(hist, quantize(mn), quantize(mx), live, s, nullptr, nullptr);
+            double mean = sum / double(live);
+            double var  = std::max(0.0, sumSq / double(live) - mean * mean);
+            mean += pivot;
+
+            s.minTemp = mn;
+            s.maxTemp = mx;
+            s.minLoc  = {int(minP % w), int(minP / w)};
+            s.maxLoc  = {int(maxP % w), int(maxP / w)};
+            s.mean    = float(mean);
+            s.stddev  = float(std::sqrt(var));
+        }
+        return s;
+    }
+
+} // namespace thermal
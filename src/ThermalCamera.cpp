@@ -1,230 +1,1027 @@
 #include "ThermalCamera.h"
+#include "ThreadAffinity.h"
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
-#include <unistd.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <mutex>
 
 namespace thermal {
 
     // static member
-    ThermalCamera::HotplugFn ThermalCamera::hotplugCallback_ = nullptr;
+    int ThermalCamera::globalHotplugToken_ = -1;
 
-    // Proxy for the C‐style callback
-    // Proxy must match C‐API exactly: void(*)(i3::TE_STATE)
-    void ThermalCamera::hotplugProxy(i3::TE_STATE state) {
-        if (hotplugCallback_) hotplugCallback_(state);
+    // — Hotplug state of one camera — 
+    struct ThermalCamera::Link {
+        std::mutex              mutex;
+        std::condition_variable cv;
+
+        // what open() was given; serial lets a reconnect find the camera
+        // again if it comes back under another device number (0: unknown)
+        int          model{0};
+        unsigned int deviceNumber{0};
+        unsigned int serial{0};
+
+        HotplugFn    user;                       // onHotplug
+        std::function<void(const LinkStats&)> onReconnect;
+
+        std::atomic<bool> down{false};           // stop reading, reconnect
+        std::atomic<bool> awaitingFirst{false};  // reopened, no frame yet
+        bool         arrived{false};             // TE_ARRIVAL since last look
+        bool         inOutage{false};
+        std::chrono::steady_clock::time_point lostAt, reopenedAt;
+        LinkStats    stats{false, 0, 0, 0, 0, 0};
+
+        // caller holds mutex
+        void lose() {
+            if (inOutage) return;
+            inOutage = true;
+            lostAt = std::chrono::steady_clock::now();
+            stats.connected = false;
+            ++stats.outages;
+        }
+
+        void handle(i3::TE_STATE state) {
+            HotplugFn cb;
+            {
+                std::lock_guard<std::mutex> lk(mutex);
+                if (state.nUsbState == TE_REMOVAL) {
+                    lose();
+                    down = true;
+                } else if (state.nUsbState == TE_ARRIVAL) {
+                    arrived = true;
+                }
+                cb = user;
+            }
+            cv.notify_all();
+            if (cb) cb(state);
+        }
+    };
+
+    namespace {
+        using Millis = std::chrono::duration<double, std::milli>;
+        // reopen backoff: 100 ms doubling up to 5 s
+        const std::chrono::milliseconds RECONNECT_MIN_DELAY(100);
+        const std::chrono::milliseconds RECONNECT_MAX_DELAY(5000);
+        // reads allowed for a freshly reopened camera to warm up
+        const int WARMUP_ATTEMPTS = 30;
+        // between the attempts of an asynchronous capture, as readFrame
+        const std::chrono::milliseconds CAPTURE_RETRY_DELAY(100);
     }
 
     // — Static methods — 
     std::vector<DeviceInfo> ThermalCamera::scanDevices() {
-        i3::TEScanData devs[MAX_USB_NUM];
-        std::vector<DeviceInfo> list;
-        if (i3::ScanTE(devs) == 1) {
-            for (int i = 0; i < MAX_USB_NUM; ++i) {
-                if (devs[i].bDevCon) {
-                    list.push_back({
-                        static_cast<unsigned int>(i),
-                        devs[i].nProdVer,
-                        devs[i].nCoreID
-                    });
-                }
-            }
+        return scanDeviceBackends();
+    }
+
+    int ThermalCamera::modelForProduct(unsigned int productVersion) {
+        switch (productVersion) {
+            case I3_TE_Q1:  return 1;
+            case I3_TE_V1:  return 2;
+            case I3_TE_EQ1:
+            case I3_TE_EV1:
+            case I3_TE_EQ2:
+            case I3_TE_EV2: return 3;
+            case I3_TE_Q2:  return 4;
+            default:        return 0;
         }
-        return list;
     }
 
     void ThermalCamera::setHotplugCallback(HotplugFn cb) {
-        hotplugCallback_ = std::move(cb);
-        i3::SetHotplugCallback(&ThermalCamera::hotplugProxy);
+        if (globalHotplugToken_ >= 0)
+            HotplugDispatcher::unsubscribe(globalHotplugToken_);
+        globalHotplugToken_ = cb
+            ? HotplugDispatcher::subscribe(HotplugDispatcher::ANY_DEVICE, std::move(cb))
+            : -1;
     }
 
+    void ThermalCamera::injectHotplug(i3::TE_STATE state) {
+        HotplugDispatcher::inject(state);
+    }
+
+    void ThermalCamera::onHotplug(HotplugFn cb) {
+        std::lock_guard<std::mutex> lk(link_->mutex);
+        link_->user = std::move(cb);
+    }
+
+    // — Device as a frame source — 
+    // Forwards to whichever backend is open right now; the backend itself
+    // comes and goes with open()/close() and reconnects.
+    class ThermalCamera::DeviceSource : public FrameSource {
+        public:
+            explicit DeviceSource(ThermalCamera& cam) : cam_(cam) {}
+
+            int width() const override  { return cam_.dev_ ? cam_.dev_->width() : 0; }
+            int height() const override { return cam_.dev_ ? cam_.dev_->height() : 0; }
+            int frameType(bool applyAgc) const override {
+                return cam_.dev_ ? cam_.dev_->frameType(applyAgc) : CV_16U;
+            }
+            double nominalFps() const override {
+                return cam_.dev_ ? cam_.dev_->nominalFps() : 0;
+            }
+            std::chrono::steady_clock::time_point nextFrameAt() const override {
+                return cam_.dev_ ? cam_.dev_->nextFrameAt() : FrameSource::nextFrameAt();
+            }
+            int read(cv::Mat& dst, bool applyAgc) override {
+                if (cam_.dev_) return cam_.dev_->read(dst, applyAgc);
+                return 4;   // data read fail: nothing open
+            }
+            int temperatureType() const override {
+                return cam_.dev_ ? cam_.dev_->temperatureType() : -1;
+            }
+            bool readTemperature(cv::Mat& dst) override {
+                return cam_.dev_ && cam_.dev_->readTemperature(dst);
+            }
+            bool temperatureAt(int x, int y, float& celsius) override {
+                return cam_.dev_ && cam_.dev_->temperatureAt(x, y, celsius);
+            }
+            float fpaTemperature() override {
+                if (cam_.dev_) return cam_.dev_->fpaTemperature();
+                return FrameSource::fpaTemperature();
+            }
+
+        private:
+            ThermalCamera& cam_;
+        };
+
+    // The device as seen by a reconnecting stream: read() doesn't fail when
+    // the camera goes away, it waits until the camera is back (or the
+    // stream is stopped). Geometry is fixed at stream start, so it stays
+    // valid while the handles are closed.
+    class ThermalCamera::ReconnectingSource : public FrameSource {
+        public:
+            explicit ReconnectingSource(ThermalCamera& cam)
+                : cam_(cam), w_(cam.device_->width()), h_(cam.device_->height()),
+                  family_(cam.dev_->family()) {}
+
+            int width() const override  { return w_; }
+            int height() const override { return h_; }
+            int frameType(bool applyAgc) const override {
+                return (family_ == DeviceFamily::TE_B && !applyAgc) ? CV_32F : CV_16U;
+            }
+            double nominalFps() const override { return cam_.device_->nominalFps(); }
+            int temperatureType() const override {
+                return family_ == DeviceFamily::TE_B ? CV_32F : CV_16U;
+            }
+            bool readTemperature(cv::Mat& dst) override {
+                return cam_.device_->readTemperature(dst);
+            }
+            bool temperatureAt(int x, int y, float& celsius) override {
+                return cam_.device_->temperatureAt(x, y, celsius);
+            }
+            float fpaTemperature() override { return cam_.device_->fpaTemperature(); }
+            int readAttempts() const override { return 1; }
+
+            int read(cv::Mat& dst, bool applyAgc) override {
+                while (cam_.streaming_) {
+                    if (!cam_.link_->down) {
+                        int attempts = cam_.link_->awaitingFirst ? WARMUP_ATTEMPTS : 0;
+                        int ret = readFrame(*cam_.device_, dst, applyAgc, attempts);
+                        if (ret == 1) {
+                            cam_.linkFrame();
+                            return 1;
+                        }
+                        if (cam_.metrics_->enabled()) cam_.metrics_->countRetry(ret);
+                        cam_.linkLost();
+                    }
+                    if (!cam_.reconnect()) break;
+                }
+                return 4;   // stopped while the camera was away
+            }
+
+        private:
+            ThermalCamera& cam_;
+            int  w_, h_;
+            DeviceFamily family_;
+        };
+
+
+    // an asynchronous capture, from captureFrameAsync to its callback
+    struct ThermalCamera::CaptureOp {
+        CaptureExecutor* executor;
+        bool             applyAgc;
+        CaptureFn        done;
+        int              attempts;          // readFrame's budget
+        int              failed{0};
+        bool             waited{false};     // for the camera's next frame
+    };
+
+    // the device reads one capture at a time; the rest wait their turn here
+    struct ThermalCamera::CaptureQueue {
+        std::mutex                             mutex;
+        std::condition_variable                idle;
+        std::deque<std::shared_ptr<CaptureOp>> waiting;
+        bool                                   busy{false};
+        int                                    pending{0};  // waiting or running
+    };
+
+
     // — Construction / Destruction — 
-    ThermalCamera::ThermalCamera() = default;
+    ThermalCamera::ThermalCamera()
+        : pool_(FramePool::create()),
+          device_(std::make_shared<DeviceSource>(*this)),
+          metrics_(std::make_shared<CameraMetrics>()),
+          captures_(new CaptureQueue),
+          link_(std::make_shared<Link>()) {}
     ThermalCamera::~ThermalCamera() {
+        stopMetricsServer();
         close();
+        pool_->release();
     }
 
 
     // — Open / Close — 
     bool ThermalCamera::open(int model, unsigned int devNum) {
+        // the serial is looked up later, if anything needs it
+        return open(model, DeviceInfo{devNum, 0, 0});
+    }
+
+    bool ThermalCamera::open(int model, const DeviceInfo& dev) {
         close();
-        if (model == 1) {
-            teB_ = i3::OpenTE_B(I3_TE_Q1, devNum);
+        const unsigned int devNum = dev.deviceNumber, serial = dev.serialNumber;
+        {
+            std::lock_guard<std::mutex> lk(readMutex_);
+            if (!openHandles(model, devNum)) return false;
         }
-        else if (model == 2) {
-            teB_ = i3::OpenTE_B(I3_TE_V1, devNum);
+        {
+            std::lock_guard<std::mutex> lk(link_->mutex);
+            link_->model        = model;
+            link_->deviceNumber = devNum;
+            link_->serial       = serial;
+            link_->down         = false;
+            link_->awaitingFirst = false;
+            link_->arrived      = false;
+            link_->inOutage     = false;
+            link_->stats        = {true, 0, 0, 0, 0, 0};
         }
-        else if (model == 3) {
-            teA_ = i3::OpenTE_A(devNum);
-        } else {
-            return false;
+        subscribeHotplug();
+        // the cache finds entries by serial
+        const unsigned int key =
+            std::atomic_load(&calibrationCache_) ? serialNumber() : serial;
+        size_t px;
+        bool   teB;
+        {
+            std::lock_guard<std::mutex> lk(readMutex_);
+            restoreCalibration(model, key);
+            px  = size_t(dev_->width()) * dev_->height();
+            teB = dev_->family() == DeviceFamily::TE_B;
         }
-        return (teA_ != nullptr) || (teB_ != nullptr);
+
+        // Pre-size the pool for this sensor: a few raw/temperature frames
+        // plus the 8-bit and colorized outputs, so even the first frames
+        // are served without touching the heap.
+        const int POOL_DEPTH = 4;
+        pool_->reserve(px * sizeof(unsigned short), 2 * POOL_DEPTH);
+        pool_->reserve(px, POOL_DEPTH);
+        pool_->reserve(px * 3, POOL_DEPTH);
+        if (teB) pool_->reserve(px * sizeof(float), POOL_DEPTH);
+        return true;
+    }
+
+    // caller holds readMutex_
+    unsigned int ThermalCamera::serialNumber() const {
+        unsigned int devNum;
+        {
+            std::lock_guard<std::mutex> lk(link_->mutex);
+            if (link_->serial) return link_->serial;
+            devNum = link_->deviceNumber;
+        }
+        unsigned int serial = 0;
+        for (const DeviceInfo& d : scanDevices())
+            if (d.deviceNumber == devNum) serial = d.serialNumber;
+        std::lock_guard<std::mutex> lk(link_->mutex);
+        if (!link_->serial) link_->serial = serial;
+        return link_->serial;
+    }
+
+    bool ThermalCamera::openHandles(int model, unsigned int devNum) {
+        dev_ = openDeviceBackend(model, devNum);
+        if (!dev_) return false;
+        kernels_ = &modelKernels(dev_->family(), dev_->width(), dev_->height());
+        return true;
+    }
+
+    ReadyResult ThermalCamera::waitUntilReady(const ReadyProbe& probe) {
+        ReadyResult r{false, 0, 0, 0.0};
+        cv::Mat raw;
+        const auto start = std::chrono::steady_clock::now();
+        const auto deadline = start + probe.timeout;
+        auto delay = std::max(probe.firstDelay, std::chrono::milliseconds(1));
+        const auto maxDelay = std::max(probe.maxDelay, delay);
+        auto now = start;
+        for (;;) {
+            {
+                // between probes a stream or capture may read, or a
+                // reconnecting stream close the camera
+                std::lock_guard<std::mutex> lk(readMutex_);
+                if (!deviceUp()) break;
+                if (raw.empty())
+                    pool_->acquire(raw, device_->height(), device_->width(),
+                                   device_->frameType(probe.applyAgc));
+                ++r.probes;
+                deviceTracker_.retire();
+                // single reads, kept out of the metrics: warm-up isn't a failure
+                r.lastCode = readFrame(*device_, raw, probe.applyAgc, 1);
+            }
+            now = std::chrono::steady_clock::now();
+            if (r.lastCode == 1) {
+                r.ready = true;
+                break;
+            }
+            if (now + delay > deadline) break;
+            std::this_thread::sleep_for(delay);
+            delay = std::min(delay * 2, maxDelay);
+        }
+        r.waitMs = Millis(now - start).count();
+        return r;
     }
 
     void ThermalCamera::close() {
-        if (teA_) { teA_->CloseTE(); teA_ = nullptr; }
-        if (teB_) { teB_->CloseTE(); teB_ = nullptr; }
+        // stop readers before the handles go away
         stopStream();
+        waitForCaptures();
+        if (hotplugToken_ >= 0) {
+            HotplugDispatcher::unsubscribe(hotplugToken_);
+            hotplugToken_ = -1;
+        }
+        {
+            std::lock_guard<std::mutex> lk(readMutex_);
+            closeHandles();
+        }
+        std::lock_guard<std::mutex> lk(link_->mutex);
+        link_->stats.connected = false;
+    }
+
+    void ThermalCamera::closeHandles() {
+        dev_.reset();
+    }
+
+    void ThermalCamera::restoreCalibration(int model, unsigned int serial) {
+        auto cache = std::atomic_load(&calibrationCache_);
+        // without a serial there is no telling which camera this is
+        calibrationRestored_ = cache && serial && dev_ && cache->load(*dev_, serial, model);
+    }
+
+    void ThermalCamera::subscribeHotplug() {
+        if (hotplugToken_ >= 0) HotplugDispatcher::unsubscribe(hotplugToken_);
+        // the handler holds the Link, not us: it may fire after we're gone
+        std::shared_ptr<Link> link = link_;
+        hotplugToken_ = HotplugDispatcher::subscribe(
+            int(link->deviceNumber),
+            [link](i3::TE_STATE state) { link->handle(state); });
+    }
+
+
+    // — Reconnect — 
+    void ThermalCamera::linkLost() {
+        std::lock_guard<std::mutex> lk(link_->mutex);
+        link_->lose();
+        link_->down = true;
+    }
+
+    void ThermalCamera::linkFrame() {
+        if (!link_->awaitingFirst) return;
+        Link& l = *link_;
+        LinkStats snapshot;
+        std::function<void(const LinkStats&)> cb;
+        {
+            std::lock_guard<std::mutex> lk(l.mutex);
+            auto now = std::chrono::steady_clock::now();
+            l.awaitingFirst = false;
+            l.stats.connected = true;
+            l.stats.lastTimeToFirstFrameMs = Millis(now - l.reopenedAt).count();
+            l.stats.totalDowntimeMs += Millis(now - l.lostAt).count();
+            snapshot = l.stats;
+            cb = l.onReconnect;
+        }
+        std::cerr << "[INFO] device #" << l.deviceNumber << " back: outage "
+                  << snapshot.lastOutageMs << " ms, first frame after "
+                  << snapshot.lastTimeToFirstFrameMs << " ms\n";
+        if (cb) cb(snapshot);
+    }
+
+    bool ThermalCamera::deviceUp() const {
+        return dev_ && !link_->down;
+    }
+
+    // Called from the stream's read with readMutex_ held (streamLoop or the
+    // pipeline's acquisition took it). It is let go of for the outage, so
+    // captures meanwhile find the camera closed and fail at once, and taken
+    // back before returning.
+    bool ThermalCamera::reconnect() {
+        Link& l = *link_;
+        // every frame is pinned by now (the stream retires before reading),
+        // so nothing touches the handles while they're closed
+        closeHandles();
+        readMutex_.unlock();
+        std::cerr << "[WARN] device #" << l.deviceNumber
+                  << " lost, waiting for it to come back\n";
+
+        std::unique_lock<std::mutex> lk(l.mutex);
+        auto delay = RECONNECT_MIN_DELAY;
+        while (streaming_) {
+            // an arrival cuts the wait short; stopStream() wakes us too
+            l.cv.wait_for(lk, delay, [&] { return l.arrived || !streaming_; });
+            if (!streaming_) break;
+            l.arrived = false;
+            ++l.stats.reconnectAttempts;
+            const int model = l.model;
+            const unsigned int serial = l.serial;
+            unsigned int devNum = l.deviceNumber;
+            lk.unlock();
+
+            // it may have come back under another device number
+            if (serial)
+                for (const DeviceInfo& d : scanDevices())
+                    if (d.serialNumber == serial) devNum = d.deviceNumber;
+            // kept from here on if the camera opens: the stream reads next
+            readMutex_.lock();
+            bool ok = openHandles(model, devNum);
+            if (ok) restoreCalibration(model, serial);
+            else    readMutex_.unlock();
+
+            lk.lock();
+            if (ok) {
+                bool moved = devNum != l.deviceNumber;
+                l.deviceNumber  = devNum;
+                l.reopenedAt    = std::chrono::steady_clock::now();
+                l.stats.lastOutageMs = Millis(l.reopenedAt - l.lostAt).count();
+                l.inOutage      = false;
+                l.down          = false;
+                l.awaitingFirst = true;
+                lk.unlock();
+                if (moved) subscribeHotplug();
+                return true;
+            }
+            delay = std::min(delay * 2, RECONNECT_MAX_DELAY);
+        }
+        // readMutex_ before the link's, as everywhere else
+        lk.unlock();
+        readMutex_.lock();
+        return false;
+    }
+
+    LinkStats ThermalCamera::linkStats() const {
+        std::lock_guard<std::mutex> lk(link_->mutex);
+        return link_->stats;
     }
 
 
     // — Single‐frame capture — 
     cv::Mat ThermalCamera::captureImage(bool applyAgc) {
-        const int MAX_RETRIES = 3;
-        int retry = 0, ret = 0;
-        cv::Mat gray8;
-
-        if (teA_) {
-            // 1) Get image size
-            int w = teA_->GetImageWidth(), h = teA_->GetImageHeight();
-            // 2) Allocate buffer
-            auto buf = new unsigned short[w*h];
-            
-            // 3) Capture image
-            // Retry if the first attempt fails
-            // (e.g. if the camera is still warming up)
-            do {
-                ret = teA_->RecvImage(buf, applyAgc);
-                if (ret == 1) break;
-                std::cerr << "[WARN] RecvImage failed (code=" << ret
-                        << "), retrying " << (retry+1) << "/" << MAX_RETRIES << "\n";
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            } while (++retry < MAX_RETRIES);
-
-            if (ret != 1) {
-                std::cerr << "[ERROR] captureImage: giving up after " 
-                          << MAX_RETRIES << " retries (last code=" << ret << ")\n";
-                delete[] buf;
-                return {};  // still no image
-            }
-            // 4) Convert to 8-bit grayscale
-            cv::Mat raw16(h, w, CV_16U, buf);
-            
-            cv::Mat gray8;
-            if (applyAgc) {     // (AGC is applied in the camera, so we can use 8-bit directly)
-                raw16.convertTo(gray8, CV_8U, 1.0/256.0);
-            } else {    
-                double mn, mx;
-                cv::minMaxLoc(raw16, &mn, &mx);
-                raw16.convertTo(
-                    gray8,
-                    CV_8U,
-                    255.0/(mx - mn),
-                    -mn * 255.0/(mx - mn)
-                );
-            }
-
-            delete[] buf;
-
-            // now colorize and return
-            cv::Mat color;
-            cv::applyColorMap(gray8, color, cv::COLORMAP_JET);
-            return color;
-
-        }
-        else if (teB_) {
-            int w = teB_->GetImageWidth(), h = teB_->GetImageHeight();
-            if (applyAgc) {
-                auto buf = new unsigned short[w*h];
-                if (teB_->RecvImage(buf) == 1) {
-                    cv::Mat img(h, w, CV_16U, buf);
-                    delete[] buf;
-                    return img;
+        cv::Mat img;
+        if (!captureInto(img, applyAgc)) return {};
+        return img;
+    }
+
+    bool ThermalCamera::captureInto(cv::Mat& out, bool applyAgc) {
+        std::unique_lock<std::mutex> lk(readMutex_);
+        if (!deviceUp()) return false;
+        deviceTracker_.retire();
+
+        // 1) Take a raw buffer of the sensor's size from the pool
+        cv::Mat raw;
+        pool_->acquire(raw, device_->height(), device_->width(),
+                       device_->frameType(applyAgc));
+        // 2) Capture image (retries while the camera warms up)
+        if (readFrame(*device_, raw, applyAgc, 0, metrics_.get()) != 1)
+            return false;  // still no image
+        const bool passRaw16 = dev_->family() == DeviceFamily::TE_B;
+        lk.unlock();
+        // 3) Convert / colorize into the caller's frame
+        render(*pool_, raw, out, applyAgc, passRaw16, palette_, *kernels_,
+               metrics_.get());
+        if (metrics_->enabled()) metrics_->countFrame();
+        return true;
+    }
+
+    Frame ThermalCamera::captureFrame(bool applyAgc) {
+        std::lock_guard<std::mutex> lk(readMutex_);
+        if (!deviceUp()) return {};
+        deviceTracker_.retire();
+
+        cv::Mat raw;
+        pool_->acquire(raw, device_->height(), device_->width(),
+                       device_->frameType(applyAgc));
+        if (readFrame(*device_, raw, applyAgc, 0, metrics_.get()) != 1)
+            return {};
+        if (metrics_->enabled()) metrics_->countFrame();
+
+        FrameInfo info{0, std::chrono::steady_clock::now(), 0,
+                       device_->fpaTemperature()};
+        Frame f = makeFrame(device_, std::move(raw), info, applyAgc, true);
+        deviceTracker_.track(f);
+        return f;
+    }
+
+
+    // — Asynchronous capture — 
+    void ThermalCamera::captureFrameAsync(CaptureFn done, bool applyAgc,
+                                          CaptureExecutor* executor) {
+        auto op = std::make_shared<CaptureOp>();
+        op->executor = executor ? executor : &CaptureExecutor::shared();
+        op->applyAgc = applyAgc;
+        op->done     = std::move(done);
+        {
+            std::lock_guard<std::mutex> lk(readMutex_);
+            op->attempts = std::max(1, device_->readAttempts());
+        }
+        {
+            std::lock_guard<std::mutex> lk(captures_->mutex);
+            ++captures_->pending;
+            if (captures_->busy) {
+                captures_->waiting.push_back(op);
+                return;
+            }
+            captures_->busy = true;
+        }
+        op->executor->post([this, op] { stepCapture(op); });
+    }
+
+    void ThermalCamera::stepCapture(const std::shared_ptr<CaptureOp>& op) {
+        // RecvImage would block until the frame is in: come back then
+        if (!op->waited) {
+            op->waited = true;
+            std::chrono::steady_clock::time_point due;
+            {
+                // now, if the camera is closed: the read below finds out
+                std::lock_guard<std::mutex> lk(readMutex_);
+                due = device_->nextFrameAt();
+            }
+            if (due > std::chrono::steady_clock::now()) {
+                op->executor->postAt(due, [this, op] { stepCapture(op); });
+                return;
+            }
+        }
+
+        CameraMetrics* metrics = metrics_->enabled() ? metrics_.get() : nullptr;
+        Frame f;
+        int ret = 0;
+        bool closed = false;
+        {
+            // a stream or a synchronous capture may be reading too; the
+            // callback runs after the device is free again
+            std::lock_guard<std::mutex> lk(readMutex_);
+            if (!deviceUp()) {
+                closed = true;
+            } else {
+                deviceTracker_.retire();
+                cv::Mat raw;
+                pool_->acquire(raw, device_->height(), device_->width(),
+                               device_->frameType(op->applyAgc));
+                {
+                    StageTimer timer(metrics, Stage::Read);
+                    ret = device_->read(raw, op->applyAgc);
+                }
+                if (ret == 1) {
+                    FrameInfo info{0, std::chrono::steady_clock::now(), 0,
+                                   device_->fpaTemperature()};
+                    f = makeFrame(device_, std::move(raw), info, op->applyAgc, true);
+                    deviceTracker_.track(f);
                 }
-                delete[] buf;
+            }
+        }
+        if (closed) {
+            finishCapture(op, Frame());
+            return;
+        }
+        if (ret != 1) {
+            if (metrics) metrics->countRetry(ret);
+            if (++op->failed < op->attempts) {
+                // still warming up: retry from the timer, not a sleep
+                std::cerr << "[WARN] RecvImage failed (code=" << ret
+                          << "), retrying " << op->failed << "/" << op->attempts << "\n";
+                op->executor->postAt(std::chrono::steady_clock::now() + CAPTURE_RETRY_DELAY,
+                                     [this, op] { stepCapture(op); });
+                return;
+            }
+            if (metrics) metrics->countReadFailure();
+            if (op->attempts > 1)
+                std::cerr << "[ERROR] captureFrameAsync: giving up after "
+                          << op->attempts << " retries (last code=" << ret << ")\n";
+            finishCapture(op, Frame());
+            return;
+        }
+        if (metrics) metrics->countFrame();
+        finishCapture(op, f);
+    }
+
+    void ThermalCamera::finishCapture(const std::shared_ptr<CaptureOp>& op,
+                                      const Frame& f) {
+        // hand the device to the next capture first; the tracker fetches
+        // this frame's temperature map before that one reads
+        std::shared_ptr<CaptureOp> next;
+        {
+            std::lock_guard<std::mutex> lk(captures_->mutex);
+            if (captures_->waiting.empty()) {
+                captures_->busy = false;
             } else {
-                auto buf = new float[w*h];
-                if (teB_->RecvImage(buf) == 1) {
-                    cv::Mat img32(h, w, CV_32F, buf);
-                    cv::Mat out; img32.convertTo(out, CV_8U, 1./256.);
-                    delete[] buf;
-                    return out;
+                next = captures_->waiting.front();
+                captures_->waiting.pop_front();
+            }
+        }
+        if (next) next->executor->post([this, next] { stepCapture(next); });
+
+        if (op->done) op->done(f);
+        std::lock_guard<std::mutex> lk(captures_->mutex);
+        if (--captures_->pending == 0) captures_->idle.notify_all();
+    }
+
+    void ThermalCamera::waitForCaptures() {
+        std::unique_lock<std::mutex> lk(captures_->mutex);
+        captures_->idle.wait(lk, [this] { return captures_->pending == 0; });
+    }
+
+    std::future<cv::Mat> ThermalCamera::captureImageAsync(bool applyAgc,
+                                                          CaptureExecutor* executor) {
+        auto promise = std::make_shared<std::promise<cv::Mat>>();
+        std::future<cv::Mat> result = promise->get_future();
+        captureFrameAsync([promise](const Frame& f) {
+            promise->set_value(f.empty() ? cv::Mat() : f.color());
+        }, applyAgc, executor);
+        return result;
+    }
+
+    std::future<TempStats> ThermalCamera::getTemperatureStatsAsync(bool applyAgc,
+                                                                   CaptureExecutor* executor) {
+        auto promise = std::make_shared<std::promise<TempStats>>();
+        std::future<TempStats> result = promise->get_future();
+        captureFrameAsync([promise](const Frame& f) {
+            promise->set_value(f.empty() ? TempStats{} : f.stats());
+        }, applyAgc, executor);
+        return result;
+    }
+
+
+    // — Burst capture — 
+    bool ThermalCamera::captureBurstInto(BurstTensor& out, int n,
+                                         const BurstLayout& layout) {
+        // back to back: nothing else reads in between
+        std::lock_guard<std::mutex> lk(readMutex_);
+        if (!deviceUp() || n <= 0 || !validBurstLayout(layout)) return false;
+        const int  w = device_->width(), h = device_->height();
+        const int  rawType = device_->frameType(layout.applyAgc);
+        const bool celsius = layout.data == BurstData::Celsius;
+        const int  tempType = device_->temperatureType();
+        if (celsius && tempType < 0) {
+            std::cerr << "[ERROR] captureBurst: camera has no temperature map\n";
+            return false;
+        }
+        prepareBurst(out, n, h, w, layout.type);
+        deviceTracker_.retire();
+
+        // frames that don't go straight into the tensor land here first:
+        // the raw frame of a temperature burst, and whatever is of another
+        // type than the tensor
+        cv::Mat raw, temp;
+        if (celsius || rawType != layout.type)
+            pool_->acquire(raw, h, w, rawType);
+        if (celsius && tempType != layout.type)
+            pool_->acquire(temp, h, w, tempType);
+
+        for (int i = 0; i < n; ++i) {
+            cv::Mat slot = out.frame(i);
+            cv::Mat& dst = raw.empty() ? slot : raw;
+            if (readFrame(*device_, dst, layout.applyAgc, 0, metrics_.get()) != 1)
+                return false;
+            if (metrics_->enabled()) metrics_->countFrame();
+            out.info[i] = FrameInfo{uint64_t(i), std::chrono::steady_clock::now(), 0,
+                                    device_->fpaTemperature()};
+            if (celsius) {
+                cv::Mat& map = temp.empty() ? slot : temp;
+                if (!device_->readTemperature(map)) return false;
+                if (!temp.empty()) {
+                    // a TE_A map into a °C tensor: the model's fixed-size loop
+                    if (layout.type == CV_32F) kernels_.load()->celsius(temp, slot);
+                    else                       convertBurstFrame(temp, slot, true);
                 }
-                delete[] buf;
+            } else if (!raw.empty()) {
+                convertBurstFrame(raw, slot, false);
             }
+            normalizeBurstFrame(slot, layout.normalize);
         }
-        return {};
+        return true;
+    }
+
+    BurstTensor ThermalCamera::captureBurst(int n, const BurstLayout& layout) {
+        BurstTensor out;
+        if (!captureBurstInto(out, n, layout)) return {};
+        return out;
+    }
+
+    Frame ThermalCamera::makeFrame(const std::shared_ptr<FrameSource>& src,
+                                   cv::Mat raw, const FrameInfo& info,
+                                   bool applyAgc, bool withTemperature,
+                                   std::shared_ptr<const OutputSet> outputs) {
+        // The render step must not reach back into the camera: a Frame may
+        // outlive it. The pool stays alive as long as the raw Mat does.
+        FramePool* pool = pool_;
+        const bool fromDevice = src == device_ ||
+                                dynamic_cast<ReconnectingSource*>(src.get());
+        bool passRaw16 = fromDevice && dev_ && dev_->family() == DeviceFamily::TE_B;
+        // the device's were picked at open; another source's by its size
+        const ModelKernels* kernels = fromDevice
+            ? kernels_.load()
+            : &modelKernels(src->temperatureType() == CV_32F ? DeviceFamily::TE_B
+                                                             : DeviceFamily::TE_A,
+                            src->width(), src->height());
+        int palette = palette_;
+        auto roiSet = rois_.snapshot();
+        auto blobOpts = std::atomic_load(&blobOptions_);
+        const bool alarms = !alarms_.empty();
+        const bool gridTemp = outputs && needsTemperature(*outputs);
+        std::shared_ptr<CameraMetrics> metrics = metrics_;
+        return Frame(std::move(raw), info,
+                     [pool, applyAgc, passRaw16, palette, kernels, metrics](
+                             const cv::Mat& r, cv::Mat& out) {
+                         render(*pool, r, out, applyAgc, passRaw16, palette,
+                                *kernels, metrics.get());
+                     },
+                     (withTemperature || roiSet || blobOpts || alarms || gridTemp)
+                         ? src : nullptr, pool,
+                     std::move(roiSet), withTemperature, std::move(blobOpts),
+                     std::move(outputs), kernels);
+    }
+
+    void ThermalCamera::render(FramePool& pool, const cv::Mat& raw, cv::Mat& out,
+                               bool applyAgc, bool passRaw16, int palette,
+                               const ModelKernels& kernels, CameraMetrics* metrics) {
+        const int w = raw.cols, h = raw.rows;
+        if (raw.type() == CV_32F) {     // TE_B without AGC
+            StageTimer timer(metrics, Stage::Convert);
+            pool.acquire(out, h, w, CV_8U);
+            raw.convertTo(out, CV_8U, 1./256.);
+            return;
+        }
+        if (passRaw16) {                // TE_B with AGC
+            if (out.rows == h && out.cols == w && out.type() == CV_16U)
+                raw.copyTo(out);
+            else
+                out = raw;
+            return;
+        }
+
+        // Range mapping, 8-bit quantization and palette lookup in one pass,
+        // straight into the output (AGC is applied in the camera, so its
+        // top byte is used as is; otherwise the frame's min/max is stretched)
+        StageTimer timer(metrics, Stage::Colorize);
+        pool.acquire(out, h, w, CV_8UC3);
+        kernels.colorize(raw, out, palette, applyAgc);
     }
 
     // — Streaming — 
     void ThermalCamera::startStream(std::function<void(const cv::Mat&)> cb,
-                                    bool applyAgc) {
-        if (streaming_ || !cb) return;
+                                    bool applyAgc,
+                                    const StreamOptions& opts) {
+        if (!cb) return;
+        startStream([cb](const Frame& f) { cb(f.color()); }, applyAgc, opts);
+    }
+
+    void ThermalCamera::startStream(FrameFn cb, bool applyAgc,
+                                    const StreamOptions& opts) {
+        if (!cb) return;
+        startStream([cb](const Frame& f) { cb(f.color(), f.info()); },
+                    applyAgc, opts);
+    }
+
+    void ThermalCamera::startStream(bool applyAgc, const StreamOptions& opts) {
+        startStream(FrameCb(), applyAgc, opts);
+    }
+
+    // a null callback streams to the subscribers alone
+    void ThermalCamera::startStream(FrameCb cb, bool applyAgc,
+                                    const StreamOptions& opts) {
+        if (streaming_) return;
+        // a stream whose source gave up has ended on its own; reap it
+        if (streamThread_.joinable()) streamThread_.join();
+        if (pipeline_) {
+            pipeline_->stop();
+            pipeline_.reset();
+        }
+        std::shared_ptr<FrameSource> src = device_;
+        double fps = opts.targetFps;
+        {
+            // the camera's geometry and rate, taken while nothing swaps dev_
+            std::lock_guard<std::mutex> rd(readMutex_);
+            if (!opts.source && !dev_) return;
+            if (opts.source) {
+                src = opts.source;
+            } else if (opts.reconnect) {
+                // to find the camera again should it come back elsewhere
+                serialNumber();
+                src = std::make_shared<ReconnectingSource>(*this);
+                std::lock_guard<std::mutex> lk(link_->mutex);
+                link_->onReconnect = opts.onReconnect;
+            }
+            if (fps <= 0) fps = src->nominalFps();
+        }
+        FrameTracker* tracker = opts.source ? &sourceTracker_ : &deviceTracker_;
+        const bool withTemp = opts.temperature;
+        std::shared_ptr<const OutputSet> outputs;
+        if (!opts.outputs.empty())
+            outputs = std::make_shared<const OutputSet>(opts.outputs);
+
+        // explicit target, else what the source says, else the old 30 fps
+        if (fps <= 0 || fps > 1000) fps = 30.0;
+        pacer_.reset(fps, opts.catchUp);
+        paced_ = opts.paced;
+
         frameCallback_ = std::move(cb);
         streaming_ = true;
-        streamThread_ = std::thread(&ThermalCamera::streamLoop, this, applyAgc);
+        if (opts.pipelined) {
+            StreamPipeline::Config cfg;
+            cfg.applyAgc     = applyAgc;
+            cfg.workers      = opts.workers;
+            cfg.ringCapacity = opts.ringCapacity;
+            cfg.pacer        = paced_ ? &pacer_ : nullptr;
+            cfg.tracker      = tracker;
+            cfg.readMutex    = opts.source ? nullptr : &readMutex_;
+            cfg.cpu          = opts.cpu;
+            cfg.metrics      = metrics_.get();
+            // ends the stream as streamLoop does when its reads give up
+            cfg.onSourceDone = [this] { streaming_ = false; };
+            pipeline_.reset(new StreamPipeline(
+                src, pool_,
+                [this, src, applyAgc, withTemp, outputs](cv::Mat raw, const FrameInfo& info) {
+                    Frame f = makeFrame(src, std::move(raw), info, applyAgc, withTemp,
+                                        outputs);
+                    checkAlarms(f);
+                    return f;
+                },
+                // conversion, colorization (or the reduced outputs), stats
+                // and hotspots happen on the workers
+                [withTemp, outputs](const Frame& f) {
+                    if (outputs) f.outputs();
+                    else         f.color();
+                    f.rois();
+                    f.blobs();
+                    if (withTemp) f.stats();
+                },
+                [this](const Frame& f) { deliver(f); }, cfg));
+            pipeline_->start();
+        } else {
+            streamThread_ = std::thread(&ThermalCamera::streamLoop, this,
+                                        src, applyAgc, withTemp, outputs,
+                                        tracker, opts.cpu);
+        }
     }
 
     void ThermalCamera::stopStream() {
-        streaming_ = false;
+        {
+            // under the lock, so a reconnect can't miss the wake-up
+            std::lock_guard<std::mutex> lk(link_->mutex);
+            streaming_ = false;
+        }
+        link_->cv.notify_all();
         if (streamThread_.joinable())
             streamThread_.join();
+        if (pipeline_) {
+            pipeline_->stop();
+            pipeline_.reset();
+        }
+    }
+
+    PipelineStats ThermalCamera::streamStats() const {
+        if (pipeline_) return pipeline_->stats();
+        return {0, 0, 0, 0, 0, 0};
     }
 
-    void ThermalCamera::streamLoop(bool applyAgc) {
+    PacerStats ThermalCamera::pacingStats() const {
+        return pacer_.stats();
+    }
+
+    void ThermalCamera::streamLoop(std::shared_ptr<FrameSource> src,
+                                   bool applyAgc, bool withTemperature,
+                                   std::shared_ptr<const OutputSet> outputs,
+                                   FrameTracker* tracker, int cpu) {
+        if (cpu >= 0) pinCurrentThread(cpu);
+        uint64_t seq = 0, delivered = 0;
         while (streaming_) {
-            cv::Mat f = captureImage(applyAgc);
-            if (f.empty()) break;
-            frameCallback_(f);
-            usleep(33000);
+            // sleeps to the next absolute deadline, so capture and callback
+            // time come out of the frame period instead of adding to it
+            if (paced_) {
+                uint64_t skipped = pacer_.wait();
+                seq += skipped;
+                if (metrics_->enabled()) metrics_->countDropped(skipped);
+            }
+            std::unique_lock<std::mutex> reading;
+            if (tracker == &deviceTracker_) reading = std::unique_lock<std::mutex>(readMutex_);
+            tracker->retire();
+
+            cv::Mat raw;
+            pool_->acquire(raw, src->height(), src->width(),
+                           src->frameType(applyAgc));
+            if (readFrame(*src, raw, applyAgc, 0, metrics_.get()) != 1) break;
+
+            FrameInfo info;
+            info.sequence  = seq++;
+            info.timestamp = std::chrono::steady_clock::now();
+            info.dropped   = info.sequence - delivered;
+            info.fpaTemp   = src->fpaTemperature();
+
+            Frame f = makeFrame(src, std::move(raw), info, applyAgc,
+                                withTemperature, outputs);
+            checkAlarms(f);
+            tracker->track(f);
+            if (reading) reading.unlock();
+            deliver(f);
+            ++delivered;
         }
         streaming_ = false;
     }
 
+    void ThermalCamera::deliver(const Frame& f) {
+        // subscribers first: queueing never waits on them (but Block)
+        fanout_.publish(f);
+        if (frameCallback_) {
+            StageTimer timer(metrics_.get(), Stage::Callback);
+            frameCallback_(f);
+        }
+        if (metrics_->enabled()) metrics_->countFrame();
+    }
+
+    // — Subscribers — 
+    int ThermalCamera::subscribe(FrameCb cb, const SubscribeOptions& opts) {
+        return fanout_.subscribe(std::move(cb), opts);
+    }
+
+    bool ThermalCamera::unsubscribe(int id) {
+        return fanout_.unsubscribe(id);
+    }
+
     // — Temperature statistics — 
     TempStats ThermalCamera::getTemperatureStats(bool applyAgc) {
-        TempStats s{0,0,{0,0},{0,0}};
-        if (teA_) {
-            int w = teA_->GetImageWidth(), h = teA_->GetImageHeight();
-            auto imgBuf  = new unsigned short[w*h];
-            auto tempBuf = new unsigned short[w*h];
-            if (teA_->RecvImage(imgBuf, applyAgc) == 1) {
-                teA_->CalcTemp(tempBuf);
-                unsigned short mn = USHRT_MAX, mx = 0;
-                int minP = 0, maxP = 0;
-                for (int i = 0, sz = w*h; i < sz; ++i) {
-                    if (tempBuf[i] < mn) { mn = tempBuf[i]; minP = i; }
-                    if (tempBuf[i] > mx) { mx = tempBuf[i]; maxP = i; }
-                }
-                s.minTemp = (mn - 5000) / 100.0f;
-                s.maxTemp = (mx - 5000) / 100.0f;
-                s.minLoc  = {minP % w, minP / w};
-                s.maxLoc  = {maxP % w, maxP / w};
-            }
-            delete[] imgBuf; delete[] tempBuf;
-        }
-        else if (teB_) {
-            int w = teB_->GetImageWidth(), h = teB_->GetImageHeight();
-            auto imgBuf  = new unsigned short[w*h];
-            auto tempBuf = new float[w*h];
-            if (teB_->RecvImage(imgBuf) == 1) {
-                teB_->CalcEntireTemp(tempBuf);
-                float mn = FLT_MAX, mx = -FLT_MAX; int minP = 0, maxP = 0;
-                for (int i = 0, sz = w*h; i < sz; ++i) {
-                    if (tempBuf[i] < mn) { mn = tempBuf[i]; minP = i; }
-                    if (tempBuf[i] > mx) { mx = tempBuf[i]; maxP = i; }
-                }
-                s.minTemp = mn; s.maxTemp = mx;
-                s.minLoc  = {minP % w, minP / w};
-                s.maxLoc  = {maxP % w, maxP / w};
-            }
-            delete[] imgBuf; delete[] tempBuf;
-        }
-        return s;
+        Frame f = captureFrame(applyAgc);
+        if (f.empty()) return TempStats{};
+        return f.stats();
+    }
+
+    std::vector<RoiStats> ThermalCamera::measureRois(bool applyAgc) {
+        Frame f = captureFrame(applyAgc);
+        if (f.empty()) return {};
+        return f.rois();
+    }
+
+
+    // — Hotspot detection — 
+    void ThermalCamera::setBlobDetection(const BlobOptions& opts) {
+        std::atomic_store(&blobOptions_, std::shared_ptr<const BlobOptions>(
+                                             std::make_shared<BlobOptions>(opts)));
+    }
+
+    void ThermalCamera::disableBlobDetection() {
+        std::atomic_store(&blobOptions_, std::shared_ptr<const BlobOptions>());
+    }
+
+
+    // — Threshold alarms — 
+    void ThermalCamera::checkAlarms(const Frame& f) {
+        if (alarms_.empty()) return;
+        // read now, while the source still holds this readout
+        const cv::Mat& temp = f.temperatureRaw();
+        if (!temp.empty()) alarms_.evaluate(temp, f.info());
     }
 
 
     // — Calibration & settings — 
     bool ThermalCamera::doCalibration() {
-        if (teA_) return teA_->ShutterCalibrationOn() == 1;
-        if (teB_) return teB_->ShutterCalibrationOn() == 1;
-        return false;
+        // a reconnecting stream may be swapping the handles
+        std::lock_guard<std::mutex> rd(readMutex_);
+        if (!dev_ || dev_->shutterCalibration() != 1) return false;
+        auto cache = std::atomic_load(&calibrationCache_);
+        if (cache) {
+            int model;
+            {
+                std::lock_guard<std::mutex> lk(link_->mutex);
+                model = link_->model;
+            }
+            const unsigned int serial = serialNumber();
+            // a failed store only costs the next open its shortcut
+            if (serial) cache->store(*dev_, serial, model);
+        }
+        return true;
+    }
+
+    void ThermalCamera::setCalibrationCache(std::shared_ptr<CalibrationCache> cache) {
+        std::atomic_store(&calibrationCache_, std::move(cache));
     }
 
     void ThermalCamera::setEmissivity(float e) {
-        if (teA_) teA_->SetEmissivity(e);
-        if (teB_) teB_->SetEmissivity(e);
+        std::lock_guard<std::mutex> lk(readMutex_);
+        if (dev_) dev_->setEmissivity(e);
+        emissivity_ = e;
+    }
+
+    RecordingMeta ThermalCamera::recordingMeta(bool applyAgc,
+                                               bool withTemperature) const {
+        const unsigned int serial = serialNumber();
+        std::lock_guard<std::mutex> lk(readMutex_);
+        return {device_->width(), device_->height(),
+                device_->frameType(applyAgc),
+                withTemperature ? device_->temperatureType() : -1,
+                applyAgc, serial, emissivity_, device_->nominalFps()};
     }
 
 
@@ -233,6 +1030,50 @@ namespace thermal {
         agc_ = enable;
     }
 
+    void ThermalCamera::setColormap(int palette) {
+        palette_ = palette;
+    }
+
+    FramePoolStats ThermalCamera::bufferStats() const {
+        return pool_->stats();
+    }
+
+
+    // — Metrics — 
+    void ThermalCamera::enableMetrics(bool on) {
+        metrics_->setEnabled(on);
+    }
+
+    MetricsSnapshot ThermalCamera::metrics() const {
+        return metrics_->snapshot();
+    }
+
+    void ThermalCamera::resetMetrics() {
+        metrics_->reset();
+    }
+
+    bool ThermalCamera::serveMetrics(int port) {
+        if (!metricsServer_) metricsServer_.reset(new MetricsServer);
+        metrics_->setEnabled(true);
+        // the server thread only touches the metrics and the link, both
+        // shared, so it never races with close()
+        std::shared_ptr<CameraMetrics> metrics = metrics_;
+        std::shared_ptr<Link> link = link_;
+        serialNumber();     // the label, known from here on
+        return metricsServer_->start(port, [metrics, link]() {
+            unsigned int serial;
+            {
+                std::lock_guard<std::mutex> lk(link->mutex);
+                serial = link->serial;
+            }
+            return formatPrometheus({{std::to_string(serial), metrics->snapshot()}});
+        });
+    }
+
+    void ThermalCamera::stopMetricsServer() {
+        if (metricsServer_) metricsServer_->stop();
+    }
+
 } // namespace thermal
 
 
@@ -0,0 +1,398 @@
+#include "ThermalCodec.h"
+#include <opencv2/core/utility.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace thermal {
+
+    namespace {
+        const uint32_t MAGIC       = 0x36314354;   // "TC16"
+        const size_t   HEADER      = 4 + 4 + 4 + 2 + 2 + 1;
+        const size_t   TILE_HEADER = 1 + 4;
+        const uint8_t  FLAG_KEY    = 1;
+        enum TileMode : uint8_t { SPATIAL = 0, TEMPORAL = 1 };
+
+        // Golomb-Rice parameters
+        const int CONTEXTS    = 12;
+        const int MAX_K       = 17;
+        const int LIMIT       = 24;   // longest unary prefix before escaping
+        const int ESCAPE_BITS = 18;   // zigzagged residuals are < 2^18
+        const int RESCALE_AT  = 64;
+        // worst case per pixel: an escape
+        const size_t MAX_BITS_PER_PIXEL = LIMIT + ESCAPE_BITS;
+
+        void put16(uint8_t* p, uint16_t v) { p[0] = uint8_t(v); p[1] = uint8_t(v >> 8); }
+        void put32(uint8_t* p, uint32_t v) {
+            for (int i = 0; i < 4; ++i) p[i] = uint8_t(v >> (8 * i));
+        }
+        uint16_t get16(const uint8_t* p) { return uint16_t(p[0] | (p[1] << 8)); }
+        uint32_t get32(const uint8_t* p) {
+            return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 |
+                   uint32_t(p[3]) << 24;
+        }
+
+        // Running mean of the coded values per context, LOCO-I style: k is
+        // the smallest shift with n << k >= a.
+        struct RiceContexts {
+            uint32_t a[CONTEXTS];
+            uint32_t n[CONTEXTS];
+
+            RiceContexts() {
+                for (int i = 0; i < CONTEXTS; ++i) { a[i] = 4; n[i] = 1; }
+            }
+            int k(int c) const {
+                if (n[c] >= a[c]) return 0;
+                // line the top bits up, then one step if still short
+                int k = __builtin_clz(n[c]) - __builtin_clz(a[c]);
+                if ((n[c] << k) < a[c]) ++k;
+                return std::min(k, MAX_K);
+            }
+            void update(int c, uint32_t u) {
+                a[c] += u;
+                if (++n[c] == uint32_t(RESCALE_AT)) { a[c] >>= 1; n[c] >>= 1; }
+            }
+        };
+
+        // LOCO-I median edge predictor, branch-free
+        inline int med(int a, int b, int c) {
+            int mn = std::min(a, b), mx = std::max(a, b);
+            int p = a + b - c;
+            p = c >= mx ? mn : p;
+            p = c <= mn ? mx : p;
+            return p;
+        }
+
+        // local gradient activity, log2-bucketed
+        inline int context(int a, int b, int c) {
+            unsigned d = unsigned(std::abs(a - c) + std::abs(b - c));
+            return d ? std::min(CONTEXTS - 1, 32 - __builtin_clz(d)) : 0;
+        }
+
+        // the signal a tile codes: the frame, or its change since `prev`
+        inline void signalRow(const uint16_t* cur, const uint16_t* prev,
+                              int32_t* s, int w) {
+            if (prev) for (int x = 0; x < w; ++x) s[x] = int32_t(cur[x]) - int32_t(prev[x]);
+            else      for (int x = 0; x < w; ++x) s[x] = cur[x];
+        }
+
+        // Calls px(x, a, b, c) along a row with the left, upper and
+        // upper-left neighbours; `up` is null on a tile's first row. px
+        // must have set s[x] by the time it returns.
+        template <class Px>
+        inline void scanRow(const int32_t* s, const int32_t* up, int w, Px px) {
+            if (!up) {
+                int a = 0;
+                for (int x = 0; x < w; ++x) {
+                    px(x, a, a, a);
+                    a = s[x];
+                }
+                return;
+            }
+            px(0, up[0], up[0], up[0]);
+            for (int x = 1; x < w; ++x) px(x, s[x - 1], up[x], up[x - 1]);
+        }
+
+        // sum of |residual| over every 4th row: which mode codes cheaper
+        uint64_t estimate(const cv::Mat& cur, const cv::Mat* prev, int y0, int y1,
+                          std::vector<int32_t>& s0, std::vector<int32_t>& s1) {
+            const int w = cur.cols;
+            uint64_t cost = 0;
+            for (int y = y0 + 1; y < y1; y += 4) {
+                signalRow(cur.ptr<uint16_t>(y - 1), prev ? prev->ptr<uint16_t>(y - 1) : nullptr,
+                          s0.data(), w);
+                signalRow(cur.ptr<uint16_t>(y), prev ? prev->ptr<uint16_t>(y) : nullptr,
+                          s1.data(), w);
+                const int32_t* cur1 = s1.data();
+                scanRow(cur1, s0.data(), w, [&](int x, int a, int b, int c) {
+                    cost += uint64_t(std::abs(cur1[x] - med(a, b, c)));
+                });
+            }
+            return cost;
+        }
+
+        // MSB-first; stores 32 bits at a time
+        class BitWriter {
+            public:
+                explicit BitWriter(uint8_t* p) : begin_(p), p_(p) {}
+                // len <= 64
+                void put(uint64_t bits, int len) {
+                    if (len > 32) {
+                        put(bits >> 32, len - 32);
+                        bits &= 0xffffffffu;
+                        len = 32;
+                    }
+                    acc_ = (acc_ << len) | bits;
+                    n_ += len;
+                    if (n_ >= 32) {
+                        n_ -= 32;
+                        uint32_t w = uint32_t(acc_ >> n_);
+                        p_[0] = uint8_t(w >> 24); p_[1] = uint8_t(w >> 16);
+                        p_[2] = uint8_t(w >> 8);  p_[3] = uint8_t(w);
+                        p_ += 4;
+                    }
+                }
+                size_t finish() {
+                    while (n_ >= 8) {
+                        n_ -= 8;
+                        *p_++ = uint8_t(acc_ >> n_);
+                    }
+                    if (n_) *p_++ = uint8_t(acc_ << (8 - n_));
+                    n_ = 0;
+                    return size_t(p_ - begin_);
+                }
+            private:
+                uint8_t* begin_;
+                uint8_t* p_;
+                uint64_t acc_{0};
+                int      n_{0};
+            };
+
+        class BitReader {
+            public:
+                BitReader(const uint8_t* p, size_t size) : p_(p), end_(p + size), bits_(size * 8) {}
+                // more than 32 bits in acc_ afterwards (zeros past the end)
+                void refill() {
+                    if (n_ > 32) return;
+                    if (end_ - p_ >= 4) {
+                        uint64_t w = uint64_t(p_[0]) << 24 | uint64_t(p_[1]) << 16 |
+                                     uint64_t(p_[2]) << 8 | p_[3];
+                        acc_ |= w << (32 - n_);
+                        n_ += 32;
+                        p_ += 4;
+                        return;
+                    }
+                    while (n_ <= 56 && p_ < end_) {
+                        acc_ |= uint64_t(*p_++) << (56 - n_);
+                        n_ += 8;
+                    }
+                    if (p_ == end_) n_ = 64;    // the rest reads as zeros
+                }
+                uint64_t peek() const { return acc_; }
+                void skip(int len) { acc_ <<= len; n_ -= len; used_ += size_t(len); }
+                uint32_t take(int len) {
+                    if (!len) return 0;
+                    if (n_ < len) refill();
+                    uint32_t v = uint32_t(acc_ >> (64 - len));
+                    skip(len);
+                    return v;
+                }
+                bool overrun() const { return used_ > bits_; }
+            private:
+                const uint8_t* p_;
+                const uint8_t* end_;
+                size_t   bits_;
+                size_t   used_{0};
+                uint64_t acc_{0};
+                int      n_{0};
+            };
+
+        // `out` only ever grows; returns the bytes used
+        size_t encodeTile(const cv::Mat& cur, const cv::Mat* prev, int y0, int y1,
+                          std::vector<uint8_t>& out) {
+            const int w = cur.cols;
+            const size_t bound = (size_t(w) * (y1 - y0) * MAX_BITS_PER_PIXEL + 7) / 8 + 8;
+            if (out.size() < bound) out.resize(bound);
+            std::vector<int32_t> rowA(w), rowB(w);
+            int32_t* up = nullptr;
+            int32_t* s  = rowA.data();
+            RiceContexts ctx;
+            BitWriter bw(out.data());
+
+            for (int y = y0; y < y1; ++y) {
+                signalRow(cur.ptr<uint16_t>(y), prev ? prev->ptr<uint16_t>(y) : nullptr, s, w);
+                scanRow(s, up, w, [&](int x, int a, int b, int c) {
+                    const int cx = context(a, b, c);
+                    const int32_t e = s[x] - med(a, b, c);
+                    const uint32_t u = (uint32_t(e) << 1) ^ uint32_t(e >> 31);
+                    const int k = ctx.k(cx);
+                    const uint32_t q = u >> k;
+                    if (q < uint32_t(LIMIT)) {
+                        // q zeros, a one, then the k low bits
+                        bw.put((uint64_t(1) << k) | (u & ((1u << k) - 1)), int(q) + 1 + k);
+                    } else {
+                        bw.put(0, LIMIT);
+                        bw.put(u, ESCAPE_BITS);
+                    }
+                    ctx.update(cx, u);
+                });
+                up = s;
+                s = (s == rowA.data()) ? rowB.data() : rowA.data();
+            }
+            return bw.finish();
+        }
+
+        bool decodeTile(const uint8_t* data, size_t size, cv::Mat& cur,
+                        const cv::Mat* prev, int y0, int y1) {
+            const int w = cur.cols;
+            std::vector<int32_t> rowA(w), rowB(w);
+            int32_t* up = nullptr;
+            int32_t* s  = rowA.data();
+            RiceContexts ctx;
+            BitReader br(data, size);
+
+            for (int y = y0; y < y1; ++y) {
+                scanRow(s, up, w, [&](int x, int a, int b, int c) {
+                    const int cx = context(a, b, c);
+                    const int k = ctx.k(cx);
+
+                    br.refill();
+                    uint64_t bits = br.peek();
+                    int zeros = bits ? __builtin_clzll(bits) : 64;
+                    uint32_t u;
+                    if (zeros < LIMIT) {
+                        br.skip(zeros + 1);
+                        u = (uint32_t(zeros) << k) | br.take(k);
+                    } else {
+                        br.skip(LIMIT);
+                        u = br.take(ESCAPE_BITS);
+                    }
+                    ctx.update(cx, u);
+                    s[x] = med(a, b, c) + (int32_t(u >> 1) ^ -int32_t(u & 1));
+                });
+                if (br.overrun()) return false;
+
+                uint16_t* d = cur.ptr<uint16_t>(y);
+                if (prev) {
+                    const uint16_t* p = prev->ptr<uint16_t>(y);
+                    for (int x = 0; x < w; ++x) d[x] = uint16_t(s[x] + p[x]);
+                } else {
+                    for (int x = 0; x < w; ++x) d[x] = uint16_t(s[x]);
+                }
+                up = s;
+                s = (s == rowA.data()) ? rowB.data() : rowA.data();
+            }
+            return true;
+        }
+    }
+
+
+    // — Encoder —
+    ThermalEncoder::ThermalEncoder(const CodecOptions& opts) : opts_(opts) {
+        if (opts_.tileRows < 1) opts_.tileRows = 1;
+    }
+
+    void ThermalEncoder::reset() {
+        prev_.release();
+        frames_ = 0;
+    }
+
+    size_t ThermalEncoder::encode(const cv::Mat& raw16, std::vector<uint8_t>& out) {
+        if (raw16.type() != CV_16U || raw16.empty()) return 0;
+        const int w = raw16.cols, h = raw16.rows;
+        const int tileRows = std::min(opts_.tileRows, h);
+        const int tiles = (h + tileRows - 1) / tileRows;
+
+        const bool key = prev_.empty() || prev_.size() != raw16.size() || !opts_.temporal ||
+                         (opts_.keyframeInterval > 0 && frames_ % opts_.keyframeInterval == 0);
+        const cv::Mat* prev = key ? nullptr : &prev_;
+
+        std::vector<uint8_t> modes(tiles, SPATIAL);
+        std::vector<size_t>  sizes(tiles);
+        tiles_.resize(tiles);
+        auto codeTiles = [&](const cv::Range& r) {
+            std::vector<int32_t> s0(w), s1(w);
+            for (int t = r.start; t < r.end; ++t) {
+                int y0 = t * tileRows, y1 = std::min(h, y0 + tileRows);
+                bool temporal = prev && estimate(raw16, prev, y0, y1, s0, s1) <
+                                        estimate(raw16, nullptr, y0, y1, s0, s1);
+                modes[t] = temporal ? TEMPORAL : SPATIAL;
+                sizes[t] = encodeTile(raw16, temporal ? prev : nullptr, y0, y1, tiles_[t]);
+            }
+        };
+        if (opts_.parallel && tiles > 1) cv::parallel_for_(cv::Range(0, tiles), codeTiles);
+        else                             codeTiles(cv::Range(0, tiles));
+
+        size_t total = HEADER + size_t(tiles) * TILE_HEADER;
+        for (int t = 0; t < tiles; ++t) total += sizes[t];
+        out.resize(total);
+        uint8_t* p = out.data();
+        put32(p, MAGIC);
+        put32(p + 4, uint32_t(w));
+        put32(p + 8, uint32_t(h));
+        put16(p + 12, uint16_t(tileRows));
+        put16(p + 14, uint16_t(tiles));
+        p[16] = key ? FLAG_KEY : 0;
+        p += HEADER;
+        for (int t = 0; t < tiles; ++t) {
+            p[0] = modes[t];
+            put32(p + 1, uint32_t(sizes[t]));
+            p += TILE_HEADER;
+        }
+        for (int t = 0; t < tiles; ++t) {
+            std::memcpy(p, tiles_[t].data(), sizes[t]);
+            p += sizes[t];
+        }
+
+        if (opts_.temporal) raw16.copyTo(prev_);
+        ++frames_;
+        return total;
+    }
+
+
+    // — Decoder —
+    bool ThermalDecoder::isKeyframe(const uint8_t* data, size_t size) {
+        return size >= HEADER && get32(data) == MAGIC && (data[16] & FLAG_KEY);
+    }
+
+    bool ThermalDecoder::decode(const uint8_t* data, size_t size, cv::Mat& raw16) {
+        if (size < HEADER || get32(data) != MAGIC) {
+            std::cerr << "[WARN] ThermalDecoder: not a TC16 frame\n";
+            return false;
+        }
+        const int w = int(get32(data + 4)), h = int(get32(data + 8));
+        const int tileRows = get16(data + 12), tiles = get16(data + 14);
+        const bool key = data[16] & FLAG_KEY;
+        if (w <= 0 || h <= 0 || w > 65535 || h > 65535 || tileRows <= 0 ||
+            tiles != (h + tileRows - 1) / tileRows ||
+            size < HEADER + size_t(tiles) * TILE_HEADER) {
+            std::cerr << "[WARN] ThermalDecoder: corrupt header\n";
+            return false;
+        }
+
+        std::vector<size_t> offset(tiles), length(tiles);
+        std::vector<uint8_t> modes(tiles);
+        size_t pos = HEADER + size_t(tiles) * TILE_HEADER;
+        bool temporal = false;
+        for (int t = 0; t < tiles; ++t) {
+            const uint8_t* th = data + HEADER + size_t(t) * TILE_HEADER;
+            modes[t]  = th[0];
+            length[t] = get32(th + 1);
+            offset[t] = pos;
+            pos += length[t];
+            if (modes[t] > TEMPORAL || pos > size) {
+                std::cerr << "[WARN] ThermalDecoder: corrupt tile table\n";
+                return false;
+            }
+            temporal |= modes[t] == TEMPORAL;
+        }
+        if (temporal && (key || prev_.rows != h || prev_.cols != w)) {
+            std::cerr << "[WARN] ThermalDecoder: frame needs the previous one; "
+                         "start from a keyframe\n";
+            return false;
+        }
+
+        cv::Mat cur(h, w, CV_16U);
+        std::atomic<bool> ok{true};
+        auto decodeTiles = [&](const cv::Range& r) {
+            for (int t = r.start; t < r.end; ++t) {
+                int y0 = t * tileRows, y1 = std::min(h, y0 + tileRows);
+                if (!decodeTile(data + offset[t], length[t], cur,
+                                modes[t] == TEMPORAL ? &prev_ : nullptr, y0, y1))
+                    ok = false;
+            }
+        };
+        if (parallel_ && tiles > 1) cv::parallel_for_(cv::Range(0, tiles), decodeTiles);
+        else decodeTiles(cv::Range(0, tiles));
+        if (!ok) {
+            std::cerr << "[WARN] ThermalDecoder: truncated tile data\n";
+            return false;
+        }
+        prev_ = cur;
+        cur.copyTo(raw16);
+        return true;
+    }
+
+} // namespace thermal
@@ -0,0 +1,28 @@
+#include "ThreadAffinity.h"
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace thermal {
+
+    int onlineCpuCount() {
+        unsigned n = std::thread::hardware_concurrency();
+        return n ? int(n) : 1;
+    }
+
+    bool pinCurrentThread(int cpu) {
+        if (cpu < 0) return false;
+#ifdef __linux__
+        cpu %= onlineCpuCount();
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+} // namespace thermal
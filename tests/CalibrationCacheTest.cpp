@@ -0,0 +1,237 @@
+// CalibrationCache against simulated cameras, whose shutter cycles, saves
+// and loads SimulatedBus::calibrationStats counts. One camera goes through
+// a miss, a store and a hit; then entries are damaged on disk (payload
+// corrupted, saved too long ago, made for another serial or another sensor
+// size) and each must be refused, counted and removed, with the camera
+// left to calibrate as usual. Last, CameraPool::bringUpAll opens several
+// cameras at once against one cache: the first bring-up stores every
+// camera's calibration concurrently, the second loads them all back.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "CalibrationCache.h"
+#include "CameraPool.h"
+#include "SimulatedDevice.h"
+#include "ThermalCamera.h"
+
+using namespace thermal;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, \
+                         #cond);                                           \
+            return EXIT_FAIL;                                              \
+        }                                                                  \
+    } while (0)
+
+namespace {
+    const int MODEL = 3;        // TE_A, what the simulated QVGA/VGA cameras are
+    // SimulatedBus slots, well clear of real cameras and the other tests
+    const unsigned int SIM_DEVICE   = 50;   // the camera the entries are made for
+    const unsigned int SIM_OTHER    = 51;   // same size, another serial
+    const unsigned int SIM_VGA      = 52;   // another size
+    const unsigned int SIM_FLEET    = 60;   // bringUpAll's cameras, from here up
+    const int          FLEET        = 4;
+    const unsigned int SERIAL       = 0xca11;
+    const unsigned int SERIAL_OTHER = 0xca12;
+    const unsigned int SERIAL_VGA   = 0xca13;
+
+    // where the fields sit in an entry's 64-byte header (CalibrationCache.cpp)
+    const off_t SERIAL_AT   = 12;
+    const off_t SAVED_AT    = 24;
+    const off_t PAYLOAD_AT  = 64;
+
+    enum Exit { EXIT_PASS = 0, EXIT_FAIL = 1 };
+
+    bool exists(const std::string& path) { return ::access(path.c_str(), F_OK) == 0; }
+
+    bool patch(const std::string& path, off_t at, const void* data, size_t n) {
+        int fd = ::open(path.c_str(), O_WRONLY);
+        if (fd < 0) return false;
+        bool ok = ::pwrite(fd, data, n, at) == ssize_t(n);
+        return ::close(fd) == 0 && ok;
+    }
+
+    bool copyFile(const std::string& from, const std::string& to) {
+        FILE* in = std::fopen(from.c_str(), "rb");
+        if (!in) return false;
+        FILE* out = std::fopen(to.c_str(), "wb");
+        if (!out) {
+            std::fclose(in);
+            return false;
+        }
+        std::vector<char> buf(1 << 16);
+        bool ok = true;
+        size_t n;
+        while ((n = std::fread(buf.data(), 1, buf.size(), in)) > 0)
+            ok = ok && std::fwrite(buf.data(), 1, n, out) == n;
+        std::fclose(in);
+        return std::fclose(out) == 0 && ok;
+    }
+
+    SimConfig simCamera(unsigned int serial, int width = 384, int height = 288) {
+        SimConfig cfg;
+        cfg.serial = serial;
+        cfg.width  = width;
+        cfg.height = height;
+        return cfg;
+    }
+
+    // one camera through miss, store, hit and the damaged entries
+    int singleCamera(const std::string& dir) {
+        auto cache = std::make_shared<CalibrationCache>(dir, std::chrono::hours(1));
+        const std::string entry = cache->pathFor(SERIAL, MODEL);
+        SimulatedBus::plug(SIM_DEVICE, simCamera(SERIAL));
+        ThermalCamera cam;
+        cam.setCalibrationCache(cache);
+
+        // miss, then the calibration is stored
+        CHECK(cam.open(MODEL, SIM_DEVICE));
+        CHECK(!cam.calibrationRestored());
+        CHECK(cache->stats().misses == 1);
+        CHECK(cam.doCalibration());
+        CHECK(cache->stats().stores == 1 && exists(entry));
+        SimCalibrationStats sim = SimulatedBus::calibrationStats(SIM_DEVICE);
+        CHECK(sim.shutterCycles == 1 && sim.saves == 1 && sim.loads == 0);
+
+        // hit: no shutter cycle
+        CHECK(cam.open(MODEL, SIM_DEVICE));
+        CHECK(cam.calibrationRestored());
+        CHECK(cache->stats().hits == 1);
+        sim = SimulatedBus::calibrationStats(SIM_DEVICE);
+        CHECK(sim.shutterCycles == 1 && sim.loads == 1);
+        std::vector<char> good;
+        {
+            FILE* f = std::fopen(entry.c_str(), "rb");
+            CHECK(f);
+            good.resize(1 << 20);
+            good.resize(std::fread(good.data(), 1, good.size(), f));
+            std::fclose(f);
+        }
+        CHECK(good.size() > size_t(PAYLOAD_AT));
+
+        // payload changed on disk: the checksum catches it
+        const char flipped = char(good[PAYLOAD_AT + 10] ^ 0x5a);
+        CHECK(patch(entry, PAYLOAD_AT + 10, &flipped, 1));
+        CHECK(cam.open(MODEL, SIM_DEVICE));
+        CHECK(!cam.calibrationRestored());
+        CHECK(cache->stats().corrupt == 1 && !exists(entry));
+
+        // saved two hours ago, kept for one
+        CHECK(cam.doCalibration() && exists(entry));
+        const int64_t longAgo = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            (std::chrono::system_clock::now() - std::chrono::hours(2)).time_since_epoch()).count();
+        CHECK(patch(entry, SAVED_AT, &longAgo, sizeof(longAgo)));
+        CHECK(cam.open(MODEL, SIM_DEVICE));
+        CHECK(!cam.calibrationRestored());
+        CHECK(cache->stats().stale == 1 && !exists(entry));
+        CHECK(cam.doCalibration() && exists(entry));
+        cam.close();
+
+        // another camera's entry under this camera's name
+        SimulatedBus::plug(SIM_OTHER, simCamera(SERIAL_OTHER));
+        const std::string otherEntry = cache->pathFor(SERIAL_OTHER, MODEL);
+        CHECK(copyFile(entry, otherEntry));
+        ThermalCamera other;
+        other.setCalibrationCache(cache);
+        CHECK(other.open(MODEL, SIM_OTHER));
+        CHECK(!other.calibrationRestored());
+        CHECK(cache->stats().corrupt == 2 && !exists(otherEntry));
+        CHECK(SimulatedBus::calibrationStats(SIM_OTHER).loads == 0);
+        other.close();
+
+        // right key, wrong sensor size
+        SimulatedBus::plug(SIM_VGA, simCamera(SERIAL_VGA, 640, 480));
+        const std::string vgaEntry = cache->pathFor(SERIAL_VGA, MODEL);
+        CHECK(copyFile(entry, vgaEntry));
+        const uint32_t vgaSerial = SERIAL_VGA;
+        CHECK(patch(vgaEntry, SERIAL_AT, &vgaSerial, sizeof(vgaSerial)));
+        ThermalCamera vga;
+        vga.setCalibrationCache(cache);
+        CHECK(vga.open(MODEL, SIM_VGA));
+        CHECK(!vga.calibrationRestored());
+        CHECK(cache->stats().corrupt == 3 && !exists(vgaEntry));
+        CHECK(SimulatedBus::calibrationStats(SIM_VGA).loads == 0);
+        vga.close();
+
+        // the good entry survived all of that
+        CHECK(exists(entry));
+        const CalibrationCacheStats s = cache->stats();
+        std::printf("[INFO] single camera: %llu hits, %llu misses, %llu stale, "
+                    "%llu corrupt, %llu stores\n",
+                    (unsigned long long)s.hits, (unsigned long long)s.misses,
+                    (unsigned long long)s.stale, (unsigned long long)s.corrupt,
+                    (unsigned long long)s.stores);
+        ::unlink(entry.c_str());
+        return EXIT_PASS;
+    }
+
+    // every camera of the fleet stores, then loads, at the same time
+    int fleet(const std::string& dir) {
+        auto cache = std::make_shared<CalibrationCache>(dir);
+        for (int i = 0; i < FLEET; ++i) {
+            SimConfig cfg = simCamera(SERIAL + 0x100 + unsigned(i));
+            cfg.openMs        = 50;
+            cfg.calibrationMs = 50;
+            SimulatedBus::plug(SIM_FLEET + unsigned(i), cfg);
+        }
+
+        {
+            CameraPool pool;
+            pool.setCalibrationCache(cache);
+            auto results = pool.bringUpAll([](ThermalCamera& cam, const DeviceBringUp&) {
+                cam.doCalibration();
+            });
+            CHECK(results.size() == size_t(FLEET) && pool.size() == size_t(FLEET));
+            for (const DeviceBringUp& r : results)
+                CHECK(r.ready && !r.calibrationRestored);
+            pool.closeAll();
+        }
+        CHECK(cache->stats().misses == uint64_t(FLEET));
+        CHECK(cache->stats().stores == uint64_t(FLEET));
+
+        {
+            CameraPool pool;
+            pool.setCalibrationCache(cache);
+            auto results = pool.bringUpAll();
+            CHECK(results.size() == size_t(FLEET));
+            for (const DeviceBringUp& r : results)
+                CHECK(r.ready && r.calibrationRestored);
+            pool.closeAll();
+        }
+        const CalibrationCacheStats s = cache->stats();
+        CHECK(s.hits == uint64_t(FLEET) && s.corrupt == 0 && s.stale == 0);
+        for (int i = 0; i < FLEET; ++i) {
+            const SimCalibrationStats sim =
+                SimulatedBus::calibrationStats(SIM_FLEET + unsigned(i));
+            CHECK(sim.shutterCycles == 1 && sim.saves == 1 && sim.loads == 1);
+            ::unlink(cache->pathFor(SERIAL + 0x100 + unsigned(i), MODEL).c_str());
+        }
+        std::printf("[INFO] fleet: %d cameras stored, then restored\n", FLEET);
+        return EXIT_PASS;
+    }
+}
+
+int main() {
+    char dir[] = "/tmp/hawkeye-calib-test-XXXXXX";
+    if (!::mkdtemp(dir)) return EXIT_FAIL;
+
+    int rc = singleCamera(dir);
+    // bringUpAll takes every camera on the bus: the fleet alone
+    SimulatedBus::clear();
+    if (rc == EXIT_PASS) rc = fleet(dir);
+    SimulatedBus::clear();
+    ::rmdir(dir);
+    if (rc != EXIT_PASS) return rc;
+    std::printf("[PASS] calibration cache\n");
+    return EXIT_PASS;
+}
@@ -0,0 +1,122 @@
+// ThermalCamera::captureFrameAwait on a simulated camera: a coroutine
+// co_awaits a run of captures, each of which must come back with a frame of
+// the camera's size and its temperature map, resumed on the executor's
+// threads rather than the caller's. Once the camera is unplugged the awaits
+// still complete, with empty frames.
+
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <future>
+#include <thread>
+#include "CaptureExecutor.h"
+#include "SimulatedDevice.h"
+#include "ThermalCamera.h"
+
+using namespace thermal;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, \
+                         #cond);                                           \
+            return EXIT_FAIL;                                              \
+        }                                                                  \
+    } while (0)
+
+namespace {
+    // SimulatedBus slot, well clear of real cameras and the other tests
+    const unsigned int SIM_DEVICE = 41;
+    const int          WIDTH      = 384;
+    const int          HEIGHT     = 288;
+    const int          FRAMES     = 20;
+    const std::chrono::seconds RUN_TIMEOUT(10);
+
+    enum Exit { EXIT_PASS = 0, EXIT_FAIL = 1 };
+
+    // Starts at once and frees itself when it returns; whoever needs to
+    // know when that is waits on a future of its own.
+    struct Detached {
+        struct promise_type {
+            Detached get_return_object() { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { std::terminate(); }
+        };
+    };
+
+    struct Outcome {
+        int frames    = 0;      // non-empty, of the camera's size
+        int empty     = 0;
+        int wrongSize = 0;
+        int noTemp    = 0;      // without a usable temperature map
+        int onCaller  = 0;      // resumed on the thread that started the run
+    };
+
+    // `n` captures in a row, one co_await each; `finished` is ready once
+    // the last one is in
+    Detached captureRun(ThermalCamera& cam, CaptureExecutor& executor, int n,
+                        Outcome& out, std::future<void>& finished) {
+        std::promise<void> done;
+        finished = done.get_future();
+        const std::thread::id caller = std::this_thread::get_id();
+        for (int i = 0; i < n; ++i) {
+            Frame f = co_await cam.captureFrameAwait(true, &executor);
+            if (std::this_thread::get_id() == caller) ++out.onCaller;
+            if (f.empty()) {
+                ++out.empty;
+                continue;
+            }
+            if (f.raw().cols != WIDTH || f.raw().rows != HEIGHT) ++out.wrongSize;
+            // the scene's hot spot is far above its background
+            const TempStats& s = f.stats();
+            if (!(s.maxTemp > s.minTemp + 10.f)) ++out.noTemp;
+            ++out.frames;
+        }
+        done.set_value();
+    }
+
+    // a run still going would resume into a camera that is gone; bail out
+    // without unwinding anything
+    void await(std::future<void>& finished, const char* what) {
+        if (finished.wait_for(RUN_TIMEOUT) == std::future_status::ready) return;
+        std::fprintf(stderr, "[FAIL] %s: captures did not complete\n", what);
+        std::_Exit(EXIT_FAIL);
+    }
+}
+
+int main() {
+    SimConfig cfg;
+    cfg.width  = WIDTH;
+    cfg.height = HEIGHT;
+    cfg.fps    = 60;
+    SimulatedBus::plug(SIM_DEVICE, cfg);
+
+    ThermalCamera cam;
+    CHECK(cam.open(3, SIM_DEVICE));
+    CaptureExecutor executor(2);
+
+    Outcome live;
+    std::future<void> liveDone;
+    captureRun(cam, executor, FRAMES, live, liveDone);
+    await(liveDone, "plugged camera");
+    CHECK(live.frames == FRAMES);
+    CHECK(live.empty == 0 && live.wrongSize == 0 && live.noTemp == 0);
+    // every capture suspends, so no frame is handed over on the caller
+    CHECK(live.onCaller == 0);
+
+    SimulatedBus::unplug(SIM_DEVICE);
+    Outcome gone;
+    std::future<void> goneDone;
+    captureRun(cam, executor, 3, gone, goneDone);
+    await(goneDone, "unplugged camera");
+    CHECK(gone.empty == 3 && gone.frames == 0);
+
+    cam.close();
+    std::printf("[PASS] captureFrameAwait: %d frames, then %d empty after unplug\n",
+                live.frames, gone.empty);
+    return EXIT_PASS;
+}
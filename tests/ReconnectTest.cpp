@@ -0,0 +1,113 @@
+// A reconnecting stream (StreamOptions::reconnect) on a simulated camera,
+// driven by synthetic hotplug events: SimulatedBus::unplug/plug emit the
+// TE_REMOVAL / TE_ARRIVAL the SDK would. The camera drops out and comes
+// back twice, the second time under another device number, found again by
+// its serial. After each outage frames must resume to the same subscriber,
+// and LinkStats must account for the outage.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include "SimulatedDevice.h"
+#include "ThermalCamera.h"
+
+using namespace thermal;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, \
+                         #cond);                                           \
+            return EXIT_FAIL;                                              \
+        }                                                                  \
+    } while (0)
+
+namespace {
+    // SimulatedBus slots, well clear of real cameras and the other tests
+    const unsigned int SIM_DEVICE       = 42;
+    const unsigned int SIM_DEVICE_MOVED = 43;
+    const unsigned int SERIAL           = 0x5e1f;
+    // frames a subscriber must see before, and again after, each outage
+    const uint64_t     FRAMES           = 10;
+    // above the 5 s reopen backoff cap: a moved camera sends no arrival
+    // for the old device number, so it is found by polling
+    const std::chrono::seconds TIMEOUT(15);
+    // long enough for the stream to give up its read (3 tries, 100 ms
+    // apart) and its handles
+    const std::chrono::milliseconds OUTAGE(600);
+
+    enum Exit { EXIT_PASS = 0, EXIT_FAIL = 1 };
+
+    bool waitUntil(const std::function<bool()>& done) {
+        const auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+        while (!done()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+}
+
+int main() {
+    SimConfig cfg;
+    cfg.serial = SERIAL;
+    cfg.fps    = 60;
+    SimulatedBus::plug(SIM_DEVICE, cfg);
+
+    // before the camera: its threads count into them until it is gone
+    std::atomic<uint64_t> frames{0}, reconnects{0};
+    ThermalCamera cam;
+    CHECK(cam.open(3, SIM_DEVICE));
+
+    const int sub = cam.subscribe([&frames](const Frame&) { ++frames; });
+    StreamOptions opts;
+    opts.reconnect   = true;
+    opts.onReconnect = [&reconnects](const LinkStats&) { ++reconnects; };
+    cam.startStream(false, opts);
+    CHECK(waitUntil([&] { return frames >= FRAMES; }));
+    CHECK(cam.linkStats().connected && cam.linkStats().outages == 0);
+
+    // 1) out and back in at the same device number
+    SimulatedBus::unplug(SIM_DEVICE);
+    std::this_thread::sleep_for(OUTAGE);
+    LinkStats s = cam.linkStats();
+    CHECK(!s.connected && s.outages == 1);
+    // a capture meanwhile fails at once instead of waiting for the camera
+    const auto asked = std::chrono::steady_clock::now();
+    CHECK(cam.captureFrame().empty());
+    CHECK(std::chrono::steady_clock::now() - asked < OUTAGE);
+
+    uint64_t before = frames;
+    SimulatedBus::plug(SIM_DEVICE, cfg);
+    CHECK(waitUntil([&] { return reconnects == 1 && frames >= before + FRAMES; }));
+    s = cam.linkStats();
+    CHECK(s.connected && s.outages == 1 && s.reconnectAttempts >= 1);
+    CHECK(s.lastOutageMs >= double(OUTAGE.count()));
+    CHECK(s.lastTimeToFirstFrameMs > 0);
+    CHECK(s.totalDowntimeMs >= s.lastOutageMs);
+    const double firstOutageMs = s.lastOutageMs;
+
+    // 2) back under another device number, with the same serial
+    SimulatedBus::unplug(SIM_DEVICE);
+    std::this_thread::sleep_for(OUTAGE);
+    CHECK(cam.linkStats().outages == 2);
+    before = frames;
+    SimulatedBus::plug(SIM_DEVICE_MOVED, cfg);
+    CHECK(waitUntil([&] { return reconnects == 2 && frames >= before + FRAMES; }));
+    s = cam.linkStats();
+    CHECK(s.connected && s.outages == 2);
+    CHECK(s.lastOutageMs >= double(OUTAGE.count()));
+    CHECK(s.totalDowntimeMs >= firstOutageMs + s.lastOutageMs);
+
+    cam.stopStream();
+    // the subscription lived through both outages
+    CHECK(cam.unsubscribe(sub));
+    cam.close();
+    SimulatedBus::unplug(SIM_DEVICE_MOVED);
+    std::printf("[PASS] reconnect: %llu frames over 2 outages (%.0f, %.0f ms)\n",
+                (unsigned long long)frames.load(), firstOutageMs, s.lastOutageMs);
+    return EXIT_PASS;
+}
@@ -0,0 +1,186 @@
+// SharedFramePublisher against several consumer processes on one machine:
+// the publisher streams SyntheticFrameSource frames into the ring while
+// forked consumers read along. Consumers that keep up must see every frame,
+// in order and intact; one that is deliberately slow must be lapped and
+// count the frames it lost. Each consumer reports through its exit code.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "Frame.h"
+#include "FrameSource.h"
+#include "SharedFrameRing.h"
+
+using namespace thermal;
+
+#define CHECK(cond)                                                        \
+    do {                                                                   \
+        if (!(cond)) {                                                     \
+            std::fprintf(stderr, "[FAIL] pid %d %s:%d: %s\n", int(getpid()), \
+                         __FILE__, __LINE__, #cond);                       \
+            return EXIT_FAIL;                                              \
+        }                                                                  \
+    } while (0)
+
+namespace {
+    const int    WIDTH          = 64;
+    const int    HEIGHT         = 48;
+    const size_t SLOTS          = 32;
+    const int    FRAMES         = 400;
+    const int    FAST_CONSUMERS = 3;
+    // between frames: fast consumers keep up easily, the slow one can't
+    const std::chrono::milliseconds PUBLISH_PERIOD(2);
+    const std::chrono::milliseconds SLOW_CONSUMER_DELAY(20);
+
+    enum Exit { EXIT_PASS = 0, EXIT_FAIL = 1, EXIT_NO_RING = 2 };
+
+    bool samePlane(const cv::Mat& a, const cv::Mat& b) {
+        if (a.rows != b.rows || a.cols != b.cols || a.type() != b.type()) return false;
+        const size_t row = size_t(a.cols) * a.elemSize();
+        for (int y = 0; y < a.rows; ++y)
+            if (std::memcmp(a.ptr(y), b.ptr(y), row) != 0) return false;
+        return true;
+    }
+
+    // Frame `k` of the synthetic scene: its raw frame and its temperature
+    // map are the same non-AGC rendering. Regenerated by stepping a source
+    // of our own, which is deterministic in the frame count.
+    class Expected {
+        public:
+            Expected() : src_(WIDTH, HEIGHT), raw_(HEIGHT, WIDTH, CV_16U) {}
+            const cv::Mat& frame(uint64_t k) {
+                while (next_ <= k) {
+                    src_.read(raw_, false);
+                    ++next_;
+                }
+                return raw_;
+            }
+        private:
+            SyntheticFrameSource src_;
+            cv::Mat  raw_;
+            uint64_t next_{0};
+        };
+
+    int runConsumer(const std::string& name, bool slow, int readyFd) {
+        SharedFrameConsumer c;
+        if (!c.open(name)) return EXIT_NO_RING;
+        const char ready = 1;
+        if (write(readyFd, &ready, 1) != 1) return EXIT_FAIL;
+        ::close(readyFd);
+
+        Expected expected;
+        SharedFrame f;
+        uint64_t received = 0;
+        bool     first    = true;
+        uint64_t lastIndex = 0;
+        while (c.next(f, 5000)) {
+            // the ring index follows the publisher's FrameInfo::sequence
+            CHECK(f.info.sequence == f.index);
+            if (!first) {
+                CHECK(f.index > lastIndex);
+                if (!slow) CHECK(f.index == lastIndex + 1);
+            }
+            CHECK(f.raw.rows == HEIGHT && f.raw.cols == WIDTH && f.raw.type() == CV_16U);
+            CHECK(!f.temp.empty());
+            const cv::Mat& want = expected.frame(f.index);
+            const bool rawOk  = samePlane(f.raw, want);
+            const bool tempOk = samePlane(f.temp, want);
+            // a mismatch is only allowed if the slot was reused meanwhile
+            if (c.intact(f)) CHECK(rawOk && tempOk);
+            else             CHECK(slow);
+            first = false;
+            lastIndex = f.index;
+            ++received;
+            if (slow) std::this_thread::sleep_for(SLOW_CONSUMER_DELAY);
+        }
+        CHECK(c.closed());
+
+        const SharedRingStats s = c.stats();
+        CHECK(s.frames == received);
+        if (slow) {
+            CHECK(s.overruns > 0);
+            CHECK(s.lost > 0);
+            CHECK(s.frames + s.lost == uint64_t(FRAMES));
+        } else {
+            CHECK(received == uint64_t(FRAMES));
+            CHECK(!first && f.index == uint64_t(FRAMES - 1));
+            CHECK(s.overruns == 0 && s.lost == 0);
+        }
+        std::printf("[INFO] %s consumer %d: %llu frames, %llu overruns, %llu lost\n",
+                    slow ? "slow" : "fast", int(getpid()),
+                    (unsigned long long)s.frames, (unsigned long long)s.overruns,
+                    (unsigned long long)s.lost);
+        std::fflush(stdout);    // _exit() skips it
+        return EXIT_PASS;
+    }
+}
+
+int main() {
+    const std::string name = "/hawkeye-ring-test-" + std::to_string(getpid());
+    RecordingMeta meta{WIDTH, HEIGHT, CV_16U, CV_16U, false, 0x7e57, 1.f, 0};
+
+    SharedFramePublisher pub;
+    if (!pub.open(name, meta, SLOTS)) return EXIT_FAIL;
+
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0) return EXIT_FAIL;
+    const int consumers = FAST_CONSUMERS + 1;
+    std::vector<pid_t> pids;
+    for (int i = 0; i < consumers; ++i) {
+        pid_t pid = fork();
+        if (pid < 0) return EXIT_FAIL;
+        if (pid == 0) {
+            ::close(pipeFds[0]);
+            // the publisher's mapping came along with fork(); the consumer
+            // maps the ring afresh, as another process would
+            _exit(runConsumer(name, i == FAST_CONSUMERS, pipeFds[1]));
+        }
+        pids.push_back(pid);
+    }
+    ::close(pipeFds[1]);
+    // every consumer attached before the first frame, so none misses it
+    int failures = 0;
+    for (int i = 0; i < consumers; ++i) {
+        char c;
+        if (read(pipeFds[0], &c, 1) != 1) {
+            std::fprintf(stderr, "[FAIL] a consumer could not open the ring\n");
+            ++failures;
+            break;
+        }
+    }
+    ::close(pipeFds[0]);
+
+    auto src = std::make_shared<SyntheticFrameSource>(WIDTH, HEIGHT);
+    for (int k = 0; k < FRAMES; ++k) {
+        cv::Mat raw(HEIGHT, WIDTH, CV_16U);
+        if (src->read(raw, false) != 1) ++failures;
+        // the frame fetches its temperature map from the source in publish()
+        Frame f(raw, FrameInfo{uint64_t(k), std::chrono::steady_clock::now(), 0},
+                nullptr, src);
+        if (!pub.publish(f)) ++failures;
+        std::this_thread::sleep_for(PUBLISH_PERIOD);
+    }
+    if (pub.stats().frames != uint64_t(FRAMES)) ++failures;
+    pub.close();
+
+    for (pid_t pid : pids) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_PASS) {
+            std::fprintf(stderr, "[FAIL] consumer %d: status %d\n", int(pid), status);
+            ++failures;
+        }
+    }
+    if (failures) {
+        std::fprintf(stderr, "[FAIL] shared ring: %d failure(s)\n", failures);
+        return EXIT_FAIL;
+    }
+    std::printf("[PASS] shared ring: %d consumers, %d frames\n", consumers, FRAMES);
+    return EXIT_PASS;
+}